@@ -0,0 +1,216 @@
+//
+// Gamecraft
+//
+
+// Linear allocators for memory that lives for a frame or for a single job. Allocating
+// bumps an offset into a fixed block, and nothing is freed on its own. The frame arena
+// is reset at the start of every frame and may only be used on the main thread. Each
+// thread also has a scratch arena, which is released in scopes with ScratchScope.
+
+#define FRAME_ARENA_SIZE Megabytes(4)
+#define SCRATCH_ARENA_SIZE Megabytes(16)
+
+// Arenas reserve their full size, but commit pages in steps of this many bytes as they're first used.
+#define ARENA_COMMIT_SIZE Kilobytes(256)
+
+// An allocation that didn't fit in the arena's block, made on the heap instead
+// and freed when the arena is reset past it.
+struct ArenaOverflow
+{
+	ArenaOverflow* next;
+};
+
+struct Arena
+{
+	uint8_t* base;
+	size_t size, committed, used, peak;
+
+	ArenaOverflow* overflow;
+	int64_t overflowCount;
+};
+
+struct ArenaMark
+{
+	size_t used;
+	ArenaOverflow* overflow;
+};
+
+// If false, every arena allocation is made on the heap, so that heap traffic can be
+// compared with and without the arenas in the same build.
+static bool g_useArenas = true;
+
+static Arena g_frameArena;
+static thread_local Arena* g_scratchArena;
+
+static void InitArena(Arena& arena, size_t size)
+{
+	arena.base = (uint8_t*)VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+
+	if (arena.base == nullptr)
+		Error("Failed to reserve an arena of %zu bytes.\n", size);
+
+	arena.size = size;
+	arena.committed = 0;
+	arena.used = 0;
+	arena.peak = 0;
+	arena.overflow = nullptr;
+	arena.overflowCount = 0;
+
+	TRACK_ALLOC(MEMORY_ARENAS, 0);
+}
+
+// Commits the pages up to the given offset. Committed pages are kept until exit, so a
+// scratch arena holds as much memory as the largest job on its thread has needed.
+static void CommitArena(Arena& arena, size_t end)
+{
+	size_t rounded = (end + ARENA_COMMIT_SIZE - 1) & ~((size_t)ARENA_COMMIT_SIZE - 1);
+	size_t commit = Min(rounded, arena.size);
+
+	if (VirtualAlloc(arena.base + arena.committed, commit - arena.committed, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+		Error("Failed to commit %zu bytes of an arena.\n", commit);
+
+	TRACK_RESIZE(MEMORY_ARENAS, commit - arena.committed);
+	arena.committed = commit;
+}
+
+// Align must be a power of 2.
+static void* ArenaAlloc(Arena& arena, size_t bytes, size_t align = 16)
+{
+	assert(IsPowerOf2((int)align));
+	size_t start = (arena.used + align - 1) & ~(align - 1);
+
+	if (g_useArenas && start + bytes <= arena.size)
+	{
+		if (start + bytes > arena.committed)
+			CommitArena(arena, start + bytes);
+
+		arena.used = start + bytes;
+		arena.peak = Max(arena.peak, arena.used);
+		return arena.base + start;
+	}
+
+	uint8_t* block = new uint8_t[sizeof(ArenaOverflow) + align + bytes];
+
+	ArenaOverflow* node = (ArenaOverflow*)block;
+	node->next = arena.overflow;
+	arena.overflow = node;
+
+	if (g_useArenas)
+		arena.overflowCount++;
+
+	uintptr_t ptr = (uintptr_t)(block + sizeof(ArenaOverflow));
+	return (void*)((ptr + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+// The items aren't constructed.
+template <typename T>
+static inline T* ArenaArray(Arena& arena, int count)
+{
+	return (T*)ArenaAlloc(arena, count * sizeof(T), Max(alignof(T), (size_t)16));
+}
+
+static inline ArenaMark GetArenaMark(Arena& arena)
+{
+	return { arena.used, arena.overflow };
+}
+
+// Releases everything allocated since the mark was taken.
+static void ResetArena(Arena& arena, ArenaMark mark)
+{
+	while (arena.overflow != mark.overflow)
+	{
+		ArenaOverflow* next = arena.overflow->next;
+		delete[] (uint8_t*)arena.overflow;
+		arena.overflow = next;
+	}
+
+	arena.used = mark.used;
+}
+
+static inline void ResetArena(Arena& arena)
+{
+	ResetArena(arena, {});
+}
+
+// Called at the start of each frame, before anything uses the frame arena.
+static inline void ResetFrameArena()
+{
+	ResetArena(g_frameArena);
+}
+
+static Arena& GetScratchArena()
+{
+	if (g_scratchArena == nullptr)
+	{
+		g_scratchArena = new Arena();
+		InitArena(*g_scratchArena, SCRATCH_ARENA_SIZE);
+	}
+
+	return *g_scratchArena;
+}
+
+// Scratch memory for the calling thread. Everything allocated from it while the
+// scope is alive is released when the scope ends. Scopes may nest.
+struct ScratchScope
+{
+	Arena& arena;
+	ArenaMark mark;
+
+	ScratchScope() : arena(GetScratchArena()), mark(GetArenaMark(arena)) {}
+
+	~ScratchScope()
+	{
+		ResetArena(arena, mark);
+	}
+};
+
+// Lets the standard containers allocate from an arena. Memory is only released when
+// the arena is reset, so a container must not outlive the arena's current frame or scope.
+template <typename T>
+struct ArenaAllocator
+{
+	using value_type = T;
+
+	Arena* arena;
+
+	ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count)
+	{
+		return (T*)ArenaAlloc(*arena, count * sizeof(T), Max(alignof(T), (size_t)16));
+	}
+
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+static inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+	return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+static inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+	return a.arena != b.arena;
+}
+
+template <typename T>
+using ArenaVector = vector<T, ArenaAllocator<T>>;
+
+// Creates an empty vector in the frame arena. It's released with the frame without
+// being destroyed, so vectors used from frame to frame are created again each frame
+// rather than cleared.
+template <typename T>
+static ArenaVector<T>* NewFrameVector(size_t capacity = 0)
+{
+	void* mem = ArenaAlloc(g_frameArena, sizeof(ArenaVector<T>), Max(alignof(ArenaVector<T>), (size_t)16));
+
+	ArenaVector<T>* items = new (mem) ArenaVector<T>(ArenaAllocator<T>(g_frameArena));
+	items->reserve(capacity);
+
+	return items;
+}
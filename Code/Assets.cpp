@@ -22,6 +22,14 @@ static Shader* GetShader(GameState* state, ShaderID id)
     return &state->assets.shaders[id];
 }
 
+// Headless builds have no GL context or audio device, so the asset file isn't read.
+// Blocks refer to their textures by image ID, which doesn't need them.
+#if HEADLESS
+
+static void LoadAssets(GameState*) {}
+
+#else
+
 static void LoadAssets(GameState* state)
 {
     char buffer[MAX_PATH];
@@ -94,5 +102,7 @@ static void LoadAssets(GameState* state)
         assert(glIsProgram(db.shaders[i / 2].handle));
     }
 
-    LoadMusic(audio, "Assets\\LittleTown.ogg");
+    LoadMusic(audio, "Assets/LittleTown.ogg");
 }
+
+#endif
@@ -18,7 +18,10 @@ static inline bool DoNextAsync(GameState* state, AsyncWorkQueue& queue)
     	if (InterlockedCompareExchange(&queue.read, nextRead, originalRead) == originalRead)
 	    {
 	    	AsyncItem item = queue.items[originalRead];
+
+	    	BEGIN_ASYNC_BLOCK(item.name);
             item.func(item.state, item.world, item.data);
+            END_ASYNC_BLOCK(item.name);
 
             if (item.callback != nullptr)
             {
@@ -40,7 +43,12 @@ static DWORD WINAPI ThreadProc(LPVOID ptr)
 
 	while (true)
 	{
-		if (DoNextAsync(state, state->workQueue)) 
+		bool sleep = true;
+
+		for (int i = 0; i < ASYNC_PRIORITY_COUNT && sleep; i++)
+			sleep = DoNextAsync(state, state->workQueues[i]);
+
+		if (sleep) 
 			WaitForSingleObject(state->semaphore, INFINITE);
     }
 }
@@ -59,13 +67,15 @@ static void RunAsyncCallbacks(GameState* state)
 	ReleaseSRWLockExclusive(&state->callbackLock);
 }
 
-static inline void QueueAsync(GameState* state, AsyncFunc func, World* world, void* data, AsyncCallback callback = nullptr)
+static inline void QueueAsyncNamed(GameState* state, AsyncFunc func, char* name, World* world, void* data, 
+	AsyncCallback callback = nullptr, AsyncPriority priority = ASYNC_PRIORITY_NORMAL)
 {
-	AsyncWorkQueue& asyncQueue = state->workQueue;
+	AsyncWorkQueue& asyncQueue = state->workQueues[priority];
 	uint32_t nextWrite = (asyncQueue.write + 1) & (asyncQueue.size - 1);
 	assert(nextWrite != asyncQueue.read);
 	AsyncItem* asyncItem = asyncQueue.items + asyncQueue.write;
 	asyncItem->func = func;
+	asyncItem->name = name;
 	asyncItem->state = state;
 	asyncItem->world = world;
 	asyncItem->data = data;
@@ -81,11 +91,16 @@ static void CreateThreads(GameState* state)
 	SYSTEM_INFO info;
 	GetSystemInfo(&info);
 
-	int threadCount = info.dwNumberOfProcessors - 1;
+	// Work is only done on these threads, so there's at least one even on a single core.
+	int threadCount = Max((int)info.dwNumberOfProcessors - 1, 1);
+	state->threadCount = threadCount;
 
-	AsyncWorkQueue& asyncQueue = state->workQueue;
-	asyncQueue.size = 2048;
-	asyncQueue.items = new AsyncItem[asyncQueue.size];
+	for (int i = 0; i < ASYNC_PRIORITY_COUNT; i++)
+	{
+		AsyncWorkQueue& asyncQueue = state->workQueues[i];
+		asyncQueue.size = 2048;
+		asyncQueue.items = new AsyncItem[asyncQueue.size];
+	}
 
 	state->callbacks.reserve(1024);
 	InitializeSRWLock(&state->callbackLock);
@@ -93,7 +108,7 @@ static void CreateThreads(GameState* state)
 	for (int i = 0; i < threadCount; i++)
 	{
 		DWORD threadID; 
-		HANDLE handle = CreateThread(NULL, NULL, ThreadProc, state, NULL, &threadID);
+		HANDLE handle = CreateThread(NULL, 0, ThreadProc, state, 0, &threadID);
         CloseHandle(handle);
 	}
 }
@@ -2,12 +2,26 @@
 // Gamecraft
 //
 
+// Work is taken from the highest priority queue that has any.
+enum AsyncPriority
+{
+    ASYNC_PRIORITY_HIGH,
+    ASYNC_PRIORITY_MEDIUM,
+    ASYNC_PRIORITY_NORMAL,
+    ASYNC_PRIORITY_COUNT
+};
+
 using AsyncCallback = void(*)(GameState* state, World*, void*);
 using AsyncFunc = void(*)(GameState* state, World*, void*);
 
+// Queues the function to be run by a background thread. The function's name is 
+// kept so that the job can be timed by the profiler.
+#define QueueAsync(state, func, ...) QueueAsyncNamed(state, func, #func, __VA_ARGS__)
+
 struct AsyncItem
 {
     AsyncFunc func;
+    char* name;
     GameState* state;
     World* world;
     void* data;
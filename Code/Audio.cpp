@@ -2,6 +2,16 @@
 // Gamecraft
 //
 
+#if HEADLESS
+
+static void InitAudio(AudioEngine*) {}
+static void ChangeVolume(AudioEngine*, float, float) {}
+static void ToggleMute(AudioEngine* audio) { audio->muted = !audio->muted; }
+static void PlaySound(Sound) {}
+static void UpdateAudio(AudioEngine*, float) {}
+
+#else
+
 #define CheckForError(hr, ...) if (FAILED(hr)) Error(__VA_ARGS__)
 
 static void InitAudio(AudioEngine* engine)
@@ -192,3 +202,5 @@ static void UpdateAudio(AudioEngine* engine, float deltaTime)
 		music->SetVolume(Lerp(lData.start, lData.end, lData.t));
 	}
 }
+
+#endif
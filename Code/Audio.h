@@ -2,6 +2,16 @@
 // Gamecraft
 //
 
+// The headless build has no audio device, so sounds and music are never loaded or played.
+#if HEADLESS
+
+struct AudioEngine
+{
+	bool muted;
+};
+
+#else
+
 struct SoundCallback;
 
 struct AudioEngine : public IXAudio2VoiceCallback
@@ -53,3 +63,5 @@ struct SoundCallback : public IXAudio2VoiceCallback
 	void OnLoopEnd(void*) {}
 	void OnVoiceError(void*, HRESULT) {}
 };
+
+#endif
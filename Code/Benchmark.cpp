@@ -0,0 +1,228 @@
+//
+// Gamecraft
+//
+
+// The benchmark's entry point and the setup its suites share. See Benchmark.h.
+
+// Sets up the parts of the game used without a window. The given save folder's world
+// is cleared, so that it's generated again rather than loaded from a previous run.
+static void InitHeadless(GameState* state, char* saveFolder, char* savePath)
+{
+	DEBUG_INIT(state, nullptr);
+	InitArena(g_frameArena, FRAME_ARENA_SIZE);
+
+	state->audio.muted = true;
+
+	state->savePath = PathToExe(saveFolder, savePath, MAX_PATH);
+	CreateDirectory(state->savePath, NULL);
+
+	char worldPath[MAX_PATH];
+	sprintf(worldPath, "%s/World", state->savePath);
+	CreateDirectory(worldPath, NULL);
+	DeleteDirectory(worldPath);
+}
+
+static World* CreateHeadlessWorld(GameState* state, WorldConfig& config, int screenWidth, int screenHeight, int loadRange)
+{
+	CreateThreads(state);
+	LoadAssets(state);
+
+	Camera* cam = NewCamera();
+	state->camera = cam;
+
+	Renderer& rend = state->renderer;
+	rend.meshData.tag = MEMORY_MESH_DATA;
+	rend.meshData2D.tag = MEMORY_MESH_DATA;
+	SetCameraProjection(cam, rend, screenWidth, screenHeight);
+
+	World* world = NewWorld(state, loadRange, config);
+
+	Player* player = NewPlayer(state);
+	world->player = player;
+
+	return world;
+}
+
+// Creates an infinite world with the given seed and biome in the save folder set up
+// by InitHeadless.
+static World* CreateSeededWorld(GameState* state, int seed, BiomeType biome, int loadRange)
+{
+	// NewWorld loads the world's properties from its save folder, so the fixed seed
+	// and biome are written there first.
+	WorldProperties props = {};
+	props.seed = seed;
+	props.radius = INT_MAX;
+	props.biome = biome;
+
+	char propsPath[MAX_PATH];
+	sprintf(propsPath, "%s/World/WorldData.txt", state->savePath);
+	WriteBinary(propsPath, (char*)&props, (int)sizeof(WorldProperties));
+
+	WorldConfig worldConfig = {};
+	worldConfig.radius = INT_MAX;
+	worldConfig.infinite = true;
+	worldConfig.biome = biome;
+
+	return CreateHeadlessWorld(state, worldConfig, BENCH_SCREEN_WIDTH, BENCH_SCREEN_HEIGHT, loadRange);
+}
+
+// Runs one frame of the game loop without input, UI or rendering. Returns the
+// time spent on the frame in milliseconds, not counting the time paced away.
+// If given, the time spent in UpdateWorld is written to updateTime.
+static float BenchFrame(GameState* state, World* world, Player* player, float* updateTime)
+{
+	double start = glfwGetTime();
+
+	FRAME_MARKER;
+	ResetFrameArena();
+
+	RunAsyncCallbacks(state);
+
+	double updateStart = glfwGetTime();
+	UpdateWorld(state, world, state->camera, player);
+
+	if (updateTime != nullptr)
+		*updateTime = (float)((glfwGetTime() - updateStart) * 1000.0);
+
+	UpdateEnvironment(state, world, BENCH_FRAME_TIME);
+
+	if (player->spawned)
+		Simulate(state, world, player, BENCH_FRAME_TIME);
+
+	UpdateViewMatrix(state->camera);
+
+	DEBUG_END_FRAME(state);
+	END_HEAP_FRAME;
+
+	double end = glfwGetTime();
+
+	state->deltaTime = BENCH_FRAME_TIME;
+	state->time += BENCH_FRAME_TIME;
+
+	while (glfwGetTime() - start < BENCH_FRAME_TIME)
+		Sleep(0);
+
+	return (float)((end - start) * 1000.0);
+}
+
+// A group only becomes renderable once its neighbors are preprocessed, and edge groups
+// never are, so groups beside the edge of the load area are never shown.
+static bool CanBecomeRenderable(World* world, int x, int z)
+{
+	for (int i = 0; i < 9; i++)
+	{
+		int nX = x + DIRS_2[i].x, nZ = z + DIRS_2[i].z;
+
+		if (!GroupInsideWorld(world, nX, nZ) || !HasFlag(world->loadArea[GroupIndex(world, nX, nZ)], LOAD_AREA_INTERIOR))
+			return false;
+	}
+
+	return true;
+}
+
+// The world is fully visible once every group in the load area that can be shown is
+// renderable and every chunk in view has its mesh.
+static bool WorldFullyVisible(World* world, Player* player)
+{
+	if (!player->spawned || player->suspended || HasBackgroundWork(world) || !world->chunksToFill.empty())
+		return false;
+
+	for (int i = 0; i < world->totalGroups; i++)
+	{
+		if (!CanBecomeRenderable(world, i % world->size, i / world->size))
+			continue;
+
+		ChunkGroup* group = world->groups[i];
+
+		if (group == nullptr || !group->renderable)
+			return false;
+	}
+
+	ArenaVector<Chunk*>& visible = *world->visibleChunks;
+
+	for (int i = 0; i < visible.size(); i++)
+	{
+		if (visible[i]->state != CHUNK_BUILT)
+			return false;
+	}
+
+	return true;
+}
+
+// Creates a world with the default seed and biome and runs frames until the area around
+// the player is loaded and shown. Used by the suites that test against a loaded world.
+static World* LoadBenchWorld(GameState* state, char* savePath)
+{
+	srand(BENCH_DEFAULT_SEED);
+	InitHeadless(state, "BenchSaves", savePath);
+
+	World* world = CreateSeededWorld(state, BENCH_DEFAULT_SEED, BIOME_FOREST);
+	Player* player = world->player;
+
+	double start = glfwGetTime();
+
+	while (!WorldFullyVisible(world, player))
+	{
+		if (glfwGetTime() - start > BENCH_SETTLE_TIMEOUT)
+			Error("The world didn't finish loading within %.0f seconds.\n", BENCH_SETTLE_TIMEOUT);
+
+		BenchFrame(state, world, player);
+	}
+
+	return world;
+}
+
+static inline float FramePercentile(vector<float>& sorted, float fraction)
+{
+	if (sorted.empty()) return 0.0f;
+
+	int index = Min((int)(sorted.size() * fraction), (int)sorted.size() - 1);
+	return sorted[index];
+}
+
+static BenchSuite g_benchSuites[] =
+{
+	{ "paths", "[seed] [biome] [-noarenas] [-pools]", RunPathsBench },
+	{ "replay", "<file> [-fixed]", RunReplayBench },
+	{ "worldgen", "[-update]", RunWorldGenBench },
+	{ "containers", "", RunContainerBench },
+	{ "pools", "", RunPoolBench },
+	{ "blocks", "", RunBlockBench },
+	{ "mesh", "", RunMeshBench },
+	{ "light", "", RunLightBench },
+	{ "access", "", RunAccessBench },
+	{ "rays", "", RunRayBench },
+	{ "ranges", "[range]", RunRangeBench },
+	{ "particles", "", RunParticleBench },
+	{ "physics", "", RunPhysicsBench }
+};
+
+static int PrintBenchUsage()
+{
+	printf("Usage: GamecraftBench <suite> [options]\n\n");
+
+	for (BenchSuite& suite : g_benchSuites)
+		printf("  %-12s %s\n", suite.name, suite.usage);
+
+	return 1;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return PrintBenchUsage();
+
+	for (BenchSuite& suite : g_benchSuites)
+	{
+		if (strcmp(argv[1], suite.name) == 0)
+		{
+			GameState* state = new GameState();
+			vector<char*> args(argv + 2, argv + argc);
+
+			return suite.func(state, args);
+		}
+	}
+
+	printf("Unknown suite %s.\n\n", argv[1]);
+	return PrintBenchUsage();
+}
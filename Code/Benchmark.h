@@ -0,0 +1,54 @@
+//
+// Gamecraft
+//
+
+// Headless benchmark suites, built as GamecraftBench by Build.bat -b or the CMake build.
+// Each suite is its own entry point, run with GamecraftBench <suite> [options], and returns
+// the program's exit code. Running without a suite lists them.
+
+// Frames are paced to this time so that background work gets the same time
+// per frame as it would in the game.
+#define BENCH_FRAME_TIME (1.0f / 60.0f)
+
+#define BENCH_SCREEN_WIDTH 1024
+#define BENCH_SCREEN_HEIGHT 768
+
+#define BENCH_DEFAULT_SEED 1337
+
+// Waiting for the world to be fully visible fails after this many seconds.
+#define BENCH_SETTLE_TIMEOUT 60.0
+
+// Timed loops store their results here so the work isn't optimized away.
+static volatile int g_benchSink;
+
+typedef int(*BenchSuiteFunc)(GameState* state, vector<char*>& args);
+
+struct BenchSuite
+{
+	char* name;
+	char* usage;
+	BenchSuiteFunc func;
+};
+
+static void InitHeadless(GameState* state, char* saveFolder, char* savePath);
+static World* CreateHeadlessWorld(GameState* state, WorldConfig& config, int screenWidth, int screenHeight, int loadRange = LOAD_RANGE);
+static World* CreateSeededWorld(GameState* state, int seed, BiomeType biome, int loadRange = LOAD_RANGE);
+static World* LoadBenchWorld(GameState* state, char* savePath);
+static float BenchFrame(GameState* state, World* world, Player* player, float* updateTime = nullptr);
+static bool WorldFullyVisible(World* world, Player* player);
+static inline float FramePercentile(vector<float>& sorted, float fraction);
+
+// Suites.
+static int RunPathsBench(GameState* state, vector<char*>& args);
+static int RunReplayBench(GameState* state, vector<char*>& args);
+static int RunWorldGenBench(GameState* state, vector<char*>& args);
+static int RunContainerBench(GameState* state, vector<char*>& args);
+static int RunPoolBench(GameState* state, vector<char*>& args);
+static int RunBlockBench(GameState* state, vector<char*>& args);
+static int RunMeshBench(GameState* state, vector<char*>& args);
+static int RunLightBench(GameState* state, vector<char*>& args);
+static int RunAccessBench(GameState* state, vector<char*>& args);
+static int RunRayBench(GameState* state, vector<char*>& args);
+static int RunRangeBench(GameState* state, vector<char*>& args);
+static int RunParticleBench(GameState* state, vector<char*>& args);
+static int RunPhysicsBench(GameState* state, vector<char*>& args);
@@ -2,6 +2,11 @@
 // Gamecraft
 //
 
+static inline bool HasBlockFlag(uint32_t bits, Block block)
+{
+    return ((bits >> block) & 1) != 0;
+}
+
 static inline uint16_t* GetTextures(World* world, Block block)
 {
     return world->blockData[block].textures;
@@ -9,22 +14,22 @@ static inline uint16_t* GetTextures(World* world, Block block)
 
 static inline int GetCull(World* world, Block block)
 {
-    return world->blockData[block].cull;
+    return world->blockProps.cull[block];
 }
 
 static inline bool IsPassable(World* world, Block block)
 {
-    return world->blockData[block].passable;
+    return HasBlockFlag(world->blockProps.passable, block);
 }
 
 static inline bool IsVisible(World* world, Block block)
 {
-    return !world->blockData[block].invisible;
+    return HasBlockFlag(world->blockProps.visible, block);
 }
 
 static inline BlockMeshType GetMeshType(World* world, Block block)
 {
-    return world->blockData[block].meshType;
+    return (BlockMeshType)world->blockProps.meshType[block];
 }
 
 static inline BuildBlockFunc BuildFunc(World* world, Block block)
@@ -64,17 +69,17 @@ static inline BlockCollideFunc GetCollideFunc(World* world, Block block)
 
 static inline bool IsOpaque(World* world, Block block)
 {
-    return world->blockData[block].lightStep == INT_MAX;
+    return HasBlockFlag(world->blockProps.opaque, block);
 }
 
 static inline int GetLightStep(World* world, Block block)
 {
-    return world->blockData[block].lightStep;
+    return world->blockProps.lightStep[block];
 }
 
 static inline int GetLightEmitted(World* world, Block block)
 {
-    return world->blockData[block].lightEmitted;
+    return world->blockProps.lightEmitted[block];
 }
 
 static inline OverTimeDamage GetOverTimeDamage(World* world, Block block)
@@ -84,7 +89,7 @@ static inline OverTimeDamage GetOverTimeDamage(World* world, Block block)
 
 static inline bool IsFluid(World* world, Block block)
 {
-    return world->blockData[block].isFluid;
+    return HasBlockFlag(world->blockProps.fluid, block);
 }
 
 static inline Color GetScreenTint(World* world, Block block)
@@ -125,6 +130,31 @@ static int ComputeAnimationFrame(BlockAnimation& anim, float deltaTime)
     return anim.frames[anim.index];
 }
 
+// Opaque blocks have an infinite light step in the block data. In the property table 
+// any step above the maximum light level has the same effect.
+static void CreateBlockProperties(BlockData* data, BlockProperties& props)
+{
+    static_assert(BLOCK_COUNT <= 32, "The block flags hold one bit per block type.");
+
+    props = {};
+
+    for (uint32_t i = 0; i < BLOCK_COUNT; i++)
+    {
+        BlockData& block = data[i];
+        uint32_t bit = 1u << i;
+
+        if (block.lightStep == INT_MAX) props.opaque |= bit;
+        if (block.passable) props.passable |= bit;
+        if (!block.invisible) props.visible |= bit;
+        if (block.isFluid) props.fluid |= bit;
+
+        props.cull[i] = (uint8_t)block.cull;
+        props.lightStep[i] = (uint8_t)Min(block.lightStep, MAX_LIGHT + 1);
+        props.lightEmitted[i] = (uint8_t)block.lightEmitted;
+        props.meshType[i] = (uint8_t)block.meshType;
+    }
+}
+
 static inline BlockData& CreateDefaultBlock(GameState* state, BlockData* dataArray, BlockType type)
 {
     BlockData& data = dataArray[type];
@@ -99,4 +99,17 @@ struct BlockData
     char* name;
 };
 
+// Properties queried in hot loops such as lighting and meshing, stored compactly so that 
+// the whole table stays in cache. Flags are bitsets indexed by block type, so the number 
+// of block types must not exceed 32. Built from the block data by CreateBlockProperties.
+struct BlockProperties
+{
+    uint32_t opaque, passable, visible, fluid;
+
+    uint8_t cull[BLOCK_COUNT];
+    uint8_t lightStep[BLOCK_COUNT];
+    uint8_t lightEmitted[BLOCK_COUNT];
+    uint8_t meshType[BLOCK_COUNT];
+};
+
 static int ComputeAnimationFrame(BlockAnimation& anim, float deltaTime);
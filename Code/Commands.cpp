@@ -33,7 +33,10 @@ static CommandResult ProcessCommand(GameState* state, CommandProcessor& processo
 	if (str.size() == 0)
 		return { nullptr, PLAYING };
 
-	vector<char*> parts = Split(str, ' ');
+	RecordReplayCommand(state->replay, processor.inputText);
+
+	CommandArgs parts(g_frameArena);
+	Split(str, ' ', parts);
 
 	uint64_t hash = FNVHash(parts[0]);
 	auto it = processor.commands.find(hash);
@@ -75,13 +78,13 @@ static inline bool StringEquals(char* a, char* b)
 	return strcmp(a, b) == 0;
 }
 
-static CommandResult HelpCommand(GameState* state, void*, vector<char*>&)
+static CommandResult HelpCommand(GameState* state, void*, CommandArgs&)
 {
 	state->cmdProcessor.help = true;
 	return { nullptr, ENTERING_COMMAND };
 }
 
-static CommandResult PlayerSpeedCommand(GameState*, void* playerPtr, vector<char*>& args)
+static CommandResult PlayerSpeedCommand(GameState*, void* playerPtr, CommandArgs& args)
 {
 	if (args.size() != 2) return { "Usage: speed <value>" };
 
@@ -96,7 +99,7 @@ static CommandResult PlayerSpeedCommand(GameState*, void* playerPtr, vector<char
 	return { nullptr };
 }
 
-static CommandResult PlayerFlySpeedCommand(GameState*, void* playerPtr, vector<char*>& args)
+static CommandResult PlayerFlySpeedCommand(GameState*, void* playerPtr, CommandArgs& args)
 {
 	if (args.size() != 2) return { "Usage: flyspeed <value>" };
 
@@ -111,7 +114,7 @@ static CommandResult PlayerFlySpeedCommand(GameState*, void* playerPtr, vector<c
 	return { nullptr };
 }
 
-static CommandResult PlayerHealthCommand(GameState*, void* playerPtr, vector<char*>& args)
+static CommandResult PlayerHealthCommand(GameState*, void* playerPtr, CommandArgs& args)
 {
 	if (args.size() != 2) return { "Usage: health <value>" };
 
@@ -126,14 +129,14 @@ static CommandResult PlayerHealthCommand(GameState*, void* playerPtr, vector<cha
 	return { nullptr };
 }
 
-static CommandResult PlayerKillCommand(GameState*, void* playerPtr, vector<char*>&)
+static CommandResult PlayerKillCommand(GameState*, void* playerPtr, CommandArgs&)
 {
 	Player* player = (Player*)playerPtr;
 	player->health = 0;
 	return { nullptr };
 }
 
-static CommandResult PlayerJumpCommand(GameState*, void* playerPtr, vector<char*>& args)
+static CommandResult PlayerJumpCommand(GameState*, void* playerPtr, CommandArgs& args)
 {
 	if (args.size() != 2) return { "Usage: jump <value>" };
 
@@ -148,7 +151,7 @@ static CommandResult PlayerJumpCommand(GameState*, void* playerPtr, vector<char*
 	return { nullptr };
 }
 
-static CommandResult PlayerTeleportCommand(GameState* state, void* worldPtr, vector<char*>& args)
+static CommandResult PlayerTeleportCommand(GameState* state, void* worldPtr, CommandArgs& args)
 {
 	if (args.size() == 2)
 	{
@@ -181,16 +184,31 @@ static CommandResult PlayerTeleportCommand(GameState* state, void* worldPtr, vec
 	else return { "Usage: teleport <x> <y> <z> or teleport home" };
 }
 
-static CommandResult SetHomeCommand(GameState*, void* worldPtr, vector<char*>&)
+static CommandResult SetHomeCommand(GameState*, void* worldPtr, CommandArgs&)
 {
 	World* world = (World*)worldPtr;
 	SetHomePos(world, world->player);
 	return { nullptr };
 }
 
+static CommandResult GroupCacheCommand(GameState*, void* worldPtr, CommandArgs& args)
+{
+	if (args.size() != 2) return { "Usage: groupcache <megabytes>" };
+
+	int megabytes;
+
+	if (!IsInt(args[1], megabytes) && !StringEquals(args[1], "0"))
+		return { "Invalid argument given to the groupcache command." };
+
+	megabytes = Clamp(megabytes, 0, 4096);
+	SetGroupCacheBudget((World*)worldPtr, (int64_t)megabytes * 1024 * 1024);
+
+	return { nullptr };
+}
+
 #if DEBUG_SERVICES
 
-static CommandResult ChunkOutlinesCommand(GameState*, void*, vector<char*>&)
+static CommandResult ChunkOutlinesCommand(GameState*, void*, CommandArgs&)
 {
 	 g_debugTable.showOutlines = !g_debugTable.showOutlines;
 	 return { nullptr };
@@ -198,22 +216,33 @@ static CommandResult ChunkOutlinesCommand(GameState*, void*, vector<char*>&)
 
 static void StopProfilerCommand(GameState* state, void* windowPtr)
 {
+	#if !HEADLESS
 	GLFWwindow* window = (GLFWwindow*)windowPtr;
 	state->savedInputMode = glfwGetInputMode(window, GLFW_CURSOR);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+	#else
+	Unused(state);
+	Unused(windowPtr);
+	#endif
+
     g_debugTable.profilerState = PROFILER_STOPPED;
 }
 
 static void StartProfilerCommand(GameState* state, void* windowPtr)
 {
+	#if !HEADLESS
 	GLFWwindow* window = (GLFWwindow*)windowPtr;
 	glfwSetInputMode(window, GLFW_CURSOR, state->savedInputMode);
+	#else
+	Unused(windowPtr);
+	#endif
+
     CenterCursor();
     g_debugTable.profilerState = PROFILER_RECORDING;
     state->debugDisplay = true;
 }
 
-static CommandResult ProfilerCommand(GameState* state, void* windowPtr, vector<char*>& args)
+static CommandResult ProfilerCommand(GameState* state, void* windowPtr, CommandArgs& args)
 {
 	if (args.size() != 2)
 		return { "Usage: profiler <start, stop, hide>" };
@@ -243,7 +272,117 @@ static CommandResult ProfilerCommand(GameState* state, void* windowPtr, vector<c
 	return { "Invalid argument given to the profiler command." };
 }
 
-static CommandResult FastProfilerToggleCommand(GameState* state, void* windowPtr, vector<char*>&)
+static CommandResult TraceCommand(GameState*, void*, CommandArgs& args)
+{
+	if (args.size() > 2)
+		return { "Usage: trace <frames>" };
+
+	int frames = DEFAULT_TRACE_FRAMES;
+
+	if (args.size() == 2 && (!IsInt(args[1], frames) || frames <= 0 || frames > 10000))
+		return { "Frames must be between 1 and 10000." };
+
+	BeginTrace(frames);
+
+	static char result[64];
+	sprintf(result, "Capturing a trace of %i frames.", frames);
+	return { result };
+}
+
+static CommandResult ProfileCommand(GameState*, void*, CommandArgs& args)
+{
+	if (args.size() != 2)
+		return { "Usage: profile <export, baseline, reset>" };
+
+	char path[MAX_PATH];
+
+	if (StringEquals(args[1], "export"))
+	{
+		if (!ExportProfileStats(PathToExe("ProfileStats.csv", path, MAX_PATH)))
+			return { "Failed to write ProfileStats.csv." };
+
+		return { "Wrote the profile stats to ProfileStats.csv." };
+	}
+
+	if (StringEquals(args[1], "baseline"))
+	{
+		if (!SaveProfileBaseline(PathToExe("Baseline.txt", path, MAX_PATH)))
+			return { "Failed to write Baseline.txt." };
+
+		return { "Saved the current profile stats as the baseline." };
+	}
+
+	if (StringEquals(args[1], "reset"))
+	{
+		ResetProfileStats();
+		return { nullptr };
+	}
+
+	return { "Invalid argument given to the profile command." };
+}
+
+static CommandResult MemoryCommand(GameState*, void*, CommandArgs& args)
+{
+	if (args.size() == 1)
+	{
+		char path[MAX_PATH];
+		int64_t total = DumpMemoryStats(PathToExe("Memory.csv", path, MAX_PATH));
+
+		if (total < 0)
+			return { "Failed to write Memory.csv." };
+
+		static char result[128];
+		sprintf(result, "Wrote the tracked memory to Memory.csv. %.1f MB tracked in total.", total / (1024.0 * 1024.0));
+		return { result };
+	}
+
+	if (args.size() == 2 && StringEquals(args[1], "peak"))
+	{
+		ResetMemoryPeaks();
+		return { nullptr };
+	}
+
+	// Reports the average heap traffic per frame since the last report and starts over.
+	if (args.size() == 2 && StringEquals(args[1], "traffic"))
+	{
+		#if HEAP_TRAFFIC
+		HeapTrafficStats& h = g_heapTraffic;
+		int frames = Max(h.frames, 1);
+
+		static char result[192];
+		sprintf(result, "Heap traffic over %i frames: %.1f allocations (%.1f KB) per frame on the main thread, %.1f (%.1f KB) on all threads.",
+			h.frames, (double)h.mainTotal.allocs / frames, h.mainTotal.bytes / 1024.0 / frames,
+			(double)h.allTotal.allocs / frames, h.allTotal.bytes / 1024.0 / frames);
+
+		ResetHeapTraffic();
+		return { result };
+		#else
+		return { "Heap traffic is only counted in builds with HEAP_TRAFFIC set." };
+		#endif
+	}
+
+	if (args.size() == 4 && StringEquals(args[1], "budget"))
+	{
+		int tag = FindMemoryTag(args[2]);
+
+		if (tag < 0)
+			return { "Unknown memory tag." };
+
+		int megabytes;
+
+		if (!IsInt(args[3], megabytes) || megabytes < 0)
+			return { "The budget must be 0 or more megabytes." };
+
+		g_memory.budgets[tag] = (int64_t)megabytes * 1024 * 1024;
+		g_memory.overBudget[tag] = false;
+
+		return { nullptr };
+	}
+
+	return { "Usage: memory [peak, traffic, budget <tag> <megabytes>]" };
+}
+
+static CommandResult FastProfilerToggleCommand(GameState* state, void* windowPtr, CommandArgs&)
 {
 	DebugTable& t = g_debugTable;
 
@@ -256,3 +395,32 @@ static CommandResult FastProfilerToggleCommand(GameState* state, void* windowPtr
 }
 
 #endif
+
+#if PIPELINE_STATS
+
+static CommandResult PipelineCommand(GameState*, void*, CommandArgs& args)
+{
+	if (args.size() != 2)
+		return { "Usage: pipeline <reset, log>" };
+
+	if (StringEquals(args[1], "reset"))
+	{
+		ResetPipelineStats();
+		return { "Pipeline stats cleared." };
+	}
+
+	if (StringEquals(args[1], "log"))
+	{
+		if (!TogglePipelineLog())
+			return { "Failed to open Pipeline.csv." };
+
+		if (g_pipelineStats.log != nullptr)
+			return { "Logging pipeline stats to Pipeline.csv." };
+
+		return { "Stopped logging pipeline stats." };
+	}
+
+	return { "Invalid argument given to the pipeline command." };
+}
+
+#endif
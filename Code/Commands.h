@@ -10,7 +10,10 @@ struct CommandResult
 	int newState;
 };
 	
-using CommandFunc = CommandResult(*)(GameState* state, void* data, vector<char*>& args);
+// Commands are run on the main thread, and their arguments are allocated from the frame arena.
+using CommandArgs = ArenaVector<char*>;
+
+using CommandFunc = CommandResult(*)(GameState* state, void* data, CommandArgs& args);
 
 struct Command
 {
@@ -33,17 +36,25 @@ static void RegisterCommand(GameState* state, char* text, CommandFunc func, void
 static CommandResult ProcessCommand(GameState* state, CommandProcessor& processor);
 
 // Command functions.
-static CommandResult HelpCommand(GameState* state, void*, vector<char*>&);
-static CommandResult PlayerSpeedCommand(GameState* state, void* playerPtr, vector<char*>& args);
-static CommandResult PlayerHealthCommand(GameState* state, void* playerPtr, vector<char*>& args);
-static CommandResult PlayerFlySpeedCommand(GameState* state, void* playerPtr, vector<char*>& args);
-static CommandResult PlayerKillCommand(GameState* state, void* playerPtr, vector<char*>& args);
-static CommandResult PlayerJumpCommand(GameState* state, void* playerPtr, vector<char*>&);
-static CommandResult PlayerTeleportCommand(GameState* state, void* worldPtr, vector<char*>&);
-static CommandResult SetHomeCommand(GameState* state, void* worldPtr, vector<char*>& args);
+static CommandResult HelpCommand(GameState* state, void*, CommandArgs&);
+static CommandResult PlayerSpeedCommand(GameState* state, void* playerPtr, CommandArgs& args);
+static CommandResult PlayerHealthCommand(GameState* state, void* playerPtr, CommandArgs& args);
+static CommandResult PlayerFlySpeedCommand(GameState* state, void* playerPtr, CommandArgs& args);
+static CommandResult PlayerKillCommand(GameState* state, void* playerPtr, CommandArgs& args);
+static CommandResult PlayerJumpCommand(GameState* state, void* playerPtr, CommandArgs&);
+static CommandResult PlayerTeleportCommand(GameState* state, void* worldPtr, CommandArgs&);
+static CommandResult SetHomeCommand(GameState* state, void* worldPtr, CommandArgs& args);
+static CommandResult GroupCacheCommand(GameState* state, void* worldPtr, CommandArgs& args);
 
 #if DEBUG_SERVICES
-static CommandResult ChunkOutlinesCommand(GameState*, void*, vector<char*>&);
-static CommandResult ProfilerCommand(GameState* state, void* windowPtr, vector<char*>& args);
-static CommandResult FastProfilerToggleCommand(GameState* state, void* windowPtr, vector<char*>&);
+static CommandResult ChunkOutlinesCommand(GameState*, void*, CommandArgs&);
+static CommandResult ProfilerCommand(GameState* state, void* windowPtr, CommandArgs& args);
+static CommandResult FastProfilerToggleCommand(GameState* state, void* windowPtr, CommandArgs&);
+static CommandResult TraceCommand(GameState*, void*, CommandArgs& args);
+static CommandResult ProfileCommand(GameState*, void*, CommandArgs& args);
+static CommandResult MemoryCommand(GameState*, void*, CommandArgs& args);
+#endif
+
+#if PIPELINE_STATS
+static CommandResult PipelineCommand(GameState*, void*, CommandArgs& args);
 #endif
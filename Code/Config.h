@@ -2,7 +2,35 @@
 // Gamecraft
 //
 
+#ifndef DEBUG_SERVICES
 #define DEBUG_SERVICES 1
+#endif
+
+// Latency histograms and queue depths for the loading pipeline. They're kept with the 
+// debug services by default, and the benchmark build sets this on its own so that it 
+// can report them without the profiler running.
+#ifndef PIPELINE_STATS
+#define PIPELINE_STATS DEBUG_SERVICES
+#endif
+
+// Number of groups loaded on each side of the player's group.
+#define LOAD_RANGE 8
+
+// If set, only groups within a circle of the load range are loaded. Otherwise, 
+// the whole square around the player's group is loaded.
+#define CIRCULAR_LOAD_AREA 1
+
+// Set by the benchmark build (Build.bat -b). The game runs without a window, audio 
+// or OpenGL context, so mesh uploads and other GL calls are skipped.
+#ifndef HEADLESS
+#define HEADLESS 0
+#endif
+
+// Counts the allocations made through operator new, to measure heap traffic per frame. 
+// Only the benchmark build sets this, since counting adds work to every allocation.
+#ifndef HEAP_TRAFFIC
+#define HEAP_TRAFFIC 0
+#endif
 
 #if DEBUG_SERVICES
 #pragma message("Profiling enabled.")
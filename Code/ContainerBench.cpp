@@ -0,0 +1,802 @@
+//
+// Gamecraft
+//
+
+// Container and sort micro-benchmarks, run with GamecraftBench containers. The engine's
+// containers, object pools and sorts are timed against their standard equivalents at
+// several sizes, using the element types they hold in the game. Times are in nanoseconds
+// per element and are written to the console and to ContainerBench.csv. The priority queue
+// and the sorts are also checked against the standard results, and the exit code is nonzero
+// if any differ. GamecraftBench pools runs the pool contention benchmark at the end of
+// this file.
+
+// Elements processed per measurement. Small sizes are repeated to reach it.
+#define CONTAINER_BENCH_ELEMENTS 1048576
+
+// The quadratic sorts are only run up to this size.
+#define CONTAINER_BENCH_MAX_QUADRATIC 4096
+
+#define CONTAINER_BENCH_SIZES 4
+#define CONTAINER_BENCH_SEED 1337
+
+static int g_containerBenchSizes[CONTAINER_BENCH_SIZES] = { 16, 256, 4096, 65536 };
+
+// Entry in a scheduling heap, such as groups waiting to be loaded by priority.
+struct BenchTask
+{
+	float priority;
+	ChunkGroup* group;
+};
+
+static inline bool operator<(BenchTask a, BenchTask b) { return a.priority < b.priority; }
+static inline bool operator>(BenchTask a, BenchTask b) { return a.priority > b.priority; }
+static inline bool operator<=(BenchTask a, BenchTask b) { return a.priority <= b.priority; }
+static inline bool operator>=(BenchTask a, BenchTask b) { return a.priority >= b.priority; }
+static inline bool operator==(BenchTask a, BenchTask b) { return a.priority == b.priority && a.group == b.group; }
+
+struct ContainerBenchRow
+{
+	char* name;
+	char* type;
+	int size;
+
+	// Nanoseconds per element. The standard time is 0 if there's no equivalent.
+	double ours, standard;
+};
+
+struct ContainerBench
+{
+	vector<ContainerBenchRow> rows;
+	RandomStream random;
+
+	// Accumulates values read from the containers so that the work isn't optimized away.
+	uint64_t sink;
+	bool failed;
+};
+
+static inline int BenchRepeats(int size)
+{
+	return Max(CONTAINER_BENCH_ELEMENTS / size, 1);
+}
+
+static inline double NsPerElement(double seconds, int size, int repeats)
+{
+	return seconds * 1e9 / ((double)size * repeats);
+}
+
+static inline void AddBenchRow(ContainerBench& bench, char* name, char* type, int size, double ours, double standard)
+{
+	bench.rows.push_back({ name, type, size, ours, standard });
+}
+
+static inline float BenchRandom01(RandomStream& random)
+{
+	return (NextRandom(random) & 0xFFFFFF) / (float)0x1000000;
+}
+
+// Light nodes within a few groups of the origin, in local world coordinates.
+static inline void MakeBenchValue(RandomStream& random, ivec3& value)
+{
+	value = ivec3(NextRandom(random) % 512, NextRandom(random) % WORLD_BLOCK_HEIGHT, NextRandom(random) % 512);
+}
+
+// The pointers are never dereferenced.
+static inline void MakeBenchValue(RandomStream& random, ChunkGroup*& value)
+{
+	value = (ChunkGroup*)((uintptr_t)(NextRandom(random) | 1) * sizeof(void*));
+}
+
+static inline void MakeBenchValue(RandomStream& random, AABB& value)
+{
+	value.center = vec3(BenchRandom01(random), BenchRandom01(random), BenchRandom01(random)) * 512.0f;
+	value.radius = vec3(0.3f, 0.9f, 0.3f);
+}
+
+static inline void MakeBenchValue(RandomStream& random, BenchTask& value)
+{
+	value.priority = BenchRandom01(random) * 1000.0f;
+	MakeBenchValue(random, value.group);
+}
+
+template <typename T>
+static vector<T> MakeBenchValues(ContainerBench& bench, int size)
+{
+	vector<T> values(size);
+
+	for (int i = 0; i < size; i++)
+		MakeBenchValue(bench.random, values[i]);
+
+	return values;
+}
+
+// Appends to a list that's cleared between repeats, and separately grows a new list
+// from empty each repeat.
+template <typename T>
+static void BenchList(ContainerBench& bench, char* type, vector<T>& values)
+{
+	int size = (int)values.size();
+	int repeats = BenchRepeats(size);
+
+	List<T> list = {};
+	list.Reserve(size);
+
+	double start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		list.Clear();
+
+		for (int i = 0; i < size; i++)
+			list.Add(values[i]);
+
+		bench.sink += list.size;
+	}
+
+	double ours = glfwGetTime() - start;
+	list.Free();
+
+	vector<T> vec;
+	vec.reserve(size);
+
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		vec.clear();
+
+		for (int i = 0; i < size; i++)
+			vec.push_back(values[i]);
+
+		bench.sink += vec.size();
+	}
+
+	double standard = glfwGetTime() - start;
+	AddBenchRow(bench, "List append", type, size, NsPerElement(ours, size, repeats), NsPerElement(standard, size, repeats));
+
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		List<T> grown = {};
+
+		for (int i = 0; i < size; i++)
+			grown.Add(values[i]);
+
+		bench.sink += grown.size;
+		grown.Free();
+	}
+
+	ours = glfwGetTime() - start;
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		vector<T> grown;
+
+		for (int i = 0; i < size; i++)
+			grown.push_back(values[i]);
+
+		bench.sink += grown.size();
+	}
+
+	standard = glfwGetTime() - start;
+	AddBenchRow(bench, "List grow", type, size, NsPerElement(ours, size, repeats), NsPerElement(standard, size, repeats));
+}
+
+// Fills the queue and then drains it, as the light scattering does with its nodes.
+template <typename T>
+static void BenchQueue(ContainerBench& bench, char* type, vector<T>& values)
+{
+	int size = (int)values.size();
+	int repeats = BenchRepeats(size);
+
+	int capacity = 2;
+
+	while (capacity <= size)
+		capacity *= 2;
+
+	Queue<T> ours(capacity, MEMORY_OTHER);
+	double start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			ours.Enqueue(values[i]);
+
+		while (!ours.Empty())
+		{
+			T item = ours.Dequeue();
+			bench.sink += *(uint8_t*)&item;
+		}
+	}
+
+	double oursTime = glfwGetTime() - start;
+
+	queue<T> standard;
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			standard.push(values[i]);
+
+		while (!standard.empty())
+		{
+			bench.sink += *(uint8_t*)&standard.front();
+			standard.pop();
+		}
+	}
+
+	double standardTime = glfwGetTime() - start;
+	AddBenchRow(bench, "Queue fill/drain", type, size, NsPerElement(oursTime, size, repeats), NsPerElement(standardTime, size, repeats));
+}
+
+// Inserts every task and then removes them in priority order.
+static void BenchPriorityQueue(ContainerBench& bench, vector<BenchTask>& values)
+{
+	int size = (int)values.size();
+	int repeats = BenchRepeats(size);
+
+	PriorityQueue<BenchTask> ours;
+	ours.items.reserve(size);
+
+	double start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			ours.Insert(values[i]);
+
+		while (!ours.Empty())
+			bench.sink += (uint64_t)ours.RemoveHighest().priority;
+	}
+
+	double oursTime = glfwGetTime() - start;
+
+	vector<BenchTask> storage;
+	storage.reserve(size);
+	priority_queue<BenchTask> standard(less<BenchTask>(), move(storage));
+
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			standard.push(values[i]);
+
+		while (!standard.empty())
+		{
+			bench.sink += (uint64_t)standard.top().priority;
+			standard.pop();
+		}
+	}
+
+	double standardTime = glfwGetTime() - start;
+	AddBenchRow(bench, "PriorityQueue push/pop", "BenchTask", size, NsPerElement(oursTime, size, repeats), NsPerElement(standardTime, size, repeats));
+}
+
+template <typename T>
+static void FreePool(ObjectPool<T>& pool)
+{
+	while (!pool.items.empty())
+	{
+		TRACK_FREE(pool.tag, sizeof(T));
+		delete pool.items.front();
+		pool.items.pop();
+	}
+}
+
+// Takes the given number of items from the pool and returns them all, compared with
+// allocating and deleting them. Both allocate new items with new T(), as the pool does.
+template <typename T, typename Pool>
+static void BenchPool(ContainerBench& bench, Pool& pool, char* name, char* type, int size, int repeats)
+{
+	vector<T*> taken(size);
+
+	double start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			taken[i] = pool.Get();
+
+		for (int i = 0; i < size; i++)
+			pool.Return(taken[i]);
+	}
+
+	double ours = glfwGetTime() - start;
+	start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		for (int i = 0; i < size; i++)
+			taken[i] = new T();
+
+		for (int i = 0; i < size; i++)
+		{
+			bench.sink += *(uint8_t*)taken[i];
+			delete taken[i];
+		}
+	}
+
+	double standard = glfwGetTime() - start;
+	AddBenchRow(bench, name, type, size, NsPerElement(ours, size, repeats), NsPerElement(standard, size, repeats));
+}
+
+enum BenchSort
+{
+	BENCH_SORT_BUBBLE,
+	BENCH_SORT_INSERTION,
+	BENCH_SORT_SELECTION,
+	BENCH_SORT_QUICK,
+	BENCH_SORT_MERGE,
+	BENCH_SORT_COUNT
+};
+
+static char* g_benchSortNames[BENCH_SORT_COUNT] = { "BubbleSort", "InsertionSort", "SelectionSort", "QuickSort", "MergeSort" };
+
+template <typename T>
+static void RunBenchSort(BenchSort type, T* items, int size)
+{
+	switch (type)
+	{
+		case BENCH_SORT_BUBBLE:
+			BubbleSort(items, size);
+			break;
+
+		case BENCH_SORT_INSERTION:
+			InsertionSort(items, size);
+			break;
+
+		case BENCH_SORT_SELECTION:
+			SelectionSort(items, size);
+			break;
+
+		case BENCH_SORT_QUICK:
+			QuickSort(items, 0, size - 1);
+			break;
+
+		case BENCH_SORT_MERGE:
+			MergeSort(items, size);
+			break;
+	}
+}
+
+// Sorts a copy of the same unsorted values each repeat. The copy is timed along with
+// the sort for every method, including std::sort.
+template <typename T>
+static void BenchSorts(ContainerBench& bench, char* type, vector<T>& values)
+{
+	int size = (int)values.size();
+	int repeats = Max(BenchRepeats(size) / 16, 1);
+
+	vector<T> items(size);
+	double start = glfwGetTime();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		copy(values.begin(), values.end(), items.begin());
+		sort(items.begin(), items.end());
+		bench.sink += *(uint8_t*)&items[0];
+	}
+
+	double standard = NsPerElement(glfwGetTime() - start, size, repeats);
+
+	for (int s = 0; s < BENCH_SORT_COUNT; s++)
+	{
+		bool quadratic = s <= BENCH_SORT_SELECTION;
+
+		if (quadratic && size > CONTAINER_BENCH_MAX_QUADRATIC)
+			continue;
+
+		start = glfwGetTime();
+
+		for (int r = 0; r < repeats; r++)
+		{
+			copy(values.begin(), values.end(), items.begin());
+			RunBenchSort((BenchSort)s, items.data(), size);
+			bench.sink += *(uint8_t*)&items[0];
+		}
+
+		double ours = NsPerElement(glfwGetTime() - start, size, repeats);
+		AddBenchRow(bench, g_benchSortNames[s], type, size, ours, standard);
+
+		if (!is_sorted(items.begin(), items.end()))
+		{
+			printf("%s produced unsorted %s values at size %i.\n", g_benchSortNames[s], type, size);
+			bench.failed = true;
+		}
+	}
+}
+
+// Checks that the priority queue removes tasks in the same order as the standard
+// queue, and that removing arbitrary tasks keeps the heap ordered.
+static bool TestPriorityQueue(ContainerBench& bench)
+{
+	vector<BenchTask> values = MakeBenchValues<BenchTask>(bench, 4096);
+
+	PriorityQueue<BenchTask> ours;
+	priority_queue<BenchTask> standard;
+
+	for (BenchTask task : values)
+	{
+		ours.Insert(task);
+		standard.push(task);
+	}
+
+	while (!standard.empty())
+	{
+		if (ours.Empty() || ours.RemoveHighest().priority != standard.top().priority)
+			return false;
+
+		standard.pop();
+	}
+
+	if (!ours.Empty())
+		return false;
+
+	for (BenchTask task : values)
+		ours.Insert(task);
+
+	for (int i = 0; i < (int)values.size(); i += 3)
+	{
+		BenchTask task = values[i];
+
+		if (!ours.Exists(task))
+			return false;
+
+		ours.Remove(task);
+
+		if (ours.Exists(task))
+			return false;
+	}
+
+	int remaining = ours.Size();
+	float last = FLT_MAX;
+
+	while (!ours.Empty())
+	{
+		float priority = ours.RemoveHighest().priority;
+
+		if (priority > last)
+			return false;
+
+		last = priority;
+		remaining--;
+	}
+
+	return remaining == 0;
+}
+
+static void ReportContainerBench(ContainerBench& bench)
+{
+	char path[MAX_PATH];
+	FILE* file = fopen(PathToExe("ContainerBench.csv", path, MAX_PATH), "w");
+
+	if (file != nullptr)
+		fprintf(file, "test,type,size,ours,standard,ratio\n");
+
+	printf("Containers: build %i, ns per element\n\n", g_buildID);
+	printf("%-24s %-12s %8s %12s %12s %8s\n", "test", "type", "size", "ours", "standard", "ratio");
+
+	for (ContainerBenchRow& row : bench.rows)
+	{
+		double ratio = row.standard > 0.0 ? row.ours / row.standard : 0.0;
+
+		printf("%-24s %-12s %8i %12.2f %12.2f %8.2f\n", row.name, row.type, row.size, row.ours, row.standard, ratio);
+
+		if (file != nullptr)
+			fprintf(file, "%s,%s,%i,%.3f,%.3f,%.3f\n", row.name, row.type, row.size, row.ours, row.standard, ratio);
+	}
+
+	g_benchSink = (int)bench.sink;
+
+	if (file != nullptr)
+		fclose(file);
+}
+
+static int RunContainerBench(GameState*, vector<char*>&)
+{
+	ContainerBench bench = {};
+	bench.random = NewRandomStream(CONTAINER_BENCH_SEED);
+
+	if (!TestPriorityQueue(bench))
+	{
+		printf("The priority queue removed tasks out of order.\n");
+		bench.failed = true;
+	}
+
+	for (int i = 0; i < CONTAINER_BENCH_SIZES; i++)
+	{
+		int size = g_containerBenchSizes[i];
+
+		vector<ivec3> nodes = MakeBenchValues<ivec3>(bench, size);
+		vector<ChunkGroup*> groups = MakeBenchValues<ChunkGroup*>(bench, size);
+		vector<AABB> boxes = MakeBenchValues<AABB>(bench, size);
+		vector<BenchTask> tasks = MakeBenchValues<BenchTask>(bench, size);
+
+		BenchList(bench, "ivec3", nodes);
+		BenchList(bench, "ChunkGroup*", groups);
+		BenchList(bench, "AABB", boxes);
+
+		BenchQueue(bench, "ivec3", nodes);
+		BenchQueue(bench, "ChunkGroup*", groups);
+
+		BenchPriorityQueue(bench, tasks);
+
+		ObjectPool<AABB> pool;
+		BenchPool<AABB>(bench, pool, "ObjectPool", "AABB", size, BenchRepeats(size));
+		FreePool(pool);
+
+		SharedObjectPool<AABB> sharedPool;
+		sharedPool.maxMagazines = size / POOL_MAGAZINE_SIZE + 1;
+		BenchPool<AABB>(bench, sharedPool, "SharedObjectPool", "AABB", size, BenchRepeats(size));
+		sharedPool.Free();
+
+		BenchSorts(bench, "ChunkGroup*", groups);
+		BenchSorts(bench, "BenchTask", tasks);
+	}
+
+	// Groups are pooled in the world since each is over a megabyte. Only a load area's
+	// worth are allocated.
+	ObjectPool<ChunkGroup> groupPool;
+	BenchPool<ChunkGroup>(bench, groupPool, "ObjectPool", "ChunkGroup", 64, 4);
+	FreePool(groupPool);
+
+	ReportContainerBench(bench);
+
+	return bench.failed ? 1 : 0;
+}
+
+// Pool contention benchmark, run with GamecraftBench pools. Threads take and return rows of
+// items the way ShiftWorld creates and destroys a row of groups, either returning their own
+// rows or, after a barrier, the rows taken by another thread. The shared pool is compared
+// with an object pool behind a critical section, as LockedObjectPool was.
+
+#define POOL_STORM_MAX_THREADS 16
+#define POOL_STORM_ROW (LOAD_RANGE * 2 + 1)
+#define POOL_STORM_ROUNDS 20000
+
+enum PoolStormPattern
+{
+	POOL_STORM_LOCAL,
+	POOL_STORM_HANDOFF,
+	POOL_STORM_PATTERN_COUNT
+};
+
+static char* g_poolStormPatterns[POOL_STORM_PATTERN_COUNT] = { "local", "handoff" };
+
+// Stands in for a pooled object. Sized so that touching it costs about as much as
+// initializing a small record.
+struct PoolStormItem
+{
+	ChunkP pos;
+	uint8_t payload[240];
+};
+
+template <typename T>
+struct CriticalSectionPool
+{
+	ObjectPool<T> pool;
+	CRITICAL_SECTION cs;
+	int64_t gets, allocs, contended;
+
+	CriticalSectionPool()
+	{
+		InitializeCriticalSection(&cs);
+		gets = 0;
+		allocs = 0;
+		contended = 0;
+	}
+
+	~CriticalSectionPool()
+	{
+		DeleteCriticalSection(&cs);
+	}
+
+	void Lock()
+	{
+		if (!TryEnterCriticalSection(&cs))
+		{
+			EnterCriticalSection(&cs);
+			contended++;
+		}
+	}
+
+	T* Get()
+	{
+		Lock();
+		gets++;
+
+		if (pool.items.empty())
+			allocs++;
+
+		T* item = pool.Get();
+		LeaveCriticalSection(&cs);
+		return item;
+	}
+
+	void Return(T* item)
+	{
+		Lock();
+		pool.Return(item);
+		LeaveCriticalSection(&cs);
+	}
+};
+
+struct PoolStorm
+{
+	// Configuration of the current run.
+	PoolStormPattern pattern;
+	int threads, rounds;
+	bool shared;
+
+	CriticalSectionPool<PoolStormItem>* lockedPool;
+	SharedObjectPool<PoolStormItem>* sharedPool;
+
+	PoolStormItem* rows[POOL_STORM_MAX_THREADS][POOL_STORM_ROW];
+	SYNCHRONIZATION_BARRIER barrier;
+
+	// The storm threads are created once and reused by every run, so that starting
+	// them isn't part of the time measured.
+	HANDLE wake[POOL_STORM_MAX_THREADS];
+	bool quit;
+};
+
+struct PoolStormThread
+{
+	PoolStorm* storm;
+	int index;
+};
+
+template <typename Pool>
+static void RunPoolStormThread(PoolStorm* storm, Pool* pool, int index)
+{
+	int handoff = (index + 1) % storm->threads;
+	PoolStormItem** row = storm->rows[index];
+
+	for (int r = 0; r < storm->rounds; r++)
+	{
+		for (int i = 0; i < POOL_STORM_ROW; i++)
+		{
+			PoolStormItem* item = pool->Get();
+			item->pos = ivec3(r, index, i);
+			item->payload[i] = (uint8_t)r;
+			row[i] = item;
+		}
+
+		if (storm->pattern == POOL_STORM_HANDOFF)
+		{
+			EnterSynchronizationBarrier(&storm->barrier, 0);
+
+			for (int i = 0; i < POOL_STORM_ROW; i++)
+				pool->Return(storm->rows[handoff][i]);
+
+			EnterSynchronizationBarrier(&storm->barrier, 0);
+		}
+		else
+		{
+			for (int i = POOL_STORM_ROW - 1; i >= 0; i--)
+				pool->Return(row[i]);
+		}
+	}
+
+	// The last thread to arrive ends the run.
+	EnterSynchronizationBarrier(&storm->barrier, 0);
+}
+
+static void RunPoolStormThread(PoolStorm* storm, int index)
+{
+	if (storm->shared)
+		RunPoolStormThread(storm, storm->sharedPool, index);
+	else RunPoolStormThread(storm, storm->lockedPool, index);
+}
+
+static DWORD WINAPI PoolStormProc(LPVOID ptr)
+{
+	PoolStormThread* thread = (PoolStormThread*)ptr;
+	PoolStorm* storm = thread->storm;
+
+	while (true)
+	{
+		WaitForSingleObject(storm->wake[thread->index], INFINITE);
+
+		if (storm->quit)
+			return 0;
+
+		RunPoolStormThread(storm, thread->index);
+	}
+}
+
+// Runs the storm on the main thread and threads - 1 storm threads. Returns
+// millions of get and return pairs per second.
+static double RunPoolStorm(PoolStorm& storm, PoolStormPattern pattern, int threads, bool shared)
+{
+	storm.pattern = pattern;
+	storm.threads = threads;
+	storm.shared = shared;
+	storm.rounds = pattern == POOL_STORM_HANDOFF ? POOL_STORM_ROUNDS / 10 : POOL_STORM_ROUNDS;
+
+	InitializeSynchronizationBarrier(&storm.barrier, threads, -1);
+
+	double start = glfwGetTime();
+
+	for (int i = 1; i < threads; i++)
+		SetEvent(storm.wake[i]);
+
+	RunPoolStormThread(&storm, 0);
+
+	double seconds = glfwGetTime() - start;
+	DeleteSynchronizationBarrier(&storm.barrier);
+
+	double pairs = (double)storm.rounds * POOL_STORM_ROW * threads;
+	return pairs / seconds / 1e6;
+}
+
+static void RunPoolStorms()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	int maxThreads = Clamp((int)info.dwNumberOfProcessors, 1, POOL_STORM_MAX_THREADS);
+
+	PoolStorm* storm = new PoolStorm();
+	PoolStormThread threads[POOL_STORM_MAX_THREADS];
+
+	for (int i = 1; i < maxThreads; i++)
+	{
+		threads[i] = { storm, i };
+		storm->wake[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+		HANDLE handle = CreateThread(NULL, 0, PoolStormProc, threads + i, 0, NULL);
+		CloseHandle(handle);
+	}
+
+	printf("Pool storms: %i-item rows, Mpairs/s\n\n", POOL_STORM_ROW);
+	printf("%-8s %8s %12s %12s %8s %12s %12s\n", "pattern", "threads", "locked", "shared", "ratio", "reuse", "contended");
+
+	for (int p = 0; p < POOL_STORM_PATTERN_COUNT; p++)
+	{
+		for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+		{
+			CriticalSectionPool<PoolStormItem>* lockedPool = new CriticalSectionPool<PoolStormItem>();
+			SharedObjectPool<PoolStormItem>* sharedPool = new SharedObjectPool<PoolStormItem>();
+
+			storm->lockedPool = lockedPool;
+			storm->sharedPool = sharedPool;
+
+			double locked = RunPoolStorm(*storm, (PoolStormPattern)p, threadCount, false);
+			double shared = RunPoolStorm(*storm, (PoolStormPattern)p, threadCount, true);
+
+			PoolStats stats = sharedPool->GetStats();
+			double reuse = stats.gets > 0 ? 100.0 * (1.0 - (double)stats.allocs / stats.gets) : 0.0;
+			double lockedReuse = lockedPool->gets > 0 ? 100.0 * (1.0 - (double)lockedPool->allocs / lockedPool->gets) : 0.0;
+
+			char reuseText[32], contendedText[32];
+			sprintf(reuseText, "%.1f/%.1f%%", lockedReuse, reuse);
+			sprintf(contendedText, "%" PRId64 "/%" PRId64, lockedPool->contended, stats.contended);
+
+			printf("%-8s %8i %12.2f %12.2f %8.2f %12s %12s\n", g_poolStormPatterns[p], threadCount,
+				locked, shared, shared / locked, reuseText, contendedText);
+
+			sharedPool->Free();
+			FreePool(lockedPool->pool);
+
+			delete sharedPool;
+			delete lockedPool;
+		}
+	}
+
+	storm->quit = true;
+
+	for (int i = 1; i < maxThreads; i++)
+		SetEvent(storm->wake[i]);
+
+	printf("\n");
+}
+
+static int RunPoolBench(GameState*, vector<char*>&)
+{
+	RunPoolStorms();
+	return 0;
+}
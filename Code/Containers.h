@@ -7,13 +7,34 @@ struct List
 {
 	int size, _capacity;
 	T* items;
+	MemoryTag tag = MEMORY_OTHER;
 
 	void Reserve(int capacity)
 	{
-		items = (T*)malloc(capacity * sizeof(T));
+		if (items != nullptr && capacity <= _capacity)
+			return;
+
+		if (items == nullptr)
+			TRACK_ALLOC(tag, capacity * sizeof(T));
+		else TRACK_RESIZE(tag, (capacity - _capacity) * sizeof(T));
+
+		items = (T*)realloc(items, capacity * sizeof(T));
 		_capacity = capacity;
 	}
 
+	void Free()
+	{
+		if (items != nullptr)
+		{
+			TRACK_FREE(tag, _capacity * sizeof(T));
+			free(items);
+		}
+
+		items = nullptr;
+		size = 0;
+		_capacity = 0;
+	}
+
 	bool Empty()
 	{
 		return size == 0;
@@ -33,11 +54,9 @@ struct List
 
 	void Add(T item)
 	{
+		// An empty list has no capacity to double.
 		if (size + 1 > _capacity)
-		{
-			_capacity *= 2;
-			items = (T*)realloc(items, _capacity * sizeof(T));
-		}
+			Reserve(Max(_capacity * 2, 16));
 
 		items[size++] = item;
 	}
@@ -54,15 +73,33 @@ struct Queue
 	T* items;
 	int read, write;
 	int size, capacity;
+	MemoryTag tag;
+	bool owned;
 
-	Queue(int capacity)
+	Queue(int capacity, MemoryTag tag)
 	{
 		assert(IsPowerOf2(capacity));
 		items = new T[capacity];
+		TRACK_ALLOC(tag, capacity * sizeof(T));
+		this->tag = tag;
+		size = 0;
+		read = 0;
+		write = 0;
+		this->capacity = capacity;
+		owned = true;
+	}
+
+	// The items are released with the arena rather than the queue.
+	Queue(Arena& arena, int capacity)
+	{
+		assert(IsPowerOf2(capacity));
+		items = ArenaArray<T>(arena, capacity);
+		tag = MEMORY_ARENAS;
 		size = 0;
 		read = 0;
 		write = 0;
 		this->capacity = capacity;
+		owned = false;
 	}
 
 	T Dequeue()
@@ -89,10 +126,16 @@ struct Queue
 
 	~Queue()
 	{
-		delete[] items;
+		if (owned)
+		{
+			TRACK_FREE(tag, capacity * sizeof(T));
+			delete[] items;
+		}
 	}
 };
 
+// Binary max-heap. The item for which operator> holds against every other item is 
+// at the top. Items are compared with operator== when searched for.
 template <typename T>
 struct PriorityQueue
 {
@@ -115,12 +158,22 @@ struct PriorityQueue
 
 	bool HasLeftChild(int i)
 	{
-		return LeftChild(i) < items.size();
+		return LeftChild(i) < (int)items.size();
 	}
 
 	bool HasRightChild(int i)
 	{
-		return RightChild(i) < items.size();
+		return RightChild(i) < (int)items.size();
+	}
+
+	bool Empty()
+	{
+		return items.empty();
+	}
+
+	int Size()
+	{
+		return (int)items.size();
 	}
 
 	T HighestPriority()
@@ -131,62 +184,86 @@ struct PriorityQueue
 
 	void UpHeap(int index)
 	{
-		if (index == 0)
-			return;
+		while (index > 0)
+		{
+			int p = Parent(index);
 
-		int p = Parent(index);
+			if (!(items[index] > items[p]))
+				break;
 
-		if (items[index] > items[p])
-		{
 			swap(items[index], items[p]);
-			Upheap(p);
+			index = p;
 		}
 	}
 
 	void DownHeap(int index)
 	{
-		if (!HasLeftChild(index))
-			return;
+		while (HasLeftChild(index))
+		{
+			int s = LeftChild(index);
 
-		int s = LeftChild(index);
+			if (HasRightChild(index))
+			{
+				int r = RightChild(index);
 
-		if (HasRightChild(index))
-		{
-			int r = RightChild(index);
+				if (items[r] > items[s]) 
+					s = r;
+			}
 
-			if (items[r] > items[s]) 
-				s = r;
-		}
+			if (!(items[s] > items[index]))
+				break;
 
-		if (items[s] > items[index])
-		{
 			swap(items[s], items[index]);
-			DownHeap(s);
+			index = s;
 		}
 	}
 
 	void Insert(T item)
 	{
 		items.push_back(item);
-		UpHeap(items.size() - 1);
+		UpHeap((int)items.size() - 1);
+	}
+
+	T RemoveHighest()
+	{
+		T item = HighestPriority();
+
+		items[0] = items.back();
+		items.pop_back();
+
+		if (!items.empty())
+			DownHeap(0);
+
+		return item;
 	}
 
 	void Remove(T item)
 	{
-		auto it = items.find(items.begin(), items.end(), item);
-		int index = distance(items.begin(), it);
+		auto it = find(items.begin(), items.end(), item);
+
+		if (it == items.end())
+			return;
 
-		if (it != items.end())
+		int index = (int)distance(items.begin(), it);
+
+		items[index] = items.back();
+		items.pop_back();
+
+		// The last item may belong above or below the position it was moved to.
+		if (index < (int)items.size())
 		{
-			swap(items[index], items[items.size() - 1]);
-			items.pop_back();
+			UpHeap(index);
 			DownHeap(index);
 		}
 	}
 
 	bool Exists(T item)
 	{
-		auto it = items.find(items.begin(), items.end(), item);
-		return it != items.end();
+		return find(items.begin(), items.end(), item) != items.end();
+	}
+
+	void Clear()
+	{
+		items.clear();
 	}
 };
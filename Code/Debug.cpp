@@ -4,28 +4,193 @@
 
 #if DEBUG_SERVICES
 
-static inline void RecordDebugEvent(DebugEventType type, int id, char* func, int line)
+// The calling thread's event log, taken the first time it records an event and
+// given back when the thread exits. Events still in the log when it's given back
+// are taken by the main thread as usual, since each event holds its thread's ID.
+struct DebugThreadLog
+{
+	DebugEventLog* log = nullptr;
+	int index = -1;
+
+	~DebugThreadLog()
+	{
+		if (index < 0)
+			return;
+
+		DebugTable& t = g_debugTable;
+
+		AcquireSRWLockExclusive(&t.logLock);
+		t.freeLogs[t.freeLogCount++] = index;
+		ReleaseSRWLockExclusive(&t.logLock);
+
+		log = nullptr;
+		index = -1;
+	}
+};
+
+static thread_local DebugThreadLog g_eventLog;
+
+// Prefers the log this thread ID last held. Returns null while every log is held
+// by a live thread, in which case the thread tries again with its next event.
+static DebugEventLog* GetEventLog()
+{
+	DebugTable& t = g_debugTable;
+	uint32_t threadID = GetCurrentThreadId();
+
+	AcquireSRWLockExclusive(&t.logLock);
+
+	int index = -1;
+
+	if (t.freeLogCount > 0)
+	{
+		int slot = t.freeLogCount - 1;
+
+		for (int i = 0; i < t.freeLogCount; i++)
+		{
+			if (t.logs[t.freeLogs[i]]->threadID == threadID)
+			{
+				slot = i;
+				break;
+			}
+		}
+
+		index = t.freeLogs[slot];
+		t.freeLogs[slot] = t.freeLogs[--t.freeLogCount];
+		t.logs[index]->threadID = threadID;
+	}
+	else
+	{
+		int count = t.logCount.load(memory_order_relaxed);
+
+		if (count < MAX_DEBUG_THREADS)
+		{
+			DebugEventLog* log = new DebugEventLog();
+			log->events = new DebugEvent[MAX_DEBUG_EVENTS];
+			log->threadID = threadID;
+			TRACK_ALLOC(MEMORY_DEBUG, sizeof(DebugEventLog) + sizeof(DebugEvent) * MAX_DEBUG_EVENTS);
+
+			index = count;
+			t.logs[index] = log;
+			t.logCount.store(count + 1, memory_order_release);
+		}
+	}
+
+	ReleaseSRWLockExclusive(&t.logLock);
+
+	if (index < 0)
+		return nullptr;
+
+	g_eventLog.log = t.logs[index];
+	g_eventLog.index = index;
+	return g_eventLog.log;
+}
+
+// Events are dropped if the main thread hasn't taken them before the log fills.
+static inline void WriteDebugEvent(DebugEventType type, int id)
+{
+	DebugEventLog* log = g_eventLog.log;
+
+	if (log == nullptr)
+	{
+		log = GetEventLog();
+		if (log == nullptr) return;
+	}
+
+	uint32_t write = log->write.load(memory_order_relaxed);
+
+	if (write - log->cachedRead == MAX_DEBUG_EVENTS)
+	{
+		log->cachedRead = log->read.load(memory_order_acquire);
+
+		if (write - log->cachedRead == MAX_DEBUG_EVENTS)
+		{
+			log->dropped++;
+			return;
+		}
+	}
+
+	DebugEvent& event = log->events[write & (MAX_DEBUG_EVENTS - 1)];
+	event.cycles = __rdtsc();
+	event.threadID = log->threadID;
+	event.recordID = (uint16_t)id;
+	event.type = type;
+
+	log->write.store(write + 1, memory_order_release);
+}
+
+// Records are shared between threads, so they're only written the first time
+// they're used, under the lock. Async records are already filled in by GetAsyncRecord.
+static void FillDebugRecord(int id, char* func, int line)
 {
 	DebugTable& t = g_debugTable;
-	assert(t.eventIndex + 1 < MAX_DEBUG_EVENTS);
-    DebugEvent* event = t.events + t.eventIndex++;
-    event->cycles = __rdtsc();
-    event->threadID = (uint16_t)GetCurrentThreadId();
-    event->recordID = (uint16_t)id;
-    event->type = type;
+	DebugRecord& record = t.records[id];
+
+	AcquireSRWLockExclusive(&t.logLock);
+
+	if (record.func == nullptr)
+	{
+		record.func = func;
+		record.line = line;
+	}
+
+	t.recordUsed[id].store(true, memory_order_release);
+	ReleaseSRWLockExclusive(&t.logLock);
+}
+
+static inline void RecordDebugEvent(DebugEventType type, int id, char* func, int line)
+{
+	if (!g_debugTable.recordUsed[id].load(memory_order_acquire))
+		FillDebugRecord(id, func, line);
 
-    DebugRecord& record = t.records[id];
-    record.func = func;
-    record.line = line;
+	WriteDebugEvent(type, id);
 }
 
 static inline void RecordFrameMarker()
+{
+	WriteDebugEvent(DEBUG_EVENT_FRAME_MARKER, 0);
+}
+
+// Returns the record for the async job with the given name, giving it one if it
+// doesn't have one yet. Records are only added under the lock, and the count is 
+// increased after the record is written so that readers never see a partial record.
+static int FindAsyncRecord(char* name, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(g_debugTable.records[FIRST_ASYNC_RECORD + i].func, name) == 0)
+			return FIRST_ASYNC_RECORD + i;
+	}
+
+	return -1;
+}
+
+static int GetAsyncRecord(char* name)
 {
 	DebugTable& t = g_debugTable;
-	assert(t.eventIndex + 1 < MAX_DEBUG_EVENTS);
-    DebugEvent* event = t.events + t.eventIndex++;
-    event->cycles = __rdtsc();
-    event->type = DEBUG_EVENT_FRAME_MARKER;
+
+	int id = FindAsyncRecord(name, InterlockedCompareExchange(&t.asyncRecordCount, 0, 0));
+
+	if (id >= 0) return id;
+
+	AcquireSRWLockExclusive(&t.logLock);
+
+	id = FindAsyncRecord(name, t.asyncRecordCount);
+
+	if (id < 0)
+	{
+		// Jobs past the limit share the last record.
+		if (t.asyncRecordCount == MAX_ASYNC_RECORDS)
+			id = MAX_DEBUG_RECORDS - 1;
+		else
+		{
+			id = FIRST_ASYNC_RECORD + t.asyncRecordCount;
+			t.records[id] = { name, 0 };
+			InterlockedIncrement(&t.asyncRecordCount);
+		}
+	}
+
+	ReleaseSRWLockExclusive(&t.logLock);
+	return id;
 }
 
 TimedFunction::TimedFunction(int id, char* func, int line)
@@ -39,7 +204,7 @@ TimedFunction::~TimedFunction()
 	RecordDebugEvent(DEBUG_EVENT_END_BLOCK, info.id, info.func, info.line);
 }
 
-static inline DebugThread* GetDebugThread(int threadID)
+static inline DebugThread* GetDebugThread(uint32_t threadID)
 {
 	DebugTable& t = g_debugTable;
 
@@ -82,11 +247,11 @@ static void CollateDebugRecords(int inUseIndex)
 		if (index == inUseIndex)
 			break;
 
-		int eventCount = t.eventCounts[index];
+		vector<DebugEvent>& events = t.eventArrays[index];
 
-		for (int e = 0; e < eventCount; e++)
+		for (int e = 0; e < events.size(); e++)
 		{
-			DebugEvent& event = t.eventStorage[index][e];
+			DebugEvent& event = events[e];
 
 			if (event.type == DEBUG_EVENT_FRAME_MARKER)
 			{
@@ -169,6 +334,366 @@ static void CollateDebugRecords(int inUseIndex)
 	}
 }
 
+// Moves the events each thread recorded since the last frame into the frame's 
+// array, sorted by time so that the frame marker comes before the frame's events.
+static void TakeDebugEvents(vector<DebugEvent>& events)
+{
+	DebugTable& t = g_debugTable;
+
+	events.clear();
+
+	int logCount = t.logCount.load(memory_order_acquire);
+
+	for (int i = 0; i < logCount; i++)
+	{
+		DebugEventLog* log = t.logs[i];
+
+		uint32_t read = log->read.load(memory_order_relaxed);
+		uint32_t write = log->write.load(memory_order_acquire);
+
+		for (uint32_t e = read; e != write; e++)
+		{
+			events.push_back(log->events[e & (MAX_DEBUG_EVENTS - 1)]);
+		}
+
+		log->read.store(write, memory_order_release);
+	}
+
+	sort(events.begin(), events.end(), [](const DebugEvent& a, const DebugEvent& b) { return a.cycles < b.cycles; });
+}
+
+// Finds the length of a cycle from the time elapsed since startup. The longer the 
+// game has been running, the more accurate this is.
+static void CalibrateCycles()
+{
+	DebugTable& t = g_debugTable;
+
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+
+	// Wait long enough for the result to be meaningful if the game just started.
+	do
+	{
+		QueryPerformanceCounter(&counter);
+	}
+	while (counter.QuadPart - t.startCounter.QuadPart < frequency.QuadPart / 20);
+
+	uint64_t cycles = __rdtsc();
+
+	double ns = (double)(counter.QuadPart - t.startCounter.QuadPart) * 1000000000.0 / (double)frequency.QuadPart;
+	t.nsPerCycle = ns / (double)(cycles - t.startCycles);
+}
+
+static void BeginTrace(int frames)
+{
+	DebugTable& t = g_debugTable;
+
+	t.traceEvents.clear();
+	t.traceFramesLeft = frames;
+}
+
+// Writes the captured events in the Chrome trace event format, with times in 
+// microseconds from the first event.
+static void WriteTrace()
+{
+	DebugTable& t = g_debugTable;
+	CalibrateCycles();
+
+	char path[MAX_PATH];
+	PathToExe("Trace.json", path, MAX_PATH);
+
+	FILE* file = fopen(path, "w");
+
+	if (file == nullptr)
+	{
+		Print("Failed to open %s for writing.\n", path);
+		return;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	// Logs are reused by new threads, so the threads are named from the events.
+	vector<uint32_t> threadIDs;
+
+	for (DebugEvent& event : t.traceEvents)
+	{
+		if (find(threadIDs.begin(), threadIDs.end(), event.threadID) == threadIDs.end())
+			threadIDs.push_back(event.threadID);
+	}
+
+	for (uint32_t threadID : threadIDs)
+	{
+		char* name = threadID == t.mainThreadID ? "Main" : "Worker";
+
+		fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n", 
+			threadID, name);
+	}
+
+	uint64_t base = t.traceEvents.size() > 0 ? t.traceEvents[0].cycles : 0;
+
+	for (int i = 0; i < t.traceEvents.size(); i++)
+	{
+		DebugEvent& event = t.traceEvents[i];
+		double us = (double)(event.cycles - base) * t.nsPerCycle / 1000.0;
+
+		char* sep = i + 1 < t.traceEvents.size() ? "," : "";
+
+		if (event.type == DEBUG_EVENT_FRAME_MARKER)
+		{
+			fprintf(file, "{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Frame\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}%s\n", 
+				event.threadID, us, sep);
+		}
+		else
+		{
+			char* phase = event.type == DEBUG_EVENT_BEGIN_BLOCK ? "B" : "E";
+			char* func = t.records[event.recordID].func;
+
+			fprintf(file, "{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}%s\n", 
+				phase, func == nullptr ? "Unknown" : func, event.threadID, us, sep);
+		}
+	}
+
+	fprintf(file, "]}\n");
+	fclose(file);
+
+	uint32_t dropped = 0;
+	int logCount = t.logCount.load(memory_order_acquire);
+
+	for (int i = 0; i < logCount; i++)
+		dropped += t.logs[i]->dropped;
+
+	Print("Wrote %i events to %s (%u dropped, %.4f ns per cycle).\n", (int)t.traceEvents.size(), path, dropped, t.nsPerCycle);
+	t.traceEvents = vector<DebugEvent>();
+}
+
+static AggregateThread& GetAggregateThread(uint32_t threadID)
+{
+	auto& threads = g_debugTable.aggregateThreads;
+
+	for (int i = 0; i < threads.size(); i++)
+	{
+		if (threads[i].ID == threadID)
+			return threads[i];
+	}
+
+	threads.emplace_back();
+	threads.back().ID = threadID;
+	return threads.back();
+}
+
+// Adds the frame's events to the rolling statistics. Blocks are counted in the frame 
+// they end in. A block's self time excludes the blocks nested inside it.
+static void AggregateDebugEvents(vector<DebugEvent>& events)
+{
+	DebugTable& t = g_debugTable;
+	int frame = t.sampleFrame;
+
+	for (int i = 0; i < MAX_DEBUG_RECORDS; i++)
+	{
+		RecordSamples& samples = t.samples[i];
+		samples.inclusive[frame] = 0.0f;
+		samples.self[frame] = 0.0f;
+		samples.calls[frame] = 0;
+	}
+
+	for (int e = 0; e < events.size(); e++)
+	{
+		DebugEvent& event = events[e];
+
+		if (event.type == DEBUG_EVENT_FRAME_MARKER)
+			continue;
+
+		vector<AggregateBlock>& open = GetAggregateThread(event.threadID).open;
+
+		if (event.type == DEBUG_EVENT_BEGIN_BLOCK)
+		{
+			open.push_back({ event.recordID, event.cycles, 0 });
+			continue;
+		}
+
+		// An end without a matching begin means events were dropped.
+		if (open.empty() || open.back().recordID != event.recordID)
+		{
+			open.clear();
+			continue;
+		}
+
+		AggregateBlock block = open.back();
+		open.pop_back();
+
+		uint64_t inclusive = event.cycles - block.start;
+
+		RecordSamples& samples = t.samples[event.recordID];
+		samples.inclusive[frame] += (float)inclusive;
+		samples.self[frame] += (float)(inclusive - Min(block.child, inclusive));
+		samples.calls[frame]++;
+
+		if (!open.empty())
+			open.back().child += inclusive;
+	}
+
+	t.sampleFrame = (t.sampleFrame + 1) % PROFILE_STAT_FRAMES;
+	t.sampleCount = Min(t.sampleCount + 1, PROFILE_STAT_FRAMES);
+}
+
+static void ResetProfileStats()
+{
+	DebugTable& t = g_debugTable;
+
+	memset(t.samples, 0, sizeof(t.samples));
+	t.sampleFrame = 0;
+	t.sampleCount = 0;
+}
+
+static BaselineEntry* FindBaseline(char* name)
+{
+	auto& baseline = g_debugTable.baseline;
+
+	for (int i = 0; i < baseline.size(); i++)
+	{
+		if (strcmp(baseline[i].name, name) == 0)
+			return &baseline[i];
+	}
+
+	return nullptr;
+}
+
+// Computes the statistics for every record that ran within the window, sorted by 
+// mean time with the slowest first.
+static void ComputeProfileStats(vector<RecordStats>& stats)
+{
+	DebugTable& t = g_debugTable;
+
+	if (t.nsPerCycle == 0.0)
+		CalibrateCycles();
+
+	float msPerCycle = (float)(t.nsPerCycle / 1000000.0);
+
+	stats.clear();
+
+	float times[PROFILE_STAT_FRAMES];
+
+	for (int r = 0; r < MAX_DEBUG_RECORDS; r++)
+	{
+		RecordSamples& samples = t.samples[r];
+
+		RecordStats record = {};
+		record.recordID = r;
+
+		int calls = 0;
+		float total = 0.0f, self = 0.0f;
+
+		for (int f = 0; f < t.sampleCount; f++)
+		{
+			if (samples.calls[f] == 0)
+				continue;
+
+			float time = samples.inclusive[f] * msPerCycle;
+			times[record.frames++] = time;
+
+			calls += samples.calls[f];
+			total += time;
+			self += samples.self[f] * msPerCycle;
+		}
+
+		if (record.frames == 0 || t.records[r].func == nullptr)
+			continue;
+
+		sort(times, times + record.frames);
+
+		int p99 = (int)ceilf(record.frames * 0.99f) - 1;
+
+		record.calls = (float)calls / record.frames;
+		record.min = times[0];
+		record.max = times[record.frames - 1];
+		record.p99 = times[p99];
+		record.mean = total / record.frames;
+		record.self = self / record.frames;
+		record.baseline = -1.0f;
+
+		BaselineEntry* entry = FindBaseline(t.records[r].func);
+
+		if (entry != nullptr)
+		{
+			record.baseline = entry->mean;
+
+			float slower = record.mean - entry->mean;
+			record.regressed = slower > entry->mean * PROFILE_REGRESSION && slower > PROFILE_REGRESSION_MIN_MS;
+		}
+
+		stats.push_back(record);
+	}
+
+	sort(stats.begin(), stats.end(), [](const RecordStats& a, const RecordStats& b) { return a.mean > b.mean; });
+}
+
+static bool ExportProfileStats(char* path)
+{
+	vector<RecordStats> stats;
+	ComputeProfileStats(stats);
+
+	FILE* file = fopen(path, "w");
+
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "name,line,frames,calls per frame,min,mean,p99,max,self,baseline,regressed\n");
+
+	for (int i = 0; i < stats.size(); i++)
+	{
+		RecordStats& s = stats[i];
+		DebugRecord& record = g_debugTable.records[s.recordID];
+
+		fprintf(file, "%s,%i,%i,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%i\n", record.func, record.line, s.frames, s.calls, 
+			s.min, s.mean, s.p99, s.max, s.self, s.baseline, s.regressed);
+	}
+
+	fclose(file);
+	return true;
+}
+
+static void LoadProfileBaseline(char* path)
+{
+	auto& baseline = g_debugTable.baseline;
+	baseline.clear();
+
+	FILE* file = fopen(path, "r");
+
+	if (file == nullptr)
+		return;
+
+	BaselineEntry entry;
+
+	while (fscanf(file, "%63s %f %f", entry.name, &entry.mean, &entry.p99) == 3)
+		baseline.push_back(entry);
+
+	fclose(file);
+}
+
+// Writes each record's name, mean and p99 times, one record per line, and makes them 
+// the baseline to compare against.
+static bool SaveProfileBaseline(char* path)
+{
+	vector<RecordStats> stats;
+	ComputeProfileStats(stats);
+
+	FILE* file = fopen(path, "w");
+
+	if (file == nullptr)
+		return false;
+
+	for (int i = 0; i < stats.size(); i++)
+	{
+		RecordStats& s = stats[i];
+		fprintf(file, "%s %.4f %.4f\n", g_debugTable.records[s.recordID].func, s.mean, s.p99);
+	}
+
+	fclose(file);
+
+	LoadProfileBaseline(path);
+	return true;
+}
+
 static void CreateDebugMesh()
 {
 	vector<u8vec3> data;
@@ -307,12 +832,27 @@ static void DrawChunkOutline(Chunk* chunk)
 
 static void DebugInit(GameState* state, GLFWwindow* window)
 {
+	DebugTable& t = g_debugTable;
+
+	InitializeSRWLock(&t.logLock);
+	t.mainThreadID = GetCurrentThreadId();
+	t.startCycles = __rdtsc();
+	QueryPerformanceCounter(&t.startCounter);
+
+	char path[MAX_PATH];
+	LoadProfileBaseline(PathToExe("Baseline.txt", path, MAX_PATH));
+
+	#if !HEADLESS
 	CreateDebugMesh();
 	CreateDebugShader();
+	#endif
 
 	RegisterCommand(state, "outlines", ChunkOutlinesCommand, nullptr);
 	RegisterCommand(state, "profiler", ProfilerCommand, window);
 	RegisterCommand(state, "p", FastProfilerToggleCommand, window);
+	RegisterCommand(state, "trace", TraceCommand, nullptr);
+	RegisterCommand(state, "profile", ProfileCommand, nullptr);
+	RegisterCommand(state, "memory", MemoryCommand, nullptr);
 }
 
 static void DebugDraw(Renderer& rend, Camera* cam)
@@ -330,18 +870,105 @@ static void DebugDraw(Renderer& rend, Camera* cam)
 		DrawDebugMesh(mesh, outline.pos, outline.scale, outline.color);
 }
 
+static inline void RecordEditShown(double time)
+{
+	DebugTable& t = g_debugTable;
+
+	if (time > 0.0 && (t.editShownTime == 0.0 || time < t.editShownTime))
+		t.editShownTime = time;
+}
+
+// Logs each tag that went over its budget since the last check. A tag is logged 
+// again if it drops back under its budget and then exceeds it again.
+static void CheckMemoryBudgets()
+{
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		int64_t budget = g_memory.budgets[i];
+		int64_t bytes = g_memory.tags[i].bytes;
+
+		bool over = budget > 0 && bytes > budget;
+
+		if (over && !g_memory.overBudget[i])
+		{
+			Print("Memory budget exceeded for %s: %.1f MB of %.1f MB.\n", g_memoryTagNames[i], 
+				bytes / (1024.0 * 1024.0), budget / (1024.0 * 1024.0));
+		}
+
+		g_memory.overBudget[i] = over;
+	}
+}
+
+static int FindMemoryTag(char* name)
+{
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		if (strcmp(g_memoryTagNames[i], name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+static void ResetMemoryPeaks()
+{
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+		g_memory.tags[i].peak = g_memory.tags[i].bytes;
+}
+
+// Writes each tag's current and peak megabytes, allocation count and budget. Returns 
+// the total tracked bytes, or -1 if the file couldn't be opened.
+static int64_t DumpMemoryStats(char* path)
+{
+	FILE* file = fopen(path, "w");
+
+	if (file == nullptr)
+		return -1;
+
+	fprintf(file, "tag,megabytes,peak megabytes,allocations,budget megabytes\n");
+
+	int64_t total = 0;
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		MemoryTagStats& stats = g_memory.tags[i];
+		total += stats.bytes;
+
+		fprintf(file, "%s,%.2f,%.2f,%d,%.1f\n", g_memoryTagNames[i], stats.bytes / (1024.0 * 1024.0), 
+			stats.peak / (1024.0 * 1024.0), stats.count, g_memory.budgets[i] / (1024.0 * 1024.0));
+	}
+
+	fclose(file);
+	return total;
+}
+
 static void DebugEndFrame(GameState* state)
 {	
 	DebugTable& t = g_debugTable;
 
-	t.eventCounts[t.eventArrayIndex] = t.eventIndex;
+	// The frame has been presented, so any edits filled this frame are now visible.
+	if (t.editShownTime > 0.0)
+	{
+		t.editLatency = (float)((glfwGetTime() - t.editShownTime) * 1000.0);
+		t.maxEditLatency = Max(t.maxEditLatency, t.editLatency);
+		t.editShownTime = 0.0;
+	}
 
-	// We will begin writing to a new event array here, and then we'll=
-	// process the arrays we're not currently writing to.
+	// Take the events recorded during the frame into the next array, and then 
+	// process the arrays from the frames before it.
 	t.eventArrayIndex = (t.eventArrayIndex + 1) % MAX_DEBUG_EVENT_ARRAYS;
-	t.events = t.eventStorage[t.eventArrayIndex];
 
-	t.eventIndex = 0;
+	vector<DebugEvent>& events = t.eventArrays[t.eventArrayIndex];
+	TakeDebugEvents(events);
+	AggregateDebugEvents(events);
+
+	if (t.traceFramesLeft > 0)
+	{
+		t.traceEvents.insert(t.traceEvents.end(), events.begin(), events.end());
+
+		if (--t.traceFramesLeft == 0)
+			WriteTrace();
+	}
 
 	if (state->debugDisplay && t.profilerState >= PROFILER_RECORDING)
 	{
@@ -351,7 +978,171 @@ static void DebugEndFrame(GameState* state)
 			t.profilerState = PROFILER_STOPPED;
 	}
 
+	CheckMemoryBudgets();
+
 	g_debugTable.outlines.clear();
 }
 
 #endif
+
+#if PIPELINE_STATS
+
+static char* g_pipelineStageNames[PIPELINE_STAGE_COUNT] =
+{
+	"Load Wait", "Load", "Preprocess Wait", "Preprocess", "Group Total", "Build", "Fill Wait"
+};
+
+static inline int LatencyBucket(float ms)
+{
+	if (ms < 0.05f) return 0;
+
+	int bucket = (int)(log2f(ms / 0.05f) * 4.0f) + 1;
+	return Min(bucket, LATENCY_BUCKETS - 1);
+}
+
+// The upper bound of the bucket, in milliseconds.
+static inline float LatencyBucketMax(int bucket)
+{
+	return 0.05f * exp2f(bucket * 0.25f);
+}
+
+// Returns an upper bound for the given fraction of latencies, accurate to the bucket size.
+static float LatencyPercentile(LatencyHistogram& hist, float fraction)
+{
+	if (hist.total == 0) return 0.0f;
+
+	uint32_t target = (uint32_t)ceilf(hist.total * fraction);
+	uint32_t count = 0;
+
+	for (int i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		count += hist.counts[i];
+
+		if (count >= target)
+			return Min(LatencyBucketMax(i), hist.max);
+	}
+
+	return hist.max;
+}
+
+// Records the time since the stage began, if it was tracked. The time is restarted 
+// if the next stage begins immediately, otherwise it's cleared.
+static void RecordPipelineStage(PipelineStage stage, double& time, bool restart)
+{
+	double now = glfwGetTime();
+
+	if (time > 0.0)
+	{
+		float ms = (float)((now - time) * 1000.0);
+		LatencyHistogram& hist = g_pipelineStats.stages[stage];
+
+		hist.counts[LatencyBucket(ms)]++;
+		hist.total++;
+		hist.max = Max(hist.max, ms);
+	}
+
+	time = restart ? now : 0.0;
+}
+
+static void ResetPipelineStats()
+{
+	PipelineStats& stats = g_pipelineStats;
+
+	memset(stats.stages, 0, sizeof(stats.stages));
+	stats.maxAsyncQueued = 0;
+	stats.maxDestroyQueued = 0;
+}
+
+static void WritePipelineLogHeader(FILE* file)
+{
+	fprintf(file, "time");
+
+	for (int i = 0; i < PIPELINE_STAGE_COUNT; i++)
+	{
+		char* name = g_pipelineStageNames[i];
+		fprintf(file, ",%s count,%s p50,%s p95,%s p99,%s max", name, name, name, name, name);
+	}
+
+	fprintf(file, ",async queued,max async queued,destroy queued,max destroy queued,groups to load,loads in flight,"
+		"groups to check,chunks to fill,work count\n");
+}
+
+static void WritePipelineLog(FILE* file, double time)
+{
+	PipelineStats& stats = g_pipelineStats;
+	fprintf(file, "%.1f", time);
+
+	for (int i = 0; i < PIPELINE_STAGE_COUNT; i++)
+	{
+		LatencyHistogram& hist = stats.stages[i];
+
+		fprintf(file, ",%u,%.2f,%.2f,%.2f,%.2f", hist.total, LatencyPercentile(hist, 0.5f), LatencyPercentile(hist, 0.95f), 
+			LatencyPercentile(hist, 0.99f), hist.max);
+	}
+
+	fprintf(file, ",%i,%i,%i,%i,%i,%i,%i,%i,%i\n", stats.asyncQueued, stats.maxAsyncQueued, stats.destroyQueued, 
+		stats.maxDestroyQueued, stats.groupsToLoad, stats.loadsInFlight, stats.groupsToCheck, stats.chunksToFill, stats.workCount);
+
+	fflush(file);
+}
+
+// Returns false if the log couldn't be opened.
+static bool TogglePipelineLog()
+{
+	PipelineStats& stats = g_pipelineStats;
+
+	if (stats.log != nullptr)
+	{
+		fclose(stats.log);
+		stats.log = nullptr;
+		return true;
+	}
+
+	char path[MAX_PATH];
+	PathToExe("Pipeline.csv", path, MAX_PATH);
+
+	stats.log = fopen(path, "w");
+
+	if (stats.log == nullptr)
+		return false;
+
+	WritePipelineLogHeader(stats.log);
+	stats.nextLogTime = glfwGetTime() + PIPELINE_LOG_INTERVAL;
+
+	return true;
+}
+
+// Samples the queue depths. Async queue indices are written by other threads, but an 
+// approximate depth is enough here.
+static void UpdatePipelineStats(GameState* state, World* world)
+{
+	PipelineStats& stats = g_pipelineStats;
+
+	stats.asyncQueued = 0;
+
+	for (int i = 0; i < ASYNC_PRIORITY_COUNT; i++)
+	{
+		AsyncWorkQueue& queue = state->workQueues[i];
+		stats.asyncQueued += (queue.write - queue.read) & (queue.size - 1);
+	}
+
+	stats.destroyQueued = (int)world->destroyQueue.size();
+	stats.groupsToLoad = (int)world->groupsToLoad.size();
+	stats.loadsInFlight = world->loadsInFlight;
+	stats.groupsToCheck = (int)world->groupsToCheck.size();
+	stats.chunksToFill = (int)world->chunksToFill.size();
+	stats.workCount = world->workCount;
+
+	stats.maxAsyncQueued = Max(stats.maxAsyncQueued, stats.asyncQueued);
+	stats.maxDestroyQueued = Max(stats.maxDestroyQueued, stats.destroyQueued);
+
+	double now = glfwGetTime();
+
+	if (stats.log != nullptr && now >= stats.nextLogTime)
+	{
+		WritePipelineLog(stats.log, now);
+		stats.nextLogTime = now + PIPELINE_LOG_INTERVAL;
+	}
+}
+
+#endif
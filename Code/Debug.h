@@ -4,9 +4,25 @@
 
 #if DEBUG_SERVICES
 
+// Size of each thread's event log. Must be a power of 2.
 #define MAX_DEBUG_EVENTS 65536
 #define MAX_DEBUG_EVENT_ARRAYS 32
 #define MAX_DEBUG_RECORDS 256
+#define MAX_DEBUG_THREADS 64
+
+// Records at the end of the table are given to async jobs by name.
+#define MAX_ASYNC_RECORDS 32
+#define FIRST_ASYNC_RECORD (MAX_DEBUG_RECORDS - MAX_ASYNC_RECORDS)
+
+#define DEFAULT_TRACE_FRAMES 300
+
+// Number of frames kept for each record's rolling statistics.
+#define PROFILE_STAT_FRAMES 120
+
+// A record is flagged as a regression if its mean time exceeds the baseline by this 
+// fraction and by at least the given number of milliseconds.
+#define PROFILE_REGRESSION 0.2f
+#define PROFILE_REGRESSION_MIN_MS 0.05f
 
 enum DebugEventType : uint8_t
 {
@@ -23,10 +39,28 @@ struct DebugRecord
 
 struct DebugEvent
 {
-    DebugEventType type;
     uint64_t cycles;
-    uint16_t threadID;
+    uint32_t threadID;
     uint16_t recordID;
+    DebugEventType type;
+};
+
+// Events recorded by a single thread. Only the owning thread writes events and 
+// advances write, and only the main thread advances read as it takes events at 
+// the end of the frame. The two indices are kept on separate cache lines so 
+// recording an event never touches memory the main thread writes to.
+struct DebugEventLog
+{
+    DebugEvent* events;
+    uint32_t threadID;
+
+    alignas(64) atomic<uint32_t> write;
+
+    // The owner's last known value of read, refreshed only when the log looks full.
+    uint32_t cachedRead;
+    uint32_t dropped;
+
+    alignas(64) atomic<uint32_t> read;
 };
 
 // Represents a timespan being recorded during the frame.
@@ -53,10 +87,54 @@ struct OpeningEvent
 
 struct DebugThread
 {
-    int ID, laneIndex;
+    uint32_t ID;
+    int laneIndex;
     stack<OpeningEvent> openEvents;
 };
 
+// A record's inclusive and self time in cycles and its call count for each of the 
+// last PROFILE_STAT_FRAMES frames.
+struct RecordSamples
+{
+    float inclusive[PROFILE_STAT_FRAMES];
+    float self[PROFILE_STAT_FRAMES];
+    uint16_t calls[PROFILE_STAT_FRAMES];
+};
+
+// Statistics over the frames in which the record ran, in milliseconds.
+struct RecordStats
+{
+    int recordID;
+    int frames;
+    float calls;
+    float min, mean, p99, max;
+    float self;
+
+    // The mean from the baseline, or a negative value if the record isn't in it.
+    float baseline;
+    bool regressed;
+};
+
+struct BaselineEntry
+{
+    char name[64];
+    float mean, p99;
+};
+
+// A block that has begun but not ended on a thread, used to find self time. Child 
+// holds the inclusive time of the blocks that ran inside it.
+struct AggregateBlock
+{
+    uint16_t recordID;
+    uint64_t start, child;
+};
+
+struct AggregateThread
+{
+    uint32_t ID;
+    vector<AggregateBlock> open;
+};
+
 struct DebugMesh
 {
     GLuint va, vertices;
@@ -88,21 +166,33 @@ struct DebugTable
 {
     // As the code runs, it can report debug events. These events store 
     // the current "CPU time", the thread they're on, and a given type.
-    // This array is a running log of these events. On each frame we 
-    // start writing into a new array, wrapping which array we write to
-    // around as in a circular buffer.
-    DebugEvent eventStorage[MAX_DEBUG_EVENT_ARRAYS][MAX_DEBUG_EVENTS];
+    // Each thread writes events into its own log. At the end of each frame
+    // the main thread moves the events from every log into the frame's array, 
+    // wrapping which array is used around as in a circular buffer.
+    vector<DebugEvent> eventArrays[MAX_DEBUG_EVENT_ARRAYS];
 
-    // Stores the number of events we have in each of the event arrays.
-    int eventCounts[MAX_DEBUG_EVENT_ARRAYS];
+    // The index of the array holding the events of the frame that just ended.
+    int eventArrayIndex;
 
-    // Tracks which array we're currently writing debug events into. 
-    // The event index is the location in that array we are writing to.
-    DebugEvent* events = eventStorage[0];
-    atomic<int> eventIndex;
+    DebugEventLog* logs[MAX_DEBUG_THREADS];
+    atomic<int> logCount;
+    SRWLOCK logLock;
 
-    // The index of the current event array we're writing into.
-    int eventArrayIndex;
+    // Logs given back by threads that have exited, reused by new threads.
+    int freeLogs[MAX_DEBUG_THREADS];
+    int freeLogCount;
+
+    uint32_t mainThreadID;
+
+    // Timestamps taken at startup, used to find the length of a cycle.
+    uint64_t startCycles;
+    LARGE_INTEGER startCounter;
+    double nsPerCycle;
+
+    // Events are kept while a trace is being captured and then written as a 
+    // Chrome trace file, which can be opened in chrome://tracing or Perfetto.
+    vector<DebugEvent> traceEvents;
+    int traceFramesLeft;
 
     int chartLaneCount;
     float chartScale;
@@ -112,9 +202,21 @@ struct DebugTable
 
     DebugRecord* scopeToRecord;
     DebugRecord records[MAX_DEBUG_RECORDS];
+    volatile LONG asyncRecordCount;
+
+    // Set once a record has been filled in, under the log lock.
+    atomic<bool> recordUsed[MAX_DEBUG_RECORDS];
 
     ProfilerState profilerState;
 
+    // Rolling per-record statistics, written into the sample slot for each frame in turn.
+    RecordSamples samples[MAX_DEBUG_RECORDS];
+    int sampleFrame, sampleCount;
+    vector<AggregateThread> aggregateThreads;
+
+    // Saved statistics that the current ones are compared against to find regressions.
+    vector<BaselineEntry> baseline;
+
     bool showOutlines;
 
     DebugShader shader;
@@ -123,6 +225,11 @@ struct DebugTable
     vector<DebugOutline> outlines;
 
     int visibleMeshes;
+
+    // Earliest edit whose mesh was filled during this frame, and the time 
+    // in milliseconds from the edit until the frame it appeared in was presented.
+    double editShownTime;
+    float editLatency, maxEditLatency;
 };
 
 static DebugTable g_debugTable;
@@ -148,6 +255,13 @@ struct TimedFunction
 
 #define END_BLOCK(ID) RecordDebugEvent(DEBUG_EVENT_END_BLOCK, info##ID.id, info##ID.func, info##ID.line)
 
+// Times an async job. Jobs are named after the function that was queued.
+#define BEGIN_ASYNC_BLOCK(name) \
+    int asyncRecordID = GetAsyncRecord(name); \
+    RecordDebugEvent(DEBUG_EVENT_BEGIN_BLOCK, asyncRecordID, name, 0)
+
+#define END_ASYNC_BLOCK(name) RecordDebugEvent(DEBUG_EVENT_END_BLOCK, asyncRecordID, name, 0)
+
 #define FRAME_MARKER RecordFrameMarker()
 
 #define _TIMED_FUNCTION(ID, func, line) TimedFunction timedFunction##ID(ID, func, line)
@@ -158,6 +272,8 @@ struct TimedFunction
 #define DEBUG_END_FRAME(state) DebugEndFrame(state)
 #define DRAW_CHUNK_OUTLINE(chunk) DrawChunkOutline(chunk)
 
+#define RECORD_EDIT_SHOWN(time) RecordEditShown(time)
+
 #define TRACK_MESH g_debugTable.visibleMeshes++
 #define RESET_TRACKED_MESHES g_debugTable.visibleMeshes = 0
 
@@ -165,6 +281,8 @@ struct TimedFunction
 
 #define BEGIN_BLOCK(ID)
 #define END_BLOCK(ID)
+#define BEGIN_ASYNC_BLOCK(name)
+#define END_ASYNC_BLOCK(name)
 #define FRAME_MARKER
 #define TIMED_FUNCTION
 
@@ -172,8 +290,68 @@ struct TimedFunction
 #define DEBUG_DRAW(renderer, camera)
 #define DEBUG_END_FRAME(state)
 #define DRAW_CHUNK_OUTLINE(chunk)
+#define RECORD_EDIT_SHOWN(time)
 
 #define TRACK_MESH
 #define RESET_TRACKED_MESHES
 
 #endif
+
+#if PIPELINE_STATS
+
+// Latency buckets grow by a factor of 2^(1/4) from 0.05 ms, up to about 40 seconds.
+#define LATENCY_BUCKETS 80
+#define PIPELINE_LOG_INTERVAL 5.0
+
+// Stages a group or chunk passes through between being created and being shown.
+// Wait stages are spent on the main thread waiting for the job to be queued, and
+// job stages last from queuing the job until its callback runs.
+enum PipelineStage
+{
+    PIPELINE_LOAD_WAIT,
+    PIPELINE_LOAD,
+    PIPELINE_PREPROCESS_WAIT,
+    PIPELINE_PREPROCESS,
+    PIPELINE_GROUP_TOTAL,
+    PIPELINE_BUILD,
+    PIPELINE_FILL_WAIT,
+    PIPELINE_STAGE_COUNT
+};
+
+struct LatencyHistogram
+{
+    uint32_t counts[LATENCY_BUCKETS];
+    uint32_t total;
+    float max;
+};
+
+struct PipelineStats
+{
+    LatencyHistogram stages[PIPELINE_STAGE_COUNT];
+
+    // Queue depths as of the last world update, and the highest since the last reset.
+    int asyncQueued, destroyQueued, groupsToLoad, loadsInFlight, groupsToCheck, chunksToFill, workCount;
+    int maxAsyncQueued, maxDestroyQueued;
+
+    // If set, the stats are written to Pipeline.csv every PIPELINE_LOG_INTERVAL seconds.
+    FILE* log;
+    double nextLogTime;
+};
+
+static PipelineStats g_pipelineStats;
+
+// Marks the time a group or chunk entered a pipeline stage. Ending a stage records 
+// its latency, and the time is reset or restarted for the next stage.
+#define PIPELINE_BEGIN(time) time = glfwGetTime()
+#define PIPELINE_STAGE(stage, time) RecordPipelineStage(stage, time, true)
+#define PIPELINE_END(stage, time) RecordPipelineStage(stage, time, false)
+#define UPDATE_PIPELINE_STATS(state, world) UpdatePipelineStats(state, world)
+
+#else
+
+#define PIPELINE_BEGIN(time)
+#define PIPELINE_STAGE(stage, time)
+#define PIPELINE_END(stage, time)
+#define UPDATE_PIPELINE_STATS(state, world)
+
+#endif
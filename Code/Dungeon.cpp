@@ -28,4 +28,6 @@ static void GenerateDungeon(World*, ChunkGroup* group)
 	MakeRect(chunk, 0, 0, 0, 0, wallHeight, lim, BLOCK_STONE);
 	MakeRect(chunk, 0, 0, lim, lim, wallHeight, lim, BLOCK_STONE);
 	MakeRect(chunk, lim, 0, 0, lim, wallHeight, lim, BLOCK_STONE);
+
+	WORLDGEN_STAGE(WORLDGEN_FILL);
 }
@@ -40,6 +40,10 @@ static char* PathToExe(char* fileName, char* buffer, int size)
     GetModuleFileName(0, buffer, size);
 
     char* pos = strrchr(buffer, '\\');
+
+    if (pos == nullptr)
+        pos = strrchr(buffer, '/');
+
     *(pos + 1) = '\0';
 
     strcat(buffer, fileName);
@@ -72,7 +76,7 @@ static inline void ReadBinary(char* path, char* ptr)
 static void DeleteDirectory(char* path)
 {
     char searchPath[MAX_PATH];
-    sprintf(searchPath, "%s\\*.txt", path);
+    sprintf(searchPath, "%s/*.txt", path);
 
     WIN32_FIND_DATA findData;
     HANDLE handle = FindFirstFile(searchPath, &findData);
@@ -80,7 +84,7 @@ static void DeleteDirectory(char* path)
     while (handle != INVALID_HANDLE_VALUE)
     {
         char filePath[MAX_PATH];
-        sprintf(filePath, "%s\\%s", path, findData.cFileName);
+        sprintf(filePath, "%s/%s", path, findData.cFileName);
 
         DeleteFile(filePath);
 
@@ -93,6 +97,8 @@ static void DeleteDirectory(char* path)
 
 static string GetLastErrorText()
 {
+    #if _WIN32
+
     DWORD errorMessageID = GetLastError();
     
     if (errorMessageID == 0)
@@ -106,6 +112,12 @@ static string GetLastErrorText()
     LocalFree(messageBuffer);
 
     return message;
+
+    #else
+
+    return string(errno == 0 ? "No error given." : strerror(errno));
+
+    #endif
 }
 
 #endif
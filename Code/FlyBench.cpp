@@ -0,0 +1,337 @@
+//
+// Gamecraft
+//
+
+// The paths suite, run with GamecraftBench paths [seed] [biome] [-noarenas] [-pools].
+
+#define BENCH_FLY_HEIGHT 250.0f
+#define BENCH_FLY_PITCH -0.35f
+#define BENCH_LINE_SPEED 40.0f
+
+#define BENCH_TELEPORT_HOPS 5
+#define BENCH_TELEPORT_DISTANCE 2048
+
+#define BENCH_PATH_COUNT 4
+
+enum BenchPathType
+{
+	BENCH_PATH_SPAWN,
+	BENCH_PATH_LINE,
+	BENCH_PATH_SPIRAL,
+	BENCH_PATH_TELEPORT
+};
+
+struct BenchPath
+{
+	char* name;
+	BenchPathType type;
+
+	// Seconds spent moving along the path. Teleport paths run until every hop is visible.
+	float duration;
+};
+
+struct BenchResult
+{
+	vector<float> frameTimes;
+	double wallTime;
+	uint32_t groupsStreamed;
+
+	// Seconds from the end of the path, or from each teleport, until the world was fully visible.
+	float visibleTime;
+	float groupLatency;
+	bool timedOut;
+
+	// Heap allocations made through operator new during the path, on the main thread
+	// and on all threads.
+	HeapTraffic mainHeap, allHeap;
+	int heapFrames;
+};
+
+static BenchPath g_benchPaths[BENCH_PATH_COUNT] =
+{
+	{ "spawn", BENCH_PATH_SPAWN, 0.0f },
+	{ "line", BENCH_PATH_LINE, 30.0f },
+	{ "spiral", BENCH_PATH_SPIRAL, 30.0f },
+	{ "teleport", BENCH_PATH_TELEPORT, 0.0f }
+};
+
+// Offset from the start of the path at time t, in blocks.
+static vec3 BenchPathOffset(BenchPathType type, float t)
+{
+	switch (type)
+	{
+		case BENCH_PATH_LINE:
+			return vec3(t * BENCH_LINE_SPEED, 0.0f, 0.0f);
+
+		case BENCH_PATH_SPIRAL:
+		{
+			// The radius grows as the spiral turns, so newly loaded groups are
+			// reached along every edge of the load area.
+			float radius = 16.0f + t * 12.0f;
+			float angle = t * 0.4f;
+			return vec3(cosf(angle) * radius - 16.0f, 0.0f, sinf(angle) * radius);
+		}
+
+		default:
+			return vec3(0.0f);
+	}
+}
+
+// Moves the player by the given amount. The velocity is cleared so that only the
+// path moves the player, while Simulate still runs collision and physics.
+static void MoveAlongPath(GameState* state, Player* player, vec3 delta)
+{
+	if (player->suspended)
+		return;
+
+	player->pos += delta;
+	player->velocity = vec3(0.0f);
+
+	Camera* cam = state->camera;
+
+	if (delta.x != 0.0f || delta.z != 0.0f)
+		cam->yaw = atan2f(delta.x, delta.z);
+
+	cam->pitch = BENCH_FLY_PITCH;
+}
+
+// Runs frames until the world is fully visible. Returns false if it took too long.
+static bool BenchSettle(GameState* state, World* world, Player* player, BenchResult& result, float& seconds)
+{
+	double start = glfwGetTime();
+
+	while (!WorldFullyVisible(world, player))
+	{
+		if (glfwGetTime() - start > BENCH_SETTLE_TIMEOUT)
+		{
+			result.timedOut = true;
+			return false;
+		}
+
+		result.frameTimes.push_back(BenchFrame(state, world, player));
+	}
+
+	seconds = (float)(glfwGetTime() - start);
+	return true;
+}
+
+// Teleports the player to a new location far from the current one, the same way
+// the loading screen does. Background work must finish before the world shifts.
+static void BenchTeleport(GameState* state, World* world, Player* player, BenchResult& result, int hop)
+{
+	while (HasBackgroundWork(world) || !world->prefetching.empty())
+		result.frameTimes.push_back(BenchFrame(state, world, player));
+
+	WorldP wP = LWorldToWorldP(world, BlockPos(player->pos));
+
+	// Alternate directions so that hops don't all head the same way.
+	int sign = (hop & 1) ? -1 : 1;
+	wP.x += BENCH_TELEPORT_DISTANCE * sign;
+	wP.z += BENCH_TELEPORT_DISTANCE / 2;
+
+	WorldLocation loc;
+	loc.wP = ivec3(wP.x & ~(CHUNK_SIZE_H - 1), 0, wP.z & ~(CHUNK_SIZE_H - 1));
+	loc.rP = ivec3(CHUNK_SIZE_H / 2, (int)BENCH_FLY_HEIGHT - 1, CHUNK_SIZE_H / 2);
+
+	state->teleportLoc = loc;
+	TeleportPlayerCallback(state, world);
+}
+
+static void RunBenchPath(GameState* state, World* world, Player* player, BenchPath& path, BenchResult& result)
+{
+	ResetPipelineStats();
+
+	#if HEAP_TRAFFIC
+	ResetHeapTraffic();
+	#endif
+
+	double start = glfwGetTime();
+
+	switch (path.type)
+	{
+		case BENCH_PATH_SPAWN:
+			BenchSettle(state, world, player, result, result.visibleTime);
+			break;
+
+		case BENCH_PATH_LINE:
+		case BENCH_PATH_SPIRAL:
+		{
+			int frames = (int)(path.duration / BENCH_FRAME_TIME);
+
+			for (int i = 0; i < frames; i++)
+			{
+				float t = i * BENCH_FRAME_TIME;
+				vec3 delta = BenchPathOffset(path.type, t + BENCH_FRAME_TIME) - BenchPathOffset(path.type, t);
+				MoveAlongPath(state, player, delta);
+
+				result.frameTimes.push_back(BenchFrame(state, world, player));
+			}
+
+			BenchSettle(state, world, player, result, result.visibleTime);
+		} break;
+
+		case BENCH_PATH_TELEPORT:
+		{
+			for (int hop = 0; hop < BENCH_TELEPORT_HOPS; hop++)
+			{
+				BenchTeleport(state, world, player, result, hop);
+
+				float seconds;
+
+				if (!BenchSettle(state, world, player, result, seconds))
+					break;
+
+				result.visibleTime = Max(result.visibleTime, seconds);
+			}
+		} break;
+	}
+
+	result.wallTime = glfwGetTime() - start;
+
+	LatencyHistogram& groups = g_pipelineStats.stages[PIPELINE_GROUP_TOTAL];
+	result.groupsStreamed = groups.total;
+	result.groupLatency = LatencyPercentile(groups, 0.95f);
+
+	#if HEAP_TRAFFIC
+	result.mainHeap = g_heapTraffic.mainTotal;
+	result.allHeap = g_heapTraffic.allTotal;
+	result.heapFrames = g_heapTraffic.frames;
+	#endif
+}
+
+static void ReportBenchResults(World* world, int seed, BenchResult* results)
+{
+	char path[MAX_PATH];
+	FILE* file = fopen(PathToExe("Benchmark.csv", path, MAX_PATH), "w");
+
+	if (file != nullptr)
+		fprintf(file, "path,frames,p50,p95,p99,max,groups,groupsPerSecond,groupP95,visibleTime,timedOut,arenas,"
+			"mainAllocsPerFrame,mainKBPerFrame,allAllocsPerFrame,allKBPerFrame\n");
+
+	printf("Benchmark: seed %i, biome %s, build %i, arenas %s\n\n", seed, GetCurrentBiome(world).name, g_buildID,
+		g_useArenas ? "on" : "off");
+	printf("%-10s %8s %8s %8s %8s %8s %8s %10s %10s %10s %10s %10s\n", "path", "frames", "p50 ms", "p95 ms", "p99 ms",
+		"max ms", "groups", "groups/s", "group p95", "visible s", "main new", "all new");
+
+	for (int i = 0; i < BENCH_PATH_COUNT; i++)
+	{
+		BenchResult& result = results[i];
+		vector<float>& times = result.frameTimes;
+		sort(times.begin(), times.end());
+
+		float p50 = FramePercentile(times, 0.5f);
+		float p95 = FramePercentile(times, 0.95f);
+		float p99 = FramePercentile(times, 0.99f);
+		float max = times.empty() ? 0.0f : times.back();
+		float groupsPerSecond = (float)(result.groupsStreamed / Max(result.wallTime, 0.001));
+
+		// Heap traffic per frame.
+		int heapFrames = Max(result.heapFrames, 1);
+		double mainAllocs = (double)result.mainHeap.allocs / heapFrames;
+		double mainKB = result.mainHeap.bytes / 1024.0 / heapFrames;
+		double allAllocs = (double)result.allHeap.allocs / heapFrames;
+		double allKB = result.allHeap.bytes / 1024.0 / heapFrames;
+
+		char visible[16];
+
+		if (result.timedOut)
+			sprintf(visible, "timeout");
+		else sprintf(visible, "%.2f", result.visibleTime);
+
+		printf("%-10s %8i %8.2f %8.2f %8.2f %8.2f %8u %10.1f %10.1f %10s %10.1f %10.1f\n", g_benchPaths[i].name, (int)times.size(),
+			p50, p95, p99, max, result.groupsStreamed, groupsPerSecond, result.groupLatency, visible, mainAllocs, allAllocs);
+
+		if (file != nullptr)
+		{
+			fprintf(file, "%s,%i,%.3f,%.3f,%.3f,%.3f,%u,%.2f,%.2f,%.3f,%i,%i,%.2f,%.2f,%.2f,%.2f\n", g_benchPaths[i].name,
+				(int)times.size(), p50, p95, p99, max, result.groupsStreamed, groupsPerSecond, result.groupLatency,
+				result.visibleTime, result.timedOut, g_useArenas, mainAllocs, mainKB, allAllocs, allKB);
+		}
+	}
+
+	if (file != nullptr)
+		fclose(file);
+}
+
+static void ReportPoolStats(char* name, PoolStats stats)
+{
+	double reuse = stats.gets > 0 ? 100.0 * (1.0 - (double)stats.allocs / stats.gets) : 0.0;
+
+	printf("%-10s %10lli %10lli %8.1f%% %10lli %10lli %10lli\n", name, stats.gets, stats.allocs, reuse,
+		stats.destroyed, stats.exchanges, stats.contended);
+}
+
+static void ReportWorldPoolStats(GameState* state, World* world)
+{
+	printf("\n%-10s %10s %10s %9s %10s %10s %10s\n", "pool", "gets", "allocs", "reuse", "destroyed",
+		"exchanges", "contended");
+
+	ReportPoolStats("groups", world->groupPool.GetStats());
+	ReportPoolStats("regions", world->regionPool.GetStats());
+	ReportPoolStats("mesh data", state->renderer.meshData.GetStats());
+}
+
+// Flies the player along each path in a new world, with the seed and biome given or the
+// defaults. The results are written to the console and to Benchmark.csv, and -pools also
+// reports how often the world's pools reused their items. The exit code is nonzero if the
+// world didn't become fully visible after a path.
+static int RunPathsBench(GameState* state, vector<char*>& args)
+{
+	bool poolStats = false;
+	vector<char*> values;
+
+	for (char* arg : args)
+	{
+		if (strcmp(arg, "-pools") == 0)
+			poolStats = true;
+		else if (strcmp(arg, "-noarenas") == 0)
+			g_useArenas = false;
+		else if (arg[0] != '-' || isdigit(arg[1]))
+			values.push_back(arg);
+	}
+
+	int seed = values.size() > 0 ? atoi(values[0]) : BENCH_DEFAULT_SEED;
+	int biome = values.size() > 1 ? atoi(values[1]) : BIOME_FOREST;
+
+	if (biome < 0 || biome >= BIOME_COUNT)
+		Error("Invalid biome %i. Expected 0 to %i.\n", biome, BIOME_COUNT - 1);
+
+	srand((uint32_t)seed);
+
+	char savePath[MAX_PATH];
+	InitHeadless(state, "BenchSaves", savePath);
+
+	World* world = CreateSeededWorld(state, seed, (BiomeType)biome);
+
+	Player* player = world->player;
+	player->moveState = MOVE_FLYING;
+
+	BenchResult results[BENCH_PATH_COUNT] = {};
+
+	for (int i = 0; i < BENCH_PATH_COUNT; i++)
+	{
+		RunBenchPath(state, world, player, g_benchPaths[i], results[i]);
+
+		if (results[i].timedOut)
+			break;
+
+		// The player spawns on the ground, but the paths are flown above the terrain.
+		if (g_benchPaths[i].type == BENCH_PATH_SPAWN)
+			player->pos.y = BENCH_FLY_HEIGHT;
+	}
+
+	ReportBenchResults(world, seed, results);
+
+	if (poolStats)
+		ReportWorldPoolStats(state, world);
+
+	bool failed = false;
+
+	for (int i = 0; i < BENCH_PATH_COUNT; i++)
+	{
+		if (results[i].timedOut)
+			failed = true;
+	}
+
+	return failed ? 1 : 0;
+}
@@ -33,12 +33,13 @@ struct LoadingInfo
 struct GameState
 {
 	AssetDatabase assets;
-	AsyncWorkQueue workQueue;
+	AsyncWorkQueue workQueues[ASYNC_PRIORITY_COUNT];
 	
 	vector<AsyncCallbackItem> callbacks;
 	SRWLOCK callbackLock;
 	
 	HANDLE semaphore;
+	int threadCount;
 
 	bool minimized;
 
@@ -51,6 +52,7 @@ struct GameState
 	UI ui;
 
 	CommandProcessor cmdProcessor;
+	Replay replay;
 
 	float time, deltaTime;
 
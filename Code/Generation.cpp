@@ -17,19 +17,23 @@ static inline float GetNoiseValue3D(float* noiseSet, int x, int y, int z, int ma
     return (noiseSet[z + CHUNK_SIZE_H * (y + maxY * x)] + 1.0f) / 2.0f;
 }
 
-static inline float* GetNoise2D(Noise* noise, int x, int y, int z, float scale = 1.0f)
+// Noise sets are allocated from the given arena. They're padded and aligned as
+// the library's own sets are, since it fills them a full SIMD vector at a time.
+static inline float* NewNoiseSet(Arena& arena, Noise* noise, int x, int y, int z, int sizeX, int sizeY, int sizeZ, float scale)
 {
-    int sizeX = CHUNK_SIZE_H;
-    int sizeY = 1;
-    int sizeZ = CHUNK_SIZE_H;
-    return noise->GetNoiseSet(x, y, z, sizeX, sizeY, sizeZ, scale);
+    float* set = (float*)ArenaAlloc(arena, Noise::AlignedSize(sizeX * sizeY * sizeZ) * sizeof(float), 64);
+    noise->FillNoiseSet(set, x, y, z, sizeX, sizeY, sizeZ, scale);
+    return set;
 }
 
-static inline float* GetNoise3D(Noise* noise, int x, int z, int maxY, float scale = 1.0f)
+static inline float* GetNoise2D(Arena& arena, Noise* noise, int x, int y, int z, float scale = 1.0f)
 {
-    int sizeX = CHUNK_SIZE_H;
-    int sizeZ = CHUNK_SIZE_H;
-    return noise->GetNoiseSet(x, 0, z, sizeX, maxY, sizeZ, scale);
+    return NewNoiseSet(arena, noise, x, y, z, CHUNK_SIZE_H, 1, CHUNK_SIZE_H, scale);
+}
+
+static inline float* GetNoise3D(Arena& arena, Noise* noise, int x, int z, int maxY, float scale = 1.0f)
+{
+    return NewNoiseSet(arena, noise, x, 0, z, CHUNK_SIZE_H, maxY, CHUNK_SIZE_H, scale);
 }
 
 static inline void CreateBox(ChunkGroup* group, ivec3 min, ivec3 max, Block block)
@@ -47,9 +51,19 @@ static inline void CreateBox(ChunkGroup* group, ivec3 min, ivec3 max, Block bloc
     }
 }
 
-static inline void CreateTree(ChunkGroup* group, ivec3 base, int minHeight, int maxHeight, Block wood, Block leaves)
+// Decorations are placed using a stream seeded from the world seed and the group's
+// position, so that a group is generated the same way on any thread and in any order.
+static inline RandomStream GroupRandomStream(World* world, ChunkGroup* group)
 {
-    int height = RandRange(minHeight, maxHeight);
+    uint32_t seed = (uint32_t)world->properties.seed;
+    seed ^= (uint32_t)group->pos.x * 73856093;
+    seed ^= (uint32_t)group->pos.z * 19349663;
+    return NewRandomStream(seed);
+}
+
+static inline void CreateTree(ChunkGroup* group, RandomStream& random, ivec3 base, int minHeight, int maxHeight, Block wood, Block leaves)
+{
+    int height = RandRange(random, minHeight, maxHeight);
 
     for (int j = 0; j < height; j++)
         SetBlock(group, base.x, base.y + j, base.z, wood);
@@ -65,7 +79,7 @@ static inline void CreateTree(ChunkGroup* group, ivec3 base, int minHeight, int
 
 static inline bool IsWithinIsland(World* world, WorldP start, int x, int z, float& p)
 {
-    int valueInCircle = (int)sqrt(Square(start.x + x) + Square(start.z + z));
+    int valueInCircle = (int)sqrt((float)(Square(start.x + x) + Square(start.z + z)));
 
     if (valueInCircle < world->properties.radius)
     {
@@ -86,6 +100,8 @@ static void GenerateForestTerrain(World* world, ChunkGroup* group)
 
     WorldP start = ChunkToWorldP(group->pos);
 
+    ScratchScope scratch;
+
     Noise* noise = Noise::NewFastNoiseSIMD();
     noise->SetSeed(world->properties.seed);
 
@@ -93,16 +109,16 @@ static void GenerateForestTerrain(World* world, ChunkGroup* group)
     noise->SetFrequency(0.015f);
     noise->SetFractalOctaves(4);
     noise->SetFractalType(Noise::RigidMulti);
-    float* ridged = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* ridged = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::SimplexFractal);
     noise->SetFrequency(0.025f);
     noise->SetFractalType(Noise::Billow);
-    float* base = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* base = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::Simplex);
     noise->SetFrequency(0.01f);
-    float* biome = GetNoise2D(noise, start.x, 0, start.z);
+    float* biome = GetNoise2D(scratch.arena, noise, start.x, 0, start.z);
 
     int surfaceMap[CHUNK_SIZE_2];
     int maxY = 0;
@@ -158,7 +174,9 @@ static void GenerateForestTerrain(World* world, ChunkGroup* group)
     noise->SetFractalOctaves(2);
     noise->SetFrequency(0.015f);
     noise->SetFractalType(Noise::FBM);
-    float* comp = GetNoise3D(noise, start.x, start.z, maxY + 1, 0.2f);
+    float* comp = GetNoise3D(scratch.arena, noise, start.x, start.z, maxY + 1, 0.2f);
+
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
 
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
@@ -204,24 +222,22 @@ static void GenerateForestTerrain(World* world, ChunkGroup* group)
         }
     }
 
-    int treeNum = RandRange(3, 6);
+    WORLDGEN_STAGE(WORLDGEN_FILL);
+
+    RandomStream random = GroupRandomStream(world, group);
+    int treeNum = RandRange(random, 3, 6);
 
     for (int i = 0; i < treeNum; i++)
     {
-        int rX = RandRange(3, CHUNK_SIZE_H - 4);
-        int rZ = RandRange(3, CHUNK_SIZE_H - 4);
+        int rX = RandRange(random, 3, CHUNK_SIZE_H - 4);
+        int rZ = RandRange(random, 3, CHUNK_SIZE_H - 4);
 
         int surface = surfaceMap[rZ * CHUNK_SIZE_H + rX];
 
         if (surface > seaLevel)
-            CreateTree(group, ivec3(rX, surface + 1, rZ), 3, 5, BLOCK_WOOD, BLOCK_LEAVES);
+            CreateTree(group, random, ivec3(rX, surface + 1, rZ), 3, 5, BLOCK_WOOD, BLOCK_LEAVES);
     }
 
-    Noise::FreeNoiseSet(comp);
-    Noise::FreeNoiseSet(ridged);
-    Noise::FreeNoiseSet(base);
-    Noise::FreeNoiseSet(biome);
-
     delete noise;
 }
 
@@ -231,6 +247,8 @@ static void GenerateIslandsTerrain(World* world, ChunkGroup* group)
 
     WorldP start = ChunkToWorldP(group->pos);
 
+    ScratchScope scratch;
+
     Noise* noise = Noise::NewFastNoiseSIMD();
     noise->SetSeed(world->properties.seed);
 
@@ -238,16 +256,16 @@ static void GenerateIslandsTerrain(World* world, ChunkGroup* group)
     noise->SetFrequency(0.015f);
     noise->SetFractalOctaves(4);
     noise->SetFractalType(Noise::RigidMulti);
-    float* ridged = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* ridged = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::SimplexFractal);
     noise->SetFrequency(0.025f);
     noise->SetFractalType(Noise::Billow);
-    float* base = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* base = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::Simplex);
     noise->SetFrequency(0.01f);
-    float* biome = GetNoise2D(noise, start.x, 0, start.z);
+    float* biome = GetNoise2D(scratch.arena, noise, start.x, 0, start.z);
 
     int surfaceMap[CHUNK_SIZE_2];
     int maxY = 0;
@@ -301,7 +319,9 @@ static void GenerateIslandsTerrain(World* world, ChunkGroup* group)
     noise->SetFractalOctaves(2);
     noise->SetFrequency(0.015f);
     noise->SetFractalType(Noise::FBM);
-    float* comp = GetNoise3D(noise, start.x, start.z, maxY + 1, 0.2f);
+    float* comp = GetNoise3D(scratch.arena, noise, start.x, start.z, maxY + 1, 0.2f);
+
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
 
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
@@ -347,24 +367,22 @@ static void GenerateIslandsTerrain(World* world, ChunkGroup* group)
         }
     }
 
-    int treeNum = RandRange(1, 3);
+    WORLDGEN_STAGE(WORLDGEN_FILL);
+
+    RandomStream random = GroupRandomStream(world, group);
+    int treeNum = RandRange(random, 1, 3);
 
     for (int i = 0; i < treeNum; i++)
     {
-        int rX = RandRange(3, CHUNK_SIZE_H - 4);
-        int rZ = RandRange(3, CHUNK_SIZE_H - 4);
+        int rX = RandRange(random, 3, CHUNK_SIZE_H - 4);
+        int rZ = RandRange(random, 3, CHUNK_SIZE_H - 4);
 
         int surface = surfaceMap[rZ * CHUNK_SIZE_H + rX];
 
         if (surface > seaLevel)
-            CreateTree(group, ivec3(rX, surface + 1, rZ), 3, 5, BLOCK_WOOD, BLOCK_LEAVES);
+            CreateTree(group, random, ivec3(rX, surface + 1, rZ), 3, 5, BLOCK_WOOD, BLOCK_LEAVES);
     }
 
-    Noise::FreeNoiseSet(comp);
-    Noise::FreeNoiseSet(ridged);
-    Noise::FreeNoiseSet(base);
-    Noise::FreeNoiseSet(biome);
-
     delete noise;
 }
 
@@ -385,7 +403,7 @@ static void GenerateGridTerrain(World* world, ChunkGroup* group)
         {
             for (int x = 0; x < CHUNK_SIZE_H; x += 2)
             {
-                int valueInCircle = (int)sqrt(Square(start.x + x) + Square(start.z + z));
+                int valueInCircle = (int)sqrt((float)(Square(start.x + x) + Square(start.z + z)));
 
                 if (valueInCircle < world->properties.radius)
                 {
@@ -407,6 +425,8 @@ static void GenerateGridTerrain(World* world, ChunkGroup* group)
         for (int y = 40; y <= 64; y += 2)
             SetBlock(chunk, 16, y, 16, BLOCK_METAL_CRATE);
     }
+
+    WORLDGEN_STAGE(WORLDGEN_FILL);
 }
 
 static void GenerateSnowTerrain(World* world, ChunkGroup* group)
@@ -415,6 +435,8 @@ static void GenerateSnowTerrain(World* world, ChunkGroup* group)
 
     WorldP start = ChunkToWorldP(group->pos);
 
+    ScratchScope scratch;
+
     Noise* noise = Noise::NewFastNoiseSIMD();
     noise->SetSeed(world->properties.seed);
 
@@ -422,17 +444,17 @@ static void GenerateSnowTerrain(World* world, ChunkGroup* group)
     noise->SetFrequency(0.015f);
     noise->SetFractalOctaves(4);
     noise->SetFractalType(Noise::RigidMulti);
-    float* ridged = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* ridged = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::SimplexFractal);
     noise->SetFrequency(0.025f);
     noise->SetFractalType(Noise::Billow);
-    float* base = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* base = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetFrequency(0.005f);
     noise->SetFractalType(Noise::FBM);
     noise->SetFractalOctaves(3);
-    float* biome = GetNoise2D(noise, start.x, 0, start.z);
+    float* biome = GetNoise2D(scratch.arena, noise, start.x, 0, start.z);
 
     int surfaceMap[CHUNK_SIZE_2];
 
@@ -495,7 +517,9 @@ static void GenerateSnowTerrain(World* world, ChunkGroup* group)
     noise->SetFractalOctaves(2);
     noise->SetFrequency(0.015f);
     noise->SetFractalType(Noise::FBM);
-    float* comp = GetNoise3D(noise, start.x, start.z, maxY + 1, 0.2f);
+    float* comp = GetNoise3D(scratch.arena, noise, start.x, start.z, maxY + 1, 0.2f);
+
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
 
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
@@ -547,10 +571,7 @@ static void GenerateSnowTerrain(World* world, ChunkGroup* group)
         }
     }
 
-    Noise::FreeNoiseSet(comp);
-    Noise::FreeNoiseSet(ridged);
-    Noise::FreeNoiseSet(base);
-    Noise::FreeNoiseSet(biome);
+    WORLDGEN_STAGE(WORLDGEN_FILL);
 
     delete noise;
 }
@@ -561,13 +582,15 @@ static void GenerateDesertTerrain(World* world, ChunkGroup* group)
 
     WorldP start = ChunkToWorldP(group->pos);
 
+    ScratchScope scratch;
+
     Noise* noise = Noise::NewFastNoiseSIMD();
     noise->SetSeed(world->properties.seed);
 
     noise->SetNoiseType(Noise::SimplexFractal);
     noise->SetFrequency(0.05f);
     noise->SetFractalType(Noise::Billow);
-    float* base = GetNoise2D(noise, start.x, 0, start.z, 0.25f);
+    float* base = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.25f);
 
     int surfaceMap[CHUNK_SIZE_2];
     int maxY = 0;
@@ -598,6 +621,8 @@ static void GenerateDesertTerrain(World* world, ChunkGroup* group)
         }
     }
 
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
+
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
         Chunk* chunk = group->chunks + i;
@@ -626,21 +651,23 @@ static void GenerateDesertTerrain(World* world, ChunkGroup* group)
             }
         }
     }
-    
-    int cactusNum = RandRange(0, 2);
+
+    WORLDGEN_STAGE(WORLDGEN_FILL);
+
+    RandomStream random = GroupRandomStream(world, group);
+    int cactusNum = RandRange(random, 0, 2);
 
     for (int i = 0; i < cactusNum; i++)
     {
-        int rX = RandRange(0, CHUNK_SIZE_H - 1);
-        int rZ = RandRange(0, CHUNK_SIZE_H - 1);
+        int rX = RandRange(random, 0, CHUNK_SIZE_H - 1);
+        int rZ = RandRange(random, 0, CHUNK_SIZE_H - 1);
 
-        int height = RandRange(2, 4);
+        int height = RandRange(random, 2, 4);
 
         for (int j = 1; j <= height; j++)
             SetBlock(group, rX, surfaceMap[rZ * CHUNK_SIZE_H + rX] + j, rZ, BLOCK_CACTUS);
     }
 
-    Noise::FreeNoiseSet(base);
     delete noise;
 }
 
@@ -650,6 +677,8 @@ static void GenerateVolcanicTerrain(World* world, ChunkGroup* group)
 
     WorldP start = ChunkToWorldP(group->pos);
 
+    ScratchScope scratch;
+
     Noise* noise = Noise::NewFastNoiseSIMD();
     noise->SetSeed(world->properties.seed);
 
@@ -657,16 +686,16 @@ static void GenerateVolcanicTerrain(World* world, ChunkGroup* group)
     noise->SetFrequency(0.015f);
     noise->SetFractalOctaves(4);
     noise->SetFractalType(Noise::RigidMulti);
-    float* ridged = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* ridged = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::SimplexFractal);
     noise->SetFrequency(0.025f);
     noise->SetFractalType(Noise::Billow);
-    float* base = GetNoise2D(noise, start.x, 0, start.z, 0.5f);
+    float* base = GetNoise2D(scratch.arena, noise, start.x, 0, start.z, 0.5f);
 
     noise->SetNoiseType(Noise::Simplex);
     noise->SetFrequency(0.005f);
-    float* biome = GetNoise2D(noise, start.x, 0, start.z);
+    float* biome = GetNoise2D(scratch.arena, noise, start.x, 0, start.z);
 
     int surfaceMap[CHUNK_SIZE_2];
     int maxY = 0;
@@ -720,7 +749,9 @@ static void GenerateVolcanicTerrain(World* world, ChunkGroup* group)
     noise->SetFractalOctaves(2);
     noise->SetFrequency(0.015f);
     noise->SetFractalType(Noise::FBM);
-    float* comp = GetNoise3D(noise, start.x, start.z, maxY + 1, 0.2f);
+    float* comp = GetNoise3D(scratch.arena, noise, start.x, start.z, maxY + 1, 0.2f);
+
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
 
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
@@ -761,10 +792,7 @@ static void GenerateVolcanicTerrain(World* world, ChunkGroup* group)
         }
     }
 
-    Noise::FreeNoiseSet(comp);
-    Noise::FreeNoiseSet(ridged);
-    Noise::FreeNoiseSet(base);
-    Noise::FreeNoiseSet(biome);
+    WORLDGEN_STAGE(WORLDGEN_FILL);
 
     delete noise;
 }
@@ -800,6 +828,8 @@ static void GenerateFlatTerrain(World* world, ChunkGroup* group)
         }
     }
 
+    WORLDGEN_STAGE(WORLDGEN_NOISE);
+
     for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
     {
         Chunk* chunk = group->chunks + i;
@@ -833,6 +863,8 @@ static void GenerateFlatTerrain(World* world, ChunkGroup* group)
             }
         }
     }
+
+    WORLDGEN_STAGE(WORLDGEN_FILL);
 }
 
 static void GenerateVoidTerrain(World*, ChunkGroup* group)
@@ -849,4 +881,6 @@ static void GenerateVoidTerrain(World*, ChunkGroup* group)
                 SetBlock(chunk, x, 40, z, BLOCK_GRASS);
         }
     }
+
+    WORLDGEN_STAGE(WORLDGEN_FILL);
 }
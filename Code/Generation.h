@@ -2,6 +2,52 @@
 // Gamecraft
 //
 
+// Stages of generating and lighting a group, as timed by the world generation test.
+enum WorldGenStage
+{
+    WORLDGEN_NOISE,
+    WORLDGEN_FILL,
+    WORLDGEN_DECORATION,
+    WORLDGEN_SURFACE,
+    WORLDGEN_LIGHTING,
+    WORLDGEN_STAGE_COUNT
+};
+
+// Accumulates the time spent in each stage. The biome functions mark the end of their 
+// noise and fill stages, and whatever follows the last mark is counted as decoration.
+struct WorldGenTimer
+{
+    double stages[WORLDGEN_STAGE_COUNT];
+    double last;
+};
+
+// Only the benchmark build times the stages.
+#if HEADLESS
+
+// Set by the world generation test while it runs, which is the only time groups
+// are generated on the main thread.
+static WorldGenTimer* g_worldGenTimer;
+
+static inline void MarkWorldGenStage(WorldGenStage stage)
+{
+    WorldGenTimer* timer = g_worldGenTimer;
+
+    if (timer == nullptr)
+        return;
+
+    double now = glfwGetTime();
+    timer->stages[stage] += now - timer->last;
+    timer->last = now;
+}
+
+#define WORLDGEN_STAGE(stage) MarkWorldGenStage(stage)
+
+#else
+
+#define WORLDGEN_STAGE(stage)
+
+#endif
+
 static void GenerateForestTerrain(World* world, ChunkGroup* group);
 static void GenerateIslandsTerrain(World* world, ChunkGroup* group);
 static void GenerateGridTerrain(World* world, ChunkGroup* group);
@@ -0,0 +1,164 @@
+//
+// Gamecraft
+//
+
+// The headless build has no window, OpenGL context, or audio device, and doesn't link
+// GLFW or GLEW. The renderer's code is still compiled, so the GL calls it makes are
+// declared here as stubs that do nothing. None of them are reached while running headless.
+
+#include <chrono>
+
+typedef unsigned int GLenum;
+typedef unsigned int GLbitfield;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned char GLboolean;
+typedef float GLfloat;
+typedef char GLchar;
+typedef void GLvoid;
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+
+typedef void (*GLDEBUGPROC)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
+
+#define APIENTRY
+
+#define GL_ACTIVE_UNIFORMS 0x8B86
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_BACK 0x0405
+#define GL_BLEND 0x0BE2
+#define GL_CLAMP 0x2900
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_COLOR_BUFFER_BIT 0x00004000
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_COPY_READ_BUFFER 0x8F36
+#define GL_COPY_WRITE_BUFFER 0x8F37
+#define GL_CULL_FACE 0x0B44
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#define GL_DEPTH_BUFFER_BIT 0x00000100
+#define GL_DEPTH_COMPONENT24 0x81A6
+#define GL_DEPTH_TEST 0x0B71
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_FALSE 0
+#define GL_FILL 0x1B02
+#define GL_FLOAT 0x1406
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT 0x8CD6
+#define GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER 0x8CDB
+#define GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS 0x8DA8
+#define GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT 0x8CD7
+#define GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE 0x8D56
+#define GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER 0x8CDC
+#define GL_FRAMEBUFFER_UNDEFINED 0x8219
+#define GL_FRAMEBUFFER_UNSUPPORTED 0x8CDD
+#define GL_FRONT 0x0404
+#define GL_INFO_LOG_LENGTH 0x8B84
+#define GL_LINES 0x0001
+#define GL_LINK_STATUS 0x8B82
+#define GL_MULTISAMPLE 0x809D
+#define GL_NEAREST 0x2600
+#define GL_NEAREST_MIPMAP_LINEAR 0x2702
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#define GL_REPEAT 0x2901
+#define GL_RGBA 0x1908
+#define GL_RGBA8 0x8058
+#define GL_SRC_ALPHA 0x0302
+#define GL_STATIC_DRAW 0x88E4
+#define GL_STREAM_DRAW 0x88E0
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#define GL_TEXTURE_2D_MULTISAMPLE 0x9100
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_TRIANGLES 0x0004
+#define GL_TRUE 1
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_WRITE_ONLY 0x88B9
+
+static inline void glAttachShader(GLuint, GLuint) {}
+static inline void glBindBuffer(GLenum, GLuint) {}
+static inline void glBindFramebuffer(GLenum, GLuint) {}
+static inline void glBindTexture(GLenum, GLuint) {}
+static inline void glBindVertexArray(GLuint) {}
+static inline void glBlendFunc(GLenum, GLenum) {}
+static inline void glBlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {}
+static inline void glBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+static inline void glBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) {}
+static inline GLenum glCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+static inline void glClear(GLbitfield) {}
+static inline void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+static inline void glCompileShader(GLuint) {}
+static inline void glCopyBufferSubData(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr) {}
+static inline GLuint glCreateProgram() { return 0; }
+static inline GLuint glCreateShader(GLenum) { return 0; }
+static inline void glDebugMessageCallback(GLDEBUGPROC, const void*) {}
+static inline void glDeleteBuffers(GLsizei, const GLuint*) {}
+static inline void glDeleteFramebuffers(GLsizei, const GLuint*) {}
+static inline void glDeleteShader(GLuint) {}
+static inline void glDeleteTextures(GLsizei, const GLuint*) {}
+static inline void glDeleteVertexArrays(GLsizei, const GLuint*) {}
+static inline void glDepthMask(GLboolean) {}
+static inline void glDisable(GLenum) {}
+static inline void glDrawArrays(GLenum, GLint, GLsizei) {}
+static inline void glDrawBuffer(GLenum) {}
+static inline void glDrawElements(GLenum, GLsizei, GLenum, const GLvoid*) {}
+static inline void glDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) {}
+static inline void glEnable(GLenum) {}
+static inline void glEnableVertexAttribArray(GLuint) {}
+static inline void glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+static inline void glGenBuffers(GLsizei, GLuint*) {}
+static inline void glGenFramebuffers(GLsizei, GLuint*) {}
+static inline void glGenTextures(GLsizei, GLuint*) {}
+static inline void glGenVertexArrays(GLsizei, GLuint*) {}
+static inline void glGenerateMipmap(GLenum) {}
+static inline void glGetActiveUniformName(GLuint, GLuint, GLsizei, GLsizei*, GLchar*) {}
+static inline void glGetProgramInfoLog(GLuint, GLsizei, GLsizei*, GLchar*) {}
+static inline void glGetProgramiv(GLuint, GLenum, GLint*) {}
+static inline void glGetShaderiv(GLuint, GLenum, GLint*) {}
+static inline GLint glGetUniformLocation(GLuint, const GLchar*) { return -1; }
+static inline GLboolean glIsBuffer(GLuint) { return 0; }
+static inline GLboolean glIsProgram(GLuint) { return 0; }
+static inline void glLinkProgram(GLuint) {}
+static inline void* glMapBuffer(GLenum, GLenum) { return nullptr; }
+static inline void glMultiDrawElementsBaseVertex(GLenum, const GLsizei*, GLenum, const void* const*, GLsizei, const GLint*) {}
+static inline void glPolygonMode(GLenum, GLenum) {}
+static inline void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+static inline void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) {}
+static inline void glTexImage2DMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLboolean) {}
+static inline void glTexParameteri(GLenum, GLenum, GLint) {}
+static inline void glTexStorage3D(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLsizei) {}
+static inline void glTexSubImage3D(GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLenum, const GLvoid*) {}
+static inline void glUniform1f(GLint, GLfloat) {}
+static inline void glUniform1i(GLint, GLint) {}
+static inline void glUniform2f(GLint, GLfloat, GLfloat) {}
+static inline void glUniform3f(GLint, GLfloat, GLfloat, GLfloat) {}
+static inline void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) {}
+static inline void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+static inline GLboolean glUnmapBuffer(GLenum) { return 0; }
+static inline void glUseProgram(GLuint) {}
+static inline void glVertexAttribDivisor(GLuint, GLuint) {}
+static inline void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+static inline void glViewport(GLint, GLint, GLsizei, GLsizei) {}
+
+struct GLFWwindow;
+
+// Seconds since the program started, in place of GLFW's timer.
+static inline double glfwGetTime()
+{
+	using namespace std::chrono;
+	static steady_clock::time_point start = steady_clock::now();
+	return duration<double>(steady_clock::now() - start).count();
+}
@@ -22,6 +22,15 @@ static inline bool MouseHeld(Input& input, int button)
 	return input.mouseHeld[button];
 }
 
+inline void ResetInput(Input& input)
+{
+	memset(&input.single, 0, sizeof(input.single));
+	memset(&input.mousePressed, 0, sizeof(input.mousePressed));
+}
+
+// Window callbacks. The headless build has no window, so it gets no input from them.
+#if !HEADLESS
+
 static void SetKey(Input& input, KeyType type, int action)
 {
 	if (action == GLFW_RELEASE)
@@ -35,12 +44,6 @@ static void SetKey(Input& input, KeyType type, int action)
 	}		
 }
 
-inline void ResetInput(Input& input)
-{
-	memset(&input.single, 0, sizeof(input.single));
-	memset(&input.mousePressed, 0, sizeof(input.mousePressed));
-}
-
 static void InputCharCallback(GLFWwindow*, unsigned int c)
 {
     ImGuiIO& io = ImGui::GetIO();
@@ -220,3 +223,5 @@ static void OnMouseButton(GLFWwindow* window, int button, int action, int)
 		}
 	}
 }
+
+#endif
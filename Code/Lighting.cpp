@@ -11,6 +11,7 @@ static inline void ComputeSurfaceAt(ChunkGroup* group, int x, int z)
         if (GetBlock(group, x, y, z) != BLOCK_AIR)
         {
             group->surface[index] = (uint8_t)(y + 1);
+            group->maxSurface = Max(group->maxSurface, group->surface[index]);
             break;
         }
     }
@@ -25,6 +26,15 @@ static inline void ComputeSurface(ChunkGroup* group)
     }
 }
 
+// Groups restored from disk or the cache read their surface rather than computing it.
+static inline void ComputeMaxSurface(ChunkGroup* group)
+{
+    group->maxSurface = 0;
+
+    for (int i = 0; i < CHUNK_SIZE_2; i++)
+        group->maxSurface = Max(group->maxSurface, group->surface[i]);
+}
+
 static inline int ComputeMaxY(World* world, ChunkGroup* group, int x, int z, int surface)
 {
     LChunkP lcP = group->chunks->lcPos;
@@ -78,6 +88,21 @@ static inline uint8_t GetSunlight(Chunk* chunk, int rX, int lwY, int rZ, int ind
     return light == 0 ? MIN_LIGHT : light;
 }
 
+// Marks the chunk for a mesh rebuild and the group's saved light as stale
+// after an edit changed its light values. Light at a block affects the vertices 
+// of the blocks around it, which may lie in the sections above or below.
+static inline void FlagLightChanged(Chunk* chunk, int rY)
+{
+    chunk->group->lightDirty = true;
+    chunk->version++;
+
+    chunk->dirtySections |= 1 << (Max(rY - 1, 0) >> CHUNK_SECTION_BITS);
+    chunk->dirtySections |= 1 << (Min(rY + 1, CHUNK_V_MASK) >> CHUNK_SECTION_BITS);
+
+    if (chunk->state >= CHUNK_BUILDING)
+        chunk->pendingUpdate = true;
+}
+
 static inline bool SetMaxSunlight(Chunk* chunk, int light, int lwY, RelP rel) 
 {
     int index = BlockIndex(rel.x, rel.y, rel.z);
@@ -133,8 +158,8 @@ static inline void ScatterSunlight(World* world, Queue<ivec3>& sunNodes, bool up
             Chunk* next = GetRelative(world, nextP.x, nextP.y, nextP.z, rel);
             Block adjBlock = GetBlock(next, rel);
 
-            if (updateChunks && next->state >= CHUNK_BUILDING)
-                next->pendingUpdate = true;
+            if (updateChunks)
+                FlagLightChanged(next, rel.y);
 
             if (!IsOpaque(world, adjBlock) && SetMaxSunlight(next, light, nextP.y, rel))
                 sunNodes.Enqueue(ivec3(nextP.x, nextP.y, nextP.z));
@@ -144,7 +169,8 @@ static inline void ScatterSunlight(World* world, Queue<ivec3>& sunNodes, bool up
 
 static inline void RemoveSunlightNodes(World* world, Queue<ivec3>& sunNodes)
 {
-	Queue<ivec3> newNodes(MAX_LIGHT_NODES);
+	ScratchScope scratch;
+	Queue<ivec3> newNodes(scratch.arena, MAX_LIGHT_NODES);
 
     while (!sunNodes.Empty())
     {
@@ -184,8 +210,7 @@ static inline void RemoveSunlightNodes(World* world, Queue<ivec3>& sunNodes)
             	else newNodes.Enqueue(ivec3(nextP.x, nextP.y, nextP.z));
             }
 
-            if (next->state >= CHUNK_BUILDING)
-                next->pendingUpdate = true;
+            FlagLightChanged(next, rel.y);
         }
     }
 
@@ -219,8 +244,8 @@ static inline void ScatterBlockLight(World* world, Queue<ivec3>& lightNodes, boo
             Chunk* next = GetRelative(world, nextP.x, nextP.y, nextP.z, rel);
             Block adjBlock = GetBlock(next, rel);
 
-            if (updateChunks && next->state >= CHUNK_BUILDING)
-                next->pendingUpdate = true;
+            if (updateChunks)
+                FlagLightChanged(next, rel.y);
 
             if (!IsOpaque(world, adjBlock) && SetMaxBlockLight(next, light, rel))
                 lightNodes.Enqueue(ivec3(nextP.x, nextP.y, nextP.z));
@@ -280,6 +305,89 @@ static void SetLightNodes(World* world, ChunkGroup* group, Queue<ivec3>& sunNode
     ScatterBlockLight(world, lightNodes, false);
 }
 
+static inline void ClearGroupLight(ChunkGroup* group)
+{
+    for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
+    {
+        Chunk* chunk = group->chunks + i;
+        memset(chunk->sunlight, 0, CHUNK_SIZE_3);
+        memset(chunk->blockLight, 0, CHUNK_SIZE_3);
+    }
+}
+
+// Queues every lit block in the column up to maxY so that its existing light 
+// will be scattered into adjacent blocks.
+static inline void QueueColumnLight(ChunkGroup* group, int x, int z, int maxY, Queue<ivec3>& sunNodes, Queue<ivec3>& lightNodes)
+{
+    LWorldP lwP = group->chunks->lwPos;
+
+    for (int lwY = 0; lwY <= maxY; lwY++)
+    {
+        Chunk* chunk = GetChunk(group, lwY >> CHUNK_V_BITS);
+        int index = BlockIndex(x, lwY & CHUNK_V_MASK, z);
+        ivec3 p = ivec3(lwP.x + x, lwY, lwP.z + z);
+
+        if (GetSunlight(chunk, x, lwY, z, index) > MIN_LIGHT)
+            sunNodes.Enqueue(p);
+
+        if (chunk->blockLight[index] > MIN_LIGHT)
+            lightNodes.Enqueue(p);
+    }
+}
+
+// Light restored from disk is final within the group, but it was never scattered into 
+// the neighbors. All light leaving the group passes through its border columns, so 
+// scattering from those reproduces the group's contribution to its neighbors.
+static void SetBorderLightNodes(World* world, ChunkGroup* group, Queue<ivec3>& sunNodes, Queue<ivec3>& lightNodes)
+{
+    for (int z = 0; z < CHUNK_SIZE_H; z++)
+    {
+        for (int x = 0; x < CHUNK_SIZE_H; x++)
+        {
+            if (x != 0 && z != 0 && x != CHUNK_H_MASK && z != CHUNK_H_MASK)
+                continue;
+
+            int surface = group->surface[z * CHUNK_SIZE_H + x];
+            int maxY = Min(ComputeMaxY(world, group, x, z, surface), WORLD_BLOCK_HEIGHT - 1);
+            QueueColumnLight(group, x, z, maxY, sunNodes, lightNodes);
+        }
+    }
+
+    ScatterSunlight(world, sunNodes, false);
+    ScatterBlockLight(world, lightNodes, false);
+}
+
+// Queues the columns of preprocessed neighbors that face this group. Used when
+// the group's light is cleared after the neighbors have already scattered into it.
+static void QueueNeighborBorderLight(World* world, ChunkGroup* group, Queue<ivec3>& sunNodes, Queue<ivec3>& lightNodes)
+{
+    LChunkP lcP = group->chunks->lcPos;
+
+    // The first four entries of DIRS_2 are the direct neighbors.
+    for (int i = 0; i < 4; i++)
+    {
+        ivec3 dir = DIRS_2[i];
+        ChunkGroup* adj = GetGroup(world, lcP + dir);
+
+        if (adj->state != GROUP_PREPROCESSED)
+            continue;
+
+        for (int j = 0; j < CHUNK_SIZE_H; j++)
+        {
+            int x = dir.x == 0 ? j : (dir.x < 0 ? 0 : CHUNK_H_MASK);
+            int z = dir.z == 0 ? j : (dir.z < 0 ? 0 : CHUNK_H_MASK);
+            int adjX = dir.x == 0 ? x : CHUNK_H_MASK - x;
+            int adjZ = dir.z == 0 ? z : CHUNK_H_MASK - z;
+
+            int surface = group->surface[z * CHUNK_SIZE_H + x];
+            int adjSurface = adj->surface[adjZ * CHUNK_SIZE_H + adjX];
+            int maxY = Min(Max(surface, adjSurface), WORLD_BLOCK_HEIGHT - 1);
+
+            QueueColumnLight(adj, adjX, adjZ, maxY, sunNodes, lightNodes);
+        }
+    }
+}
+
 static void UpdateSunlight(World* world, LWorldP pos, Queue<ivec3>& sunNodes)
 {
 	for (int i = 0; i < 6; i++)
@@ -340,7 +448,8 @@ static void RecomputeSunlight(World* world, Chunk* chunk, int rX, int rY, int rZ
 
 static inline void RemoveLightNodes(World* world, Queue<ivec3>& lightNodes)
 {
-	Queue<ivec3> newNodes(MAX_LIGHT_NODES);
+	ScratchScope scratch;
+	Queue<ivec3> newNodes(scratch.arena, MAX_LIGHT_NODES);
 
     while (!lightNodes.Empty())
     {
@@ -377,8 +486,7 @@ static inline void RemoveLightNodes(World* world, Queue<ivec3>& lightNodes)
             if (GetLightEmitted(world, adjBlock) > MIN_LIGHT)
 				newNodes.Enqueue(nextP);
 
-			if (next->state >= CHUNK_BUILDING)
-            	next->pendingUpdate = true;
+			FlagLightChanged(next, rel.y);
         }
     }
 
@@ -428,8 +536,9 @@ static void RecomputeBlockLight(World* world, Chunk* chunk, int rX, int rY, int
 
 static void RecomputeLight(World* world, Chunk* chunk, int rX, int rY, int rZ)
 {
-    Queue<ivec3> sunNodes(262144);
-    Queue<ivec3> lightNodes(262144);
+    ScratchScope scratch;
+    Queue<ivec3> sunNodes(scratch.arena, MAX_LIGHT_NODES);
+    Queue<ivec3> lightNodes(scratch.arena, MAX_LIGHT_NODES);
 
     RecomputeSunlight(world, chunk, rX, rY, rZ, sunNodes);
     RecomputeBlockLight(world, chunk, rX, rY, rZ, lightNodes);
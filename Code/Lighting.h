@@ -8,4 +8,5 @@
 #define MAX_LIGHT_NODES 262144
 
 static inline void ComputeSurface(ChunkGroup* group);
+static inline void ComputeMaxSurface(ChunkGroup* group);
 static void RecomputeLight(World* world, Chunk* chunk, int rX, int rY, int rZ);
@@ -14,22 +14,42 @@ static int g_buildID = 304;
 
 #pragma warning(push, 0)
 
-#define GLFW_EXPOSE_NATIVE_WIN32
-#define GLEW_STATIC
+#if _WIN32
+
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
 #include <shlwapi.h>
+
+#else
+
+// Only the headless build runs on other platforms.
+#include "Posix.h"
+
+#endif
+
+#if !HEADLESS
+
+#define GLFW_EXPOSE_NATIVE_WIN32
+#define GLEW_STATIC
+
 #include <xaudio2.h>
-#include <time.h>
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "GLFW/glfw3native.h"
-#include "FastNoiseSIMD.h"
 #include "imgui.h"
 
 #include "stb_vorbis.h"
 
+#endif
+
+#include <time.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <float.h>
+#include <immintrin.h>
+#include "FastNoiseSIMD.h"
+
 #include <vector>
 #include <queue>
 #include <fstream>
@@ -37,6 +57,8 @@ static int g_buildID = 304;
 #include <algorithm>
 #include <atomic>
 #include <stack>
+#include <list>
+#include <unordered_map>
 
 #define GLM_FORCE_AVX2
 #define GLM_FORCE_INLINE
@@ -55,11 +77,20 @@ static int g_buildID = 304;
 using namespace glm;
 using namespace std;
 
+#if HEADLESS
+#include "Headless.h"
+#endif
+
 #pragma warning(pop)
 
 #define Unused(x) ((void)(x))
 
-#if _DEBUG
+#if HEADLESS
+#define Print(...) { \
+    printf(__VA_ARGS__); \
+    fflush(stdout); \
+}
+#elif _DEBUG
 #define Print(...) { \
     char print_buffer[256]; \
     snprintf(print_buffer, sizeof(print_buffer), __VA_ARGS__); \
@@ -73,7 +104,14 @@ using namespace std;
 }
 #endif
 
-#if _DEBUG
+// The benchmark runs unattended, so errors are written to the console instead of
+// breaking into the debugger or showing a message box.
+#if HEADLESS
+#define Error(...) { \
+    fprintf(stderr, __VA_ARGS__); \
+    exit(-1); \
+}
+#elif _DEBUG
 #define Error(...) { \
     char error_buffer[256]; \
     snprintf(error_buffer, sizeof(error_buffer), __VA_ARGS__); \
@@ -91,7 +129,9 @@ using namespace std;
 
 #include "Config.h"
 #include "Utils.h"
+#include "Memory.h"
 #include "ObjectPool.h"
+#include "Arena.h"
 #include "Containers.h"
 #include "Random.h"
 #include "Debug.h"
@@ -110,11 +150,14 @@ using namespace std;
 #include "WorldIO.h"
 #include "Renderer.h"
 #include "Lighting.h"
+#include "SmoothLight.h"
 #include "WorldRender.h"
 #include "Simulation.h"
+#include "Physics.h"
 #include "Async.h"
 #include "Commands.h"
-#include "Gamestate.h"
+#include "Replay.h"
+#include "GameState.h"
 
 static void Pause(GameState* state, PauseState pauseState);
 static void Unpause(GameState* state);
@@ -133,27 +176,46 @@ static inline void CenterCursor();
 #include "World.cpp"
 #include "Lighting.cpp"
 #include "WorldRender.cpp"
+#include "SmoothLight.cpp"
 #include "Particles.cpp"
 #include "Dungeon.cpp"
 #include "Environment.cpp"
 #include "Generation.cpp"
 #include "WorldIO.cpp"
 #include "Simulation.cpp"
+#include "Physics.cpp"
+
+#if !HEADLESS
 #include "UI.cpp"
+#endif
+
 #include "Commands.cpp"
+#include "Replay.cpp"
+
+// Headless builds have no window or audio device, so the window and audio calls
+// below are compiled out of them.
+#if !HEADLESS
 
 static GLFWwindow* window;
 
 // Window placement for fullscreen toggling.
 static WINDOWPLACEMENT windowPos = { sizeof(windowPos) };
 
+#endif
+
 static inline ivec2 FramebufferSize()
 {
+	#if HEADLESS
+	return ivec2(0);
+	#else
 	int displayW, displayH;
     glfwGetFramebufferSize(window, &displayW, &displayH);
     return ivec2(displayW, displayH);
+	#endif
 }
 
+#if !HEADLESS
+
 static void ToggleFullscreen(HWND wnd)
 {
 	DWORD style = GetWindowLong(wnd, GWL_STYLE);
@@ -177,10 +239,15 @@ static void ToggleFullscreen(HWND wnd)
 	}
 }
 
+#endif
+
 static void Pause(GameState* state, PauseState pauseState)
 {
+	#if !HEADLESS
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 	ChangeVolume(&state->audio, 0.25f, 0.5f);
+	#endif
+
 	Renderer& rend = state->renderer;
 	rend.fadeColor.a = rend.fadeColor.a > 0.5f ? 0.9f : 0.75f;
 	state->pauseState = pauseState;
@@ -188,14 +255,19 @@ static void Pause(GameState* state, PauseState pauseState)
 
 static inline void CenterCursor()
 {
+	#if !HEADLESS
 	ivec2 size = FramebufferSize();
 	glfwSetCursorPos(window, size.x * 0.5f, size.y * 0.5f);
+	#endif
 }
 
 static void Unpause(GameState* state)
 {
+	#if !HEADLESS
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 	ChangeVolume(&state->audio, 0.75f, 0.5f);
+	#endif
+
 	Renderer& rend = state->renderer;
 	rend.fadeColor.a = 0.0f;
 	CenterCursor();
@@ -246,7 +318,8 @@ static void ProcessLoadingScreen(GameState* state, World* world, float deltaTime
 	}
 	else
 	{
-		if (HasBackgroundWork(world))
+		// Prefetches write to the world's regions and cache, so they must finish as well.
+		if (HasBackgroundWork(world) || !world->prefetching.empty())
 			return;
 
 		info.callback(state, world);
@@ -266,8 +339,10 @@ static void OnGamePlaying(GameState* state)
 	if (KeyPressed(state->input, KEY_E))
 		Pause(state, SELECTING_BLOCK);
 
+	#if !HEADLESS
 	if (KeyPressed(state->input, KEY_T))
 		ToggleFullscreen(glfwGetWin32Window(window));
+	#endif
 }
 
 static void OnGamePaused(GameState* state)
@@ -316,6 +391,10 @@ static void Update(GameState* state, Player* player, World* world, float deltaTi
 	if (state->pauseState != PLAYING || !player->spawned) 
 		return;
 
+	Camera* cam = state->camera;
+	vec2 rotation = vec2(0.0f);
+
+	#if !HEADLESS
 	if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
 	{
 		double mouseX, mouseY;
@@ -326,18 +405,44 @@ static void Update(GameState* state, Player* player, World* world, float deltaTi
 
 		glfwSetCursorPos(window, cX, cY);
 
-		Camera* cam = state->camera;
-
-		float rotX = (float)(cX - mouseX) * cam->sensitivity;
-		float rotY = (float)(cY - mouseY) * cam->sensitivity;
-		RotateCamera(cam, rotX, rotY);
+		rotation.x = (float)(cX - mouseX) * cam->sensitivity;
+		rotation.y = (float)(cY - mouseY) * cam->sensitivity;
 	}
+	#endif
+
+	ReplayRotation(state->replay, rotation);
+
+	if (rotation.x != 0.0f || rotation.y != 0.0f)
+		RotateCamera(cam, rotation.x, rotation.y);
 
 	Simulate(state, world, player, deltaTime);
 }
 
-int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
+#if HEADLESS
+
+#include "Benchmark.h"
+#include "Sorting.cpp"
+#include "FlyBench.cpp"
+#include "ReplayBench.cpp"
+#include "WorldGenBench.cpp"
+#include "ContainerBench.cpp"
+#include "WorldBench.cpp"
+#include "Benchmark.cpp"
+
+#else
+
+int WinMain(HINSTANCE, HINSTANCE, LPSTR cmdLine, int)
 {
+	GameState* state = new GameState();
+	Replay& replay = state->replay;
+
+	InitArena(g_frameArena, FRAME_ARENA_SIZE);
+
+	string cmdString(cmdLine);
+	vector<char*> args;
+	Split(cmdString, ' ', args);
+	ParseReplayArgs(replay, args);
+
 	if (!glfwInit())
 		Error("GLFW failed to initialize.\n");
 
@@ -360,19 +465,31 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 	glewExperimental = GL_TRUE;
 
-	glfwSwapInterval(SWAP_INTERVAL);
+	// Replays are played back without vsync so that frame times aren't capped.
+	glfwSwapInterval(replay.mode == REPLAY_PLAYING ? 0 : SWAP_INTERVAL);
 
-	srand((uint32_t)time(0));
-
-	GameState* state = new GameState();
+	if (replay.mode != REPLAY_NONE)
+	{
+		OpenReplay(replay);
+		srand(replay.header.seed);
+	}
+	else srand((uint32_t)time(0));
 
 	RegisterCommand(state, "help", HelpCommand, nullptr);
+
+	#if PIPELINE_STATS
+	RegisterCommand(state, "pipeline", PipelineCommand, nullptr);
+	#endif
+
 	DEBUG_INIT(state, window);
 
 	char savePath[MAX_PATH];
-	state->savePath = PathToExe("Saves", savePath, MAX_PATH);
+	state->savePath = PathToExe(replay.mode == REPLAY_NONE ? "Saves" : "ReplaySaves", savePath, MAX_PATH);
 	CreateDirectory(state->savePath, NULL);
 
+	if (replay.mode != REPLAY_NONE)
+		ClearReplayWorld(state);
+
 	InitUI(window, state->ui);
 	InitAudio(&state->audio);
 	
@@ -397,7 +514,7 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 	WorldConfig worldConfig = {};
 	worldConfig.radius = 1024;
 
-	World* world = NewWorld(state, 8, worldConfig);
+	World* world = NewWorld(state, LOAD_RANGE, worldConfig);
 
 	Player* player = NewPlayer(state);
 	world->player = player;
@@ -407,6 +524,14 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 	SetWindowSize(window, fW, fH);
 
 	LoadGameSettings(state);
+
+	if (replay.mode == REPLAY_PLAYING)
+	{
+		glfwSetWindowSize(window, replay.header.screenWidth, replay.header.screenHeight);
+		StartReplay(state, replay, replay.header.screenWidth, replay.header.screenHeight);
+	}
+	else if (replay.mode == REPLAY_RECORDING)
+		StartReplay(state, replay, fW, fH);
 	
 	double lastTime = glfwGetTime();
 	float deltaTime = 0.0f;
@@ -414,6 +539,8 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 	while (!glfwWindowShouldClose(window))
 	{
 		FRAME_MARKER;
+		ResetFrameArena();
+
 		BEGIN_BLOCK(HANDLE_INPUT);
 
 		ResetInput(state->input);
@@ -421,6 +548,9 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 		END_BLOCK(HANDLE_INPUT);
 
+		if (!ReplayInput(state, replay, deltaTime))
+			break;
+
 		if (!state->minimized)
 		{
 			BEGIN_BLOCK(BEGIN_UI);
@@ -444,6 +574,9 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 		glfwSwapBuffers(window);
 		DEBUG_END_FRAME(state);
+		END_HEAP_FRAME;
+
+		EndReplayFrame(state, replay, deltaTime);
 
 		double endTime = glfwGetTime();
 		deltaTime = Min((float)(endTime - lastTime), 0.0666f);
@@ -452,6 +585,8 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 		lastTime = endTime;
 	}
 
+	FinishReplay(replay);
+
 	SaveWorld(state, world);
 	SaveGameSettings(state);
 
@@ -459,3 +594,5 @@ int WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
 	return 0;
 }
+
+#endif
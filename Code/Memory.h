@@ -0,0 +1,276 @@
+//
+// Gamecraft
+//
+
+// Subsystems that memory is tracked for. Included before the containers and
+// pools so that they can report what they allocate.
+enum MemoryTag
+{
+    MEMORY_GROUPS,
+    MEMORY_REGIONS,
+    MEMORY_MESH_DATA,
+    MEMORY_MESH_INDICES,
+    MEMORY_LIGHT_NODES,
+    MEMORY_RECORDS,
+    MEMORY_GROUP_CACHE,
+    MEMORY_PHYSICS,
+    MEMORY_PARTICLES,
+    MEMORY_DEBUG,
+    MEMORY_ARENAS,
+    MEMORY_OTHER,
+    MEMORY_TAG_COUNT
+};
+
+#if DEBUG_SERVICES
+
+// Each tag's counters are on their own cache line, as they're updated by
+// every thread that allocates.
+struct alignas(64) MemoryTagStats
+{
+    volatile LONG64 bytes, peak;
+    volatile LONG count;
+};
+
+struct MemoryStats
+{
+    MemoryTagStats tags[MEMORY_TAG_COUNT];
+
+    // Budgets in bytes. 0 means the tag has no budget. A message is logged
+    // each time a tag goes over its budget.
+    int64_t budgets[MEMORY_TAG_COUNT];
+    bool overBudget[MEMORY_TAG_COUNT];
+};
+
+static MemoryStats g_memory;
+
+static char* g_memoryTagNames[MEMORY_TAG_COUNT] =
+{
+    "groups", "regions", "meshdata", "meshindices", "lightnodes", "records",
+    "groupcache", "physics", "particles", "debug", "arenas", "other"
+};
+
+// Count is the number of allocations added, which is 0 when an existing
+// allocation grows or shrinks.
+static inline void TrackAlloc(MemoryTag tag, int64_t bytes, int count)
+{
+    MemoryTagStats& stats = g_memory.tags[tag];
+
+    LONG64 total = InterlockedExchangeAdd64(&stats.bytes, bytes) + bytes;
+
+    if (count != 0)
+        InterlockedExchangeAdd(&stats.count, count);
+
+    LONG64 peak = stats.peak;
+
+    while (total > peak)
+    {
+        LONG64 prev = InterlockedCompareExchange64(&stats.peak, total, peak);
+
+        if (prev == peak) break;
+        peak = prev;
+    }
+}
+
+static inline void TrackFree(MemoryTag tag, int64_t bytes)
+{
+    MemoryTagStats& stats = g_memory.tags[tag];
+
+    InterlockedExchangeAdd64(&stats.bytes, -bytes);
+    InterlockedDecrement(&stats.count);
+}
+
+#define TRACK_ALLOC(tag, bytes) TrackAlloc(tag, (int64_t)(bytes), 1)
+#define TRACK_RESIZE(tag, bytes) TrackAlloc(tag, (int64_t)(bytes), 0)
+#define TRACK_FREE(tag, bytes) TrackFree(tag, (int64_t)(bytes))
+
+#else
+
+#define TRACK_ALLOC(tag, bytes)
+#define TRACK_RESIZE(tag, bytes)
+#define TRACK_FREE(tag, bytes)
+
+#endif
+
+struct HeapTraffic
+{
+    int64_t allocs, bytes;
+};
+
+#if HEAP_TRAFFIC
+
+#define MAX_HEAP_THREADS 256
+
+// Allocations made through operator new by one thread. Only the owning thread writes
+// its counters, so counting an allocation takes no locked instructions. Readers add
+// up the counters of every thread.
+struct alignas(64) HeapCounter
+{
+    atomic<int64_t> allocs, bytes;
+};
+
+struct HeapTrafficStats
+{
+    HeapCounter threads[MAX_HEAP_THREADS];
+    atomic<int> threadCount;
+
+    // Shared by the threads beyond MAX_HEAP_THREADS, which add to it atomically.
+    HeapCounter shared;
+
+    // Traffic during the last frame and summed over the frames since the last reset,
+    // on the main thread and on all threads.
+    HeapTraffic mainFrame, allFrame;
+    HeapTraffic mainTotal, allTotal;
+    int frames;
+
+    // Counts as of the end of the last frame.
+    HeapTraffic mainLast, allLast;
+};
+
+static HeapTrafficStats g_heapTraffic;
+static thread_local HeapCounter* g_heapCounter;
+
+static inline void CountHeapAlloc(size_t size)
+{
+    HeapCounter* counter = g_heapCounter;
+
+    if (counter == nullptr)
+    {
+        int index = g_heapTraffic.threadCount++;
+        counter = index < MAX_HEAP_THREADS ? g_heapTraffic.threads + index : &g_heapTraffic.shared;
+        g_heapCounter = counter;
+    }
+
+    if (counter == &g_heapTraffic.shared)
+    {
+        counter->allocs++;
+        counter->bytes += size;
+    }
+    else
+    {
+        counter->allocs.store(counter->allocs.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        counter->bytes.store(counter->bytes.load(memory_order_relaxed) + size, memory_order_relaxed);
+    }
+}
+
+static inline HeapTraffic ReadHeapCounter(HeapCounter& counter)
+{
+    return { counter.allocs.load(memory_order_relaxed), counter.bytes.load(memory_order_relaxed) };
+}
+
+// Traffic on the calling thread since it started.
+static inline HeapTraffic GetThreadHeapTraffic()
+{
+    return g_heapCounter != nullptr ? ReadHeapCounter(*g_heapCounter) : HeapTraffic {};
+}
+
+// Traffic on all threads since the program started. Threads may be counting while
+// this runs, so the total can be slightly behind.
+static HeapTraffic GetHeapTraffic()
+{
+    HeapTraffic total = ReadHeapCounter(g_heapTraffic.shared);
+    int count = Min(g_heapTraffic.threadCount.load(), MAX_HEAP_THREADS);
+
+    for (int i = 0; i < count; i++)
+    {
+        HeapTraffic traffic = ReadHeapCounter(g_heapTraffic.threads[i]);
+        total.allocs += traffic.allocs;
+        total.bytes += traffic.bytes;
+    }
+
+    return total;
+}
+
+// Takes the heap traffic of the frame that just ended. Called on the main thread.
+static void EndHeapFrame()
+{
+    HeapTrafficStats& h = g_heapTraffic;
+
+    HeapTraffic mainNow = GetThreadHeapTraffic();
+    HeapTraffic allNow = GetHeapTraffic();
+
+    h.mainFrame = { mainNow.allocs - h.mainLast.allocs, mainNow.bytes - h.mainLast.bytes };
+    h.allFrame = { allNow.allocs - h.allLast.allocs, allNow.bytes - h.allLast.bytes };
+
+    h.mainTotal.allocs += h.mainFrame.allocs;
+    h.mainTotal.bytes += h.mainFrame.bytes;
+    h.allTotal.allocs += h.allFrame.allocs;
+    h.allTotal.bytes += h.allFrame.bytes;
+    h.frames++;
+
+    h.mainLast = mainNow;
+    h.allLast = allNow;
+}
+
+static void ResetHeapTraffic()
+{
+    g_heapTraffic.mainTotal = {};
+    g_heapTraffic.allTotal = {};
+    g_heapTraffic.frames = 0;
+}
+
+// Every allocation made through operator new is counted, so that heap traffic per
+// frame can be measured. Memory from malloc, such as the lists' items, isn't seen.
+void* operator new(size_t size)
+{
+    CountHeapAlloc(size);
+    return malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// The standard library's temporary buffers are taken with the nothrow form, and
+// must come from the same heap as the memory freed above.
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    CountHeapAlloc(size);
+    return malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+// Types aligned beyond the default, such as the pools' caches, are allocated through these.
+void* operator new(size_t size, align_val_t align)
+{
+    CountHeapAlloc(size);
+    return _aligned_malloc(size > 0 ? size : 1, (size_t)align);
+}
+
+void operator delete(void* ptr, align_val_t) noexcept
+{
+    _aligned_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, align_val_t) noexcept
+{
+    _aligned_free(ptr);
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept
+{
+    CountHeapAlloc(size);
+    return _aligned_malloc(size > 0 ? size : 1, (size_t)align);
+}
+
+void operator delete(void* ptr, align_val_t, const nothrow_t&) noexcept
+{
+    _aligned_free(ptr);
+}
+
+#define END_HEAP_FRAME EndHeapFrame()
+
+#else
+
+#define END_HEAP_FRAME
+
+#endif
@@ -2,7 +2,7 @@
 // Gamecraft
 //
 
-static MeshData* GetMeshData(ObjectPool<MeshData>& pool)
+static MeshData* GetMeshData(SharedObjectPool<MeshData>& pool)
 {
 	MeshData* meshData = pool.Get();
 	meshData->vertCount = 0;
@@ -10,12 +10,13 @@ static MeshData* GetMeshData(ObjectPool<MeshData>& pool)
 	return meshData;
 }
 
-static void ReturnMeshData(ObjectPool<MeshData>& pool, MeshData* data)
+static void ReturnMeshData(SharedObjectPool<MeshData>& pool, MeshData* data)
 {
 	for (int i = 0; i < MESH_TYPE_COUNT; i++)
 	{
 		if (data->indices[i] != nullptr)
 		{
+			TRACK_FREE(MEMORY_MESH_INDICES, sizeof(MeshIndexData));
 			delete data->indices[i];
 			data->indices[i] = nullptr;
 		}
@@ -68,19 +69,98 @@ static inline void SetUVs(MeshData2D* meshData)
     meshData->uvs[3] = u16vec2(1, 1);
 }
 
-static void FillMeshData(ObjectPool<MeshData>& pool, Mesh& mesh, MeshData* meshData, GLenum type)
+static void BeginMeshSection(MeshData* meshData, int section)
 {
-	TIMED_FUNCTION;
-	
-	assert(meshData->vertCount > 0);
+	MeshSection& range = meshData->sections[section];
+	range.vertStart = meshData->vertCount;
 
-	glGenVertexArrays(1, &mesh.va);
-	glBindVertexArray(mesh.va);
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		MeshIndexData* iData = meshData->indices[i];
+		range.indexStart[i] = iData == nullptr ? 0 : iData->count;
+	}
+}
 
-	glGenBuffers(1, &mesh.vertices);
-	glBindBuffer(GL_ARRAY_BUFFER, mesh.vertices);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexInfo) * meshData->vertCount, meshData->vertices, type);
+static void EndMeshSection(MeshData* meshData, int section)
+{
+	MeshSection& range = meshData->sections[section];
+	range.vertEnd = meshData->vertCount;
+
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		MeshIndexData* iData = meshData->indices[i];
+		range.indexEnd[i] = iData == nullptr ? 0 : iData->count;
+	}
+}
+
+static void DestroyMesh(Mesh& mesh)
+{
+	if (!mesh.hasData)
+		return;
+
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		MeshIndices& indices = mesh.indices[i];
+
+		if (indices.count > 0)
+		{
+			#if !HEADLESS
+			glDeleteBuffers(1, &indices.handle);
+			#endif
+			indices.count = 0;
+		}
+	}
+
+	#if !HEADLESS
+	glDeleteBuffers(1, &mesh.vertices);
+	glDeleteVertexArrays(1, &mesh.va);
+	#endif
+
+	memset(mesh.sections, 0, sizeof(mesh.sections));
+	mesh.hasData = false;
+}
 
+static inline int SectionVertCount(MeshSection& section)
+{
+	return section.vertEnd - section.vertStart;
+}
+
+static inline int SectionIndexCount(MeshSection& section, int type)
+{
+	return section.indexEnd[type] - section.indexStart[type];
+}
+
+// Returns true if every built section of the mesh data is the same size as the section 
+// it replaces, in which case the new data can be written over the old ranges.
+static bool SectionsFitMesh(Mesh& mesh, MeshData* meshData, int built)
+{
+	if (!mesh.hasData)
+		return false;
+
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+	{
+		if (!HasFlag(built, 1 << s))
+			continue;
+
+		MeshSection& prev = mesh.sections[s];
+		MeshSection& next = meshData->sections[s];
+
+		if (SectionVertCount(prev) != SectionVertCount(next))
+			return false;
+
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			if (SectionIndexCount(prev, i) != SectionIndexCount(next, i))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static void SetVertexAttributes()
+{
+	#if !HEADLESS
 	// Vertex positions.
 	glVertexAttribPointer(0, 3, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(VertexInfo), NULL);
 	glEnableVertexAttribArray(0);
@@ -102,35 +182,206 @@ static void FillMeshData(ObjectPool<MeshData>& pool, Mesh& mesh, MeshData* meshD
 	// Vertex alpha.
 	glVertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VertexInfo), (GLvoid*)size);
 	glEnableVertexAttribArray(3);
+	#endif
+}
 
-	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+// Writes the built sections of the mesh data into the ranges they already occupy.
+static void RewriteMeshSections(Mesh& mesh, MeshData* meshData, int built)
+{
+	#if !HEADLESS
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
 	{
-		MeshIndexData* iData = meshData->indices[i];
+		if (!HasFlag(built, 1 << s))
+			continue;
+
+		MeshSection& dst = mesh.sections[s];
+		MeshSection& src = meshData->sections[s];
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vertices);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(VertexInfo) * dst.vertStart, 
+			sizeof(VertexInfo) * SectionVertCount(src), meshData->vertices + src.vertStart);
+
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			int count = SectionIndexCount(src, i);
+
+			if (count > 0)
+			{
+				glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.indices[i].handle);
+				glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(uint16_t) * dst.indexStart[i], 
+					sizeof(uint16_t) * count, meshData->indices[i]->data + src.indexStart[i]);
+			}
+		}
+	}
+	#else
+	Unused(mesh);
+	Unused(meshData);
+	Unused(built);
+	#endif
+}
+
+// Creates new buffers holding the built sections of the mesh data and the sections of the 
+// mesh that weren't built, which are copied from the old buffers. The sections are laid 
+// out in order, so a section that changed size moves the sections after it.
+static void RebuildMeshBuffers(Mesh& mesh, MeshData* meshData, int built, GLenum type)
+{
+	Mesh prev = mesh;
+
+	int vertCount = 0;
+	int indexCount[MESH_TYPE_COUNT] = {};
+
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+	{
+		// Sections that were never filled are empty.
+		MeshSection empty = {};
+		MeshSection& src = HasFlag(built, 1 << s) ? meshData->sections[s] : (prev.hasData ? prev.sections[s] : empty);
+		MeshSection& dst = mesh.sections[s];
 
-		if (iData == nullptr)
+		dst.vertStart = vertCount;
+		vertCount += SectionVertCount(src);
+		dst.vertEnd = vertCount;
+
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			dst.indexStart[i] = indexCount[i];
+			indexCount[i] += SectionIndexCount(src, i);
+			dst.indexEnd[i] = indexCount[i];
+		}
+	}
+
+	// The vertex count would be 0 if the mesh is empty or all its blocks were culled away.
+	if (vertCount == 0)
+	{
+		DestroyMesh(mesh);
+		return;
+	}
+
+	// Headless builds have no GL context. The section layout above is still kept, so only
+	// the upload itself is skipped.
+	#if !HEADLESS
+	if (!prev.hasData)
+		glGenVertexArrays(1, &mesh.va);
+
+	glBindVertexArray(mesh.va);
+
+	glGenBuffers(1, &mesh.vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.vertices);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexInfo) * vertCount, NULL, type);
+	SetVertexAttributes();
+
+	if (prev.hasData)
+		glBindBuffer(GL_COPY_READ_BUFFER, prev.vertices);
+
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+	{
+		MeshSection& dst = mesh.sections[s];
+		int count = SectionVertCount(dst);
+
+		if (count == 0)
 			continue;
 
-		if (iData->count > 0)
+		if (HasFlag(built, 1 << s))
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, sizeof(VertexInfo) * dst.vertStart, sizeof(VertexInfo) * count, 
+				meshData->vertices + meshData->sections[s].vertStart);
+		}
+		else 
 		{
-			MeshIndices& indices = mesh.indices[i];
-			assert(indices.count == 0);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, sizeof(VertexInfo) * prev.sections[s].vertStart, 
+				sizeof(VertexInfo) * dst.vertStart, sizeof(VertexInfo) * count);
+		}
+	}
 
-			// Index buffer.
-			glGenBuffers(1, &indices.handle);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.handle);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * iData->count, iData->data, type);
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		MeshIndices& indices = mesh.indices[i];
+		MeshIndices& prevIndices = prev.indices[i];
 
-			indices.count = iData->count;
-			assert(indices.count > 0);
+		if (indexCount[i] > 0)
+		{
+			// The element array binding belongs to the vertex array, so the index buffers 
+			// are filled through the copy target and bound when drawn.
+			glGenBuffers(1, &indices.handle);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, indices.handle);
+			glBufferData(GL_COPY_WRITE_BUFFER, sizeof(uint16_t) * indexCount[i], NULL, type);
+
+			if (prevIndices.count > 0)
+				glBindBuffer(GL_COPY_READ_BUFFER, prevIndices.handle);
+
+			for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+			{
+				MeshSection& dst = mesh.sections[s];
+				int count = SectionIndexCount(dst, i);
+
+				if (count == 0)
+					continue;
+
+				if (HasFlag(built, 1 << s))
+				{
+					glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(uint16_t) * dst.indexStart[i], sizeof(uint16_t) * count, 
+						meshData->indices[i]->data + meshData->sections[s].indexStart[i]);
+				}
+				else 
+				{
+					glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(uint16_t) * prev.sections[s].indexStart[i], 
+						sizeof(uint16_t) * dst.indexStart[i], sizeof(uint16_t) * count);
+				}
+			}
 		}
+
+		if (prevIndices.count > 0)
+			glDeleteBuffers(1, &prevIndices.handle);
 	}
 
+	if (prev.hasData)
+		glDeleteBuffers(1, &prev.vertices);
+	#else
+	Unused(type);
+	#endif
+
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		mesh.indices[i].count = indexCount[i];
+
 	mesh.hasData = true;
-	ReturnMeshData(pool, meshData);
+}
+
+// Uploads the built sections of the mesh data into the mesh. Sections that weren't built 
+// keep their data. The mesh data is not returned to the pool.
+static void FillMeshSections(Mesh& mesh, MeshData* meshData, int built, GLenum type)
+{
+	TIMED_FUNCTION;
+
+	// Indices refer to the vertices of the whole mesh data, so they must be rebased 
+	// to the start of their section's vertices.
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+	{
+		if (!HasFlag(built, 1 << s))
+			continue;
+
+		MeshSection& range = meshData->sections[s];
+		uint16_t offset = (uint16_t)range.vertStart;
+
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			MeshIndexData* iData = meshData->indices[i];
+
+			if (iData == nullptr)
+				continue;
+
+			for (int j = range.indexStart[i]; j < range.indexEnd[i]; j++)
+				iData->data[j] -= offset;
+		}
+	}
+
+	// An edit that doesn't change the size of its sections only rewrites their ranges.
+	if (SectionsFitMesh(mesh, meshData, built))
+		RewriteMeshSections(mesh, meshData, built);
+	else RebuildMeshBuffers(mesh, meshData, built, type);
 }
 
 static void FillMeshData(ObjectPool<MeshData2D>& pool, Mesh2D& mesh, MeshData2D* meshData, GLenum type, int32_t flags)
 {
+	#if !HEADLESS
 	glGenVertexArrays(1, &mesh.va);
 	glBindVertexArray(mesh.va);
 
@@ -164,21 +415,45 @@ static void FillMeshData(ObjectPool<MeshData2D>& pool, Mesh2D& mesh, MeshData2D*
 	glGenBuffers(1, &mesh.indices);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * 6, meshData->indices, type);
+	#else
+	Unused(type);
+	#endif
 
 	mesh.flags = flags;
 	pool.Return(meshData);
 }
 
-static inline void DrawMesh(Mesh mesh, int index)
+// Draws every section of the mesh with indices of the given type in a single call.
+static inline void DrawMesh(Mesh& mesh, int index)
 {
 	MeshIndices indices = mesh.indices[index];
 	assert(indices.count > 0);
+
+	GLsizei counts[MAX_MESH_SECTIONS];
+	const GLvoid* offsets[MAX_MESH_SECTIONS];
+	GLint baseVertices[MAX_MESH_SECTIONS];
+	int drawCount = 0;
+
+	for (int s = 0; s < MAX_MESH_SECTIONS; s++)
+	{
+		MeshSection& section = mesh.sections[s];
+		int count = SectionIndexCount(section, index);
+
+		if (count == 0)
+			continue;
+
+		counts[drawCount] = count;
+		offsets[drawCount] = (GLvoid*)(sizeof(uint16_t) * section.indexStart[index]);
+		baseVertices[drawCount] = section.vertStart;
+		drawCount++;
+	}
+
 	glBindVertexArray(mesh.va);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.handle);
-	glDrawElements(GL_TRIANGLES, indices.count, GL_UNSIGNED_SHORT, 0);
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, drawCount, baseVertices);
 }
 
-static inline void DrawMesh(Mesh mesh, Shader* shader, vec3 pos, int index)
+static inline void DrawMesh(Mesh& mesh, Shader* shader, vec3 pos, int index)
 {
 	mat4 model = translate(mat4(1.0f), pos);
 	SetUniform(shader->model, model);
@@ -198,28 +473,6 @@ static inline void DrawMesh(Mesh2D mesh, Shader* shader, vec3 pos)
 	DrawMesh(mesh);
 }
 
-static void DestroyMesh(Mesh& mesh)
-{
-	if (!mesh.hasData)
-		return;
-
-	for (int i = 0; i < MESH_TYPE_COUNT; i++)
-	{
-		MeshIndices& indices = mesh.indices[i];
-
-		if (indices.count > 0)
-		{
-			glDeleteBuffers(1, &indices.handle);
-			indices.count = 0;
-		}
-	}
-
-	glDeleteBuffers(1, &mesh.vertices);
-	glDeleteVertexArrays(1, &mesh.va);
-
-	mesh.hasData = false;
-}
-
 static void DestroyMesh(Mesh2D& mesh)
 {
 	glDeleteBuffers(1, &mesh.positions);
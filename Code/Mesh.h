@@ -5,6 +5,9 @@
 #define MAX_VERTICES 40000
 #define MAX_INDICES 60000
 
+// Maximum number of sections mesh data can be divided into.
+#define MAX_MESH_SECTIONS 4
+
 enum BlockMeshType
 {
     MESH_OPAQUE,
@@ -21,13 +24,6 @@ struct MeshIndices
     int count;
 };
 
-struct Mesh
-{
-    GLuint va, vertices;
-    MeshIndices indices[MESH_TYPE_COUNT];
-    bool hasData;
-};
-
 struct MeshIndexData
 {
     uint16_t data[MAX_INDICES];
@@ -43,12 +39,33 @@ struct VertexInfo
     uint8_t reserved;
 };
 
+// The range of vertices and indices belonging to one section of the mesh data.
+// Sections are built one after another, so each section's data is contiguous.
+struct MeshSection
+{
+    int vertStart, vertEnd;
+    int indexStart[MESH_TYPE_COUNT], indexEnd[MESH_TYPE_COUNT];
+};
+
+// A mesh holds all of its sections in one vertex buffer and one index buffer per mesh type.
+// Each section's indices are relative to its first vertex, so a section's data can move 
+// within the buffers without its indices being rewritten.
+struct Mesh
+{
+    GLuint va, vertices;
+    MeshIndices indices[MESH_TYPE_COUNT];
+    MeshSection sections[MAX_MESH_SECTIONS];
+    bool hasData;
+};
+
 struct MeshData
 {
     VertexInfo vertices[MAX_VERTICES];
     MeshIndexData* indices[MESH_TYPE_COUNT];
 
     int vertCount;
+
+    MeshSection sections[MAX_MESH_SECTIONS];
 };
 
 enum MeshFlags
@@ -6,13 +6,17 @@ template <typename T>
 struct ObjectPool
 {
 	queue<T*> items;
+	MemoryTag tag = MEMORY_OTHER;
 
 	T* Get()
 	{
 		T* item;
 
 		if (items.empty())
+		{
 			item = new T();
+			TRACK_ALLOC(tag, sizeof(T));
+		}
 		else
 		{
 			item = items.front();
@@ -28,28 +32,305 @@ struct ObjectPool
 	}
 };
 
+#define POOL_MAGAZINE_SIZE 32
+#define MAX_POOL_THREADS 64
+
+// Cache indices given back by threads that have exited, so that their caches are
+// reused by new threads. A new thread takes over the magazines left in the cache.
+static SRWLOCK g_poolThreadLock = SRWLOCK_INIT;
+static int g_freePoolThreads[MAX_POOL_THREADS];
+static int g_freePoolThreadCount;
+static int g_poolThreadCount;
+
+// Index of the calling thread's cache in every shared pool, assigned on first use
+// and given back when the thread exits.
+struct PoolThread
+{
+	int index = -1;
+
+	~PoolThread()
+	{
+		if (index < 0 || index >= MAX_POOL_THREADS)
+			return;
+
+		AcquireSRWLockExclusive(&g_poolThreadLock);
+		g_freePoolThreads[g_freePoolThreadCount++] = index;
+		ReleaseSRWLockExclusive(&g_poolThreadLock);
+	}
+};
+
+static thread_local PoolThread g_poolThread;
+
+// Returns MAX_POOL_THREADS or more while every cache is held by a live thread.
+static inline int GetPoolThread()
+{
+	if (g_poolThread.index < 0)
+	{
+		AcquireSRWLockExclusive(&g_poolThreadLock);
+
+		if (g_freePoolThreadCount > 0)
+			g_poolThread.index = g_freePoolThreads[--g_freePoolThreadCount];
+		else if (g_poolThreadCount < MAX_POOL_THREADS)
+			g_poolThread.index = g_poolThreadCount++;
+
+		ReleaseSRWLockExclusive(&g_poolThreadLock);
+
+		// The thread tries again the next time it uses a pool.
+		if (g_poolThread.index < 0)
+			return MAX_POOL_THREADS;
+	}
+
+	return g_poolThread.index;
+}
+
 template <typename T>
-struct LockedObjectPool : public ObjectPool<T>
+struct PoolMagazine
 {
-	CRITICAL_SECTION cs;
+	T* items[POOL_MAGAZINE_SIZE];
+	int count;
+};
 
-	LockedObjectPool()
+// A thread's two magazines. Each is always either full or empty, except for the loaded one.
+// Aligned so that threads don't share cache lines.
+template <typename T>
+struct alignas(64) PoolCache
+{
+	PoolMagazine<T>* loaded;
+	PoolMagazine<T>* previous;
+
+	// Written only by the owning thread.
+	int64_t gets, allocs;
+};
+
+struct PoolStats
+{
+	int64_t gets, allocs, destroyed;
+
+	// Magazines exchanged with the depot, and the times the depot lock was already held.
+	int64_t exchanges, contended;
+};
+
+// Object pool that can be used from any thread. Each thread gets and returns items
+// through its own pair of magazines, and only locks the shared depot to trade a full
+// or empty magazine, which happens at most once per POOL_MAGAZINE_SIZE operations.
+// The depot keeps at most maxMagazines full magazines. Items returned beyond that are
+// freed, so a burst of returns doesn't keep its memory forever. While more than
+// MAX_POOL_THREADS threads are using pools at once, the extra threads bypass the
+// pool and allocate and free their items directly.
+template <typename T>
+struct SharedObjectPool
+{
+	PoolCache<T> caches[MAX_POOL_THREADS];
+
+	SRWLOCK lock;
+	vector<PoolMagazine<T>*> full, empty;
+	int maxMagazines = 16;
+
+	// Optional. Called when an item is first allocated and before it's freed. Items
+	// are otherwise returned to callers as they were when they were returned to the pool.
+	void (*create)(T* item) = nullptr;
+	void (*destroy)(T* item) = nullptr;
+
+	MemoryTag tag = MEMORY_OTHER;
+
+	// Written while the depot is locked.
+	int64_t destroyed, exchanges, contended;
+
+	SharedObjectPool()
 	{
-		InitializeCriticalSection(&cs);
+		memset(caches, 0, sizeof(caches));
+		InitializeSRWLock(&lock);
+		destroyed = 0;
+		exchanges = 0;
+		contended = 0;
 	}
 
-	T* Get()
+	void LockDepot()
+	{
+		if (!TryAcquireSRWLockExclusive(&lock))
+		{
+			AcquireSRWLockExclusive(&lock);
+			contended++;
+		}
+	}
+
+	T* NewItem()
 	{
-		EnterCriticalSection(&cs);
-		T* item = ObjectPool::Get();
-		LeaveCriticalSection(&cs);
+		T* item = new T();
+		TRACK_ALLOC(tag, sizeof(T));
+
+		if (create != nullptr)
+			create(item);
+
 		return item;
 	}
 
+	void DestroyItem(T* item)
+	{
+		if (destroy != nullptr)
+			destroy(item);
+
+		TRACK_FREE(tag, sizeof(T));
+		delete item;
+	}
+
+	PoolCache<T>* GetCache()
+	{
+		int thread = GetPoolThread();
+
+		if (thread >= MAX_POOL_THREADS)
+			return nullptr;
+
+		PoolCache<T>* cache = caches + thread;
+
+		if (cache->loaded == nullptr)
+		{
+			cache->loaded = new PoolMagazine<T>();
+			cache->previous = new PoolMagazine<T>();
+		}
+
+		return cache;
+	}
+
+	T* Get()
+	{
+		PoolCache<T>* cache = GetCache();
+
+		if (cache == nullptr)
+			return NewItem();
+
+		cache->gets++;
+
+		if (cache->loaded->count == 0)
+		{
+			if (cache->previous->count > 0)
+				swap(cache->loaded, cache->previous);
+			else
+			{
+				LockDepot();
+
+				// Both magazines are empty. One is traded for a full magazine from the depot.
+				if (!full.empty())
+				{
+					empty.push_back(cache->previous);
+					cache->previous = cache->loaded;
+					cache->loaded = full.back();
+					full.pop_back();
+					exchanges++;
+				}
+
+				ReleaseSRWLockExclusive(&lock);
+			}
+		}
+
+		PoolMagazine<T>* mag = cache->loaded;
+
+		if (mag->count > 0)
+			return mag->items[--mag->count];
+
+		cache->allocs++;
+		return NewItem();
+	}
+
 	void Return(T* item)
 	{
-		EnterCriticalSection(&cs);
-		ObjectPool::Return(item);
-		LeaveCriticalSection(&cs);
+		PoolCache<T>* cache = GetCache();
+
+		if (cache == nullptr)
+		{
+			DestroyItem(item);
+			return;
+		}
+
+		if (cache->loaded->count == POOL_MAGAZINE_SIZE)
+		{
+			if (cache->previous->count == 0)
+				swap(cache->loaded, cache->previous);
+			else
+			{
+				LockDepot();
+
+				// Both magazines are full. One is given to the depot if it has room.
+				bool stored = (int)full.size() < maxMagazines;
+
+				if (stored)
+				{
+					full.push_back(cache->previous);
+					cache->previous = cache->loaded;
+
+					if (empty.empty())
+						cache->loaded = new PoolMagazine<T>();
+					else
+					{
+						cache->loaded = empty.back();
+						empty.pop_back();
+					}
+
+					exchanges++;
+				}
+				else destroyed++;
+
+				ReleaseSRWLockExclusive(&lock);
+
+				if (!stored)
+				{
+					DestroyItem(item);
+					return;
+				}
+			}
+		}
+
+		PoolMagazine<T>* mag = cache->loaded;
+		mag->items[mag->count++] = item;
+	}
+
+	// The counts are read without synchronization, so they may be slightly out of
+	// date while other threads use the pool.
+	PoolStats GetStats()
+	{
+		PoolStats stats = {};
+
+		for (int i = 0; i < MAX_POOL_THREADS; i++)
+		{
+			stats.gets += caches[i].gets;
+			stats.allocs += caches[i].allocs;
+		}
+
+		stats.destroyed = destroyed;
+		stats.exchanges = exchanges;
+		stats.contended = contended;
+
+		return stats;
+	}
+
+	// Frees every pooled item. No other thread may be using the pool.
+	void Free()
+	{
+		for (int i = 0; i < MAX_POOL_THREADS; i++)
+		{
+			PoolCache<T>& cache = caches[i];
+
+			if (cache.loaded != nullptr)
+			{
+				full.push_back(cache.loaded);
+				full.push_back(cache.previous);
+			}
+
+			memset(&cache, 0, sizeof(cache));
+		}
+
+		for (PoolMagazine<T>* mag : full)
+		{
+			for (int i = 0; i < mag->count; i++)
+				DestroyItem(mag->items[i]);
+
+			delete mag;
+		}
+
+		for (PoolMagazine<T>* mag : empty)
+			delete mag;
+
+		full.clear();
+		empty.clear();
 	}
 };
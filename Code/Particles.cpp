@@ -11,7 +11,19 @@ static void InitParticleEmitter(Renderer& rend, ParticleEmitter& emitter, ImageI
 	emitter.image = image;
 
 	emitter.maxParticles = maxParticles;
-	emitter.particles = new Particle[maxParticles];
+
+	int capacity = (maxParticles + 7) & ~7;
+	float* arrays = (float*)_mm_malloc(sizeof(float) * capacity * 7, 32);
+	memset(arrays, 0, sizeof(float) * capacity * 7);
+	TRACK_ALLOC(MEMORY_PARTICLES, sizeof(float) * capacity * 7);
+
+	emitter.posX = arrays;
+	emitter.posY = arrays + capacity;
+	emitter.posZ = arrays + capacity * 2;
+	emitter.velX = arrays + capacity * 3;
+	emitter.velY = arrays + capacity * 4;
+	emitter.velZ = arrays + capacity * 5;
+	emitter.timeLeft = arrays + capacity * 6;
 
 	MeshData2D* data = GetMeshData(rend.meshData2D);
 	assert(data != nullptr);
@@ -29,6 +41,7 @@ static void InitParticleEmitter(Renderer& rend, ParticleEmitter& emitter, ImageI
 
 	FillMeshData(rend.meshData2D, emitter.mesh, data, GL_STREAM_DRAW, MESH_NO_COLORS);
 
+	#if !HEADLESS
 	glGenBuffers(1, &emitter.modelBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, emitter.modelBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(mat4) * emitter.maxParticles, NULL, GL_STREAM_DRAW);
@@ -40,125 +53,168 @@ static void InitParticleEmitter(Renderer& rend, ParticleEmitter& emitter, ImageI
 		glEnableVertexAttribArray(2 + i);
 		glVertexAttribDivisor(2 + i, 1);
 	}
+	#endif
 }
 
 static inline void DestroyParticle(ParticleEmitter& emitter, int index)
 {
-	emitter.particles[index] = emitter.particles[emitter.count - 1];
-	emitter.count--;
+	int last = --emitter.count;
+
+	emitter.posX[index] = emitter.posX[last];
+	emitter.posY[index] = emitter.posY[last];
+	emitter.posZ[index] = emitter.posZ[last];
+	emitter.velX[index] = emitter.velX[last];
+	emitter.velY[index] = emitter.velY[last];
+	emitter.velZ[index] = emitter.velZ[last];
+	emitter.timeLeft[index] = emitter.timeLeft[last];
 }
 
 static void DestroyAllParticles(ParticleEmitter& emitter)
 {
-	for (int i = emitter.count - 1; i >= 0; i--)
-		DestroyParticle(emitter, i);
+	emitter.count = 0;
 }
 
 static void SpawnParticles(ParticleEmitter& emitter, vec3 accel, vec3 velocity, float deltaTime)
 {
 	emitter.timer -= deltaTime;
+	emitter.accel = accel;
 
 	if (emitter.active && emitter.timer <= 0.0f)
 	{
-		for (int i = 0; i < emitter.spawnCount; i++)
+		for (int i = 0; i < emitter.spawnCount && emitter.count < emitter.maxParticles; i++)
 		{
-			float x = RandRange(-emitter.radius, emitter.radius);
-			float z = RandRange(-emitter.radius, emitter.radius);
-
-			Particle particle;
-			particle.pos = vec3(x, emitter.pos.y, z);
-			particle.wPos = vec3(emitter.pos.x + x, particle.pos.y, emitter.pos.z + z);
-			particle.accel = accel;
-			particle.velocity = velocity;
-			particle.timeLeft = emitter.lifetime;
-			emitter.particles[emitter.count++] = particle;
-
-			// TODO: Once we've finalized the max particle amounts, turn this into a
-			// condition that simply prevents a particle from spawning if there are too many.
-			assert(emitter.count < emitter.maxParticles);
+			int index = emitter.count++;
+
+			emitter.posX[index] = RandRange(-emitter.radius, emitter.radius);
+			emitter.posY[index] = emitter.pos.y;
+			emitter.posZ[index] = RandRange(-emitter.radius, emitter.radius);
+			emitter.velX[index] = velocity.x;
+			emitter.velY[index] = velocity.y;
+			emitter.velZ[index] = velocity.z;
+			emitter.timeLeft[index] = emitter.lifetime;
 		}
 
 		emitter.timer = emitter.timePerSpawn;
 	}
 }
 
-static inline void MoveParticleLocal(Particle& particle, vec3 emitterP, float deltaTime)
+// Moves all particles under the emitter's acceleration and counts down their lifetimes.
+// Padding at the end of the arrays is moved along with them and never read.
+static void IntegrateParticles(ParticleEmitter& emitter, float deltaTime)
 {
-	vec3 delta = particle.accel * 0.5f * Square(deltaTime) + particle.velocity * deltaTime;
-	particle.velocity = particle.accel * deltaTime + particle.velocity;
-	particle.pos += delta;
-	particle.wPos = vec3(emitterP.x + particle.pos.x, particle.pos.y, emitterP.z + particle.pos.z);
+	vec3 accel = emitter.accel;
+	float halfDt2 = 0.5f * Square(deltaTime);
+
+	__m256 dt = _mm256_set1_ps(deltaTime);
+
+	__m256 accelDeltaX = _mm256_set1_ps(accel.x * halfDt2);
+	__m256 accelDeltaY = _mm256_set1_ps(accel.y * halfDt2);
+	__m256 accelDeltaZ = _mm256_set1_ps(accel.z * halfDt2);
+
+	__m256 velDeltaX = _mm256_set1_ps(accel.x * deltaTime);
+	__m256 velDeltaY = _mm256_set1_ps(accel.y * deltaTime);
+	__m256 velDeltaZ = _mm256_set1_ps(accel.z * deltaTime);
+
+	for (int i = 0; i < emitter.count; i += 8)
+	{
+		__m256 velX = _mm256_load_ps(emitter.velX + i);
+		__m256 velY = _mm256_load_ps(emitter.velY + i);
+		__m256 velZ = _mm256_load_ps(emitter.velZ + i);
+
+		__m256 posX = _mm256_add_ps(_mm256_load_ps(emitter.posX + i), _mm256_fmadd_ps(velX, dt, accelDeltaX));
+		__m256 posY = _mm256_add_ps(_mm256_load_ps(emitter.posY + i), _mm256_fmadd_ps(velY, dt, accelDeltaY));
+		__m256 posZ = _mm256_add_ps(_mm256_load_ps(emitter.posZ + i), _mm256_fmadd_ps(velZ, dt, accelDeltaZ));
+
+		_mm256_store_ps(emitter.posX + i, posX);
+		_mm256_store_ps(emitter.posY + i, posY);
+		_mm256_store_ps(emitter.posZ + i, posZ);
+
+		_mm256_store_ps(emitter.velX + i, _mm256_add_ps(velX, velDeltaX));
+		_mm256_store_ps(emitter.velY + i, _mm256_add_ps(velY, velDeltaY));
+		_mm256_store_ps(emitter.velZ + i, _mm256_add_ps(velZ, velDeltaZ));
+
+		_mm256_store_ps(emitter.timeLeft + i, _mm256_sub_ps(_mm256_load_ps(emitter.timeLeft + i), dt));
+	}
 }
 
-static inline bool ShouldDestroyParticle(World* world, Particle& particle)
+// Returns true if the particle is inside a solid block. Blocks at or above the 
+// column's surface are air, so the block itself is only read below the surface.
+static inline bool ParticleInsideBlock(World* world, ChunkGroup*& group, LChunkP& groupP, LWorldP p)
 {
-	if (particle.timeLeft <= 0.0f)
-		return true;
+	if (p.y >= WORLD_BLOCK_HEIGHT || !BlockInsideWorldH(world, p.x, p.z))
+		return false;
 
-	Block block = GetBlock(world, BlockPos(particle.wPos));
-	
-	if (!IsPassable(world, block))
+	if (p.y < 0)
 		return true;
 
-	return false;
+	LChunkP lcP = LWorldToLChunkP(p.x, 0, p.z);
+
+	if (group == nullptr || lcP != groupP)
+	{
+		group = GetGroup(world, lcP.x, lcP.z);
+		groupP = lcP;
+	}
+
+	if (group == nullptr || group->state == GROUP_DEFAULT)
+		return false;
+
+	RelP rel = LWorldToRelP(p.x, p.y, p.z);
+
+	if (p.y >= group->surface[rel.z * CHUNK_SIZE_H + rel.x])
+		return false;
+
+	return !IsPassable(world, GetBlock(GetChunk(group, p.y >> CHUNK_V_BITS), rel));
 }
 
-static void UpdateRainParticles(ParticleEmitter& emitter, World* world, float deltaTime)
+static void UpdateParticles(ParticleEmitter& emitter, World* world, float deltaTime)
 {
-	SpawnParticles(emitter, vec3(0.0f, -15.0f, 0.0f), vec3(0.0f), deltaTime);
+	TIMED_FUNCTION;
+
+	IntegrateParticles(emitter, deltaTime);
+
+	ChunkGroup* group = nullptr;
+	LChunkP groupP = ivec3(0);
 
 	for (int i = emitter.count - 1; i >= 0; i--)
 	{
-		Particle& particle = emitter.particles[i];
-		particle.timeLeft -= deltaTime;
-
-		if (ShouldDestroyParticle(world, particle))
+		if (emitter.timeLeft[i] <= 0.0f)
 		{
 			DestroyParticle(emitter, i);
 			continue;
 		}
 
-		MoveParticleLocal(particle, emitter.pos, deltaTime);
+		vec3 wPos = vec3(emitter.pos.x + emitter.posX[i], emitter.posY[i], emitter.pos.z + emitter.posZ[i]);
+
+		if (ParticleInsideBlock(world, group, groupP, BlockPos(wPos)))
+			DestroyParticle(emitter, i);
 	}
 }
 
+static void UpdateRainParticles(ParticleEmitter& emitter, World* world, float deltaTime)
+{
+	SpawnParticles(emitter, vec3(0.0f, -15.0f, 0.0f), vec3(0.0f), deltaTime);
+	UpdateParticles(emitter, world, deltaTime);
+}
+
 static void UpdateSnowParticles(ParticleEmitter& emitter, World* world, float deltaTime)
 {
 	SpawnParticles(emitter, vec3(0.0f), vec3(RandNormal() * 5.0f, -20.0f, RandNormal() * 5.0f), deltaTime);
-
-	for (int i = emitter.count - 1; i >= 0; i--)
-	{
-		Particle& particle = emitter.particles[i];
-		particle.timeLeft -= deltaTime;
-
-		if (ShouldDestroyParticle(world, particle))
-		{
-			DestroyParticle(emitter, i);
-			continue;
-		}
-
-		particle.pos += (particle.velocity * deltaTime);
-		particle.wPos = vec3(emitter.pos.x + particle.pos.x, particle.pos.y, emitter.pos.z + particle.pos.z);
-	}
+	UpdateParticles(emitter, world, deltaTime);
 }
 
 static void UpdateAshParticles(ParticleEmitter& emitter, World* world, float deltaTime)
 {
 	SpawnParticles(emitter, vec3(0.0f), vec3(RandNormal() * 5.0f, -10.0f, RandNormal() * 5.0f), deltaTime);
+	UpdateParticles(emitter, world, deltaTime);
+}
 
-	for (int i = emitter.count - 1; i >= 0; i--)
+// Writes the model matrix of each particle, which the particle shader reads per instance.
+static void BuildParticleMatrices(ParticleEmitter& emitter, mat4* matrices)
+{
+	for (int i = 0; i < emitter.count; i++)
 	{
-		Particle& particle = emitter.particles[i];
-		particle.timeLeft -= deltaTime;
-
-		if (ShouldDestroyParticle(world, particle))
-		{
-			DestroyParticle(emitter, i);
-			continue;
-		}
-
-		particle.pos += (particle.velocity * deltaTime);
-		particle.wPos = vec3(emitter.pos.x + particle.pos.x, particle.pos.y, emitter.pos.z + particle.pos.z);
+		vec3 wPos = vec3(emitter.pos.x + emitter.posX[i], emitter.posY[i], emitter.pos.z + emitter.posZ[i]);
+		matrices[i] = translate(mat4(1.0f), wPos);
 	}
 }
 
@@ -171,11 +227,7 @@ static void DrawParticles(GameState* state, ParticleEmitter& emitter, Camera* ca
 	glBindBuffer(GL_ARRAY_BUFFER, emitter.modelBuffer);
 	mat4* matrices = (mat4*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
 
-	for (int i = 0; i < emitter.count; i++)
-	{
-		Particle& particle = emitter.particles[i];
-		matrices[i] = translate(mat4(1.0f), particle.wPos);
-	}
+	BuildParticleMatrices(emitter, matrices);
 
 	glUnmapBuffer(GL_ARRAY_BUFFER);
 
@@ -6,18 +6,21 @@ struct ParticleEmitter;
 
 using ParticleFunc = void(*)(ParticleEmitter& emitter, World* world, float deltaTime);
 
-struct Particle
-{
-	vec3 pos, wPos;
-	vec3 accel, velocity;
-	float timeLeft;
-};
-
 struct ParticleEmitter
 {
 	bool active;
 	vec3 pos;
-	Particle* particles;
+
+	// Particle state is stored as one array per component so that particles can 
+	// be moved eight at a time. Positions are relative to the emitter along x and z.
+	// The arrays are padded to a multiple of eight.
+	float* posX, *posY, *posZ;
+	float* velX, *velY, *velZ;
+	float* timeLeft;
+
+	// Acceleration applied to all particles.
+	vec3 accel;
+
 	int count, spawnCount;
 	int maxParticles;
 	float lifetime, timePerSpawn, timer;
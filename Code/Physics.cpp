@@ -0,0 +1,389 @@
+//
+// Gamecraft
+//
+
+static PhysicsWorld* NewPhysicsWorld()
+{
+	PhysicsWorld* physics = new PhysicsWorld();
+
+	physics->pos = new vec3[MAX_PHYSICS_BODIES];
+	physics->velocity = new vec3[MAX_PHYSICS_BODIES];
+	physics->radius = new vec3[MAX_PHYSICS_BODIES];
+	physics->colFlags = new uint8_t[MAX_PHYSICS_BODIES];
+	physics->bounds = new MinMaxAABB[MAX_PHYSICS_BODIES];
+	physics->islandParent = new int[MAX_PHYSICS_BODIES];
+
+	TRACK_ALLOC(MEMORY_PHYSICS, sizeof(PhysicsWorld) + MAX_PHYSICS_BODIES * (sizeof(vec3) * 3 + sizeof(uint8_t) 
+		+ sizeof(MinMaxAABB) + sizeof(int)));
+
+	return physics;
+}
+
+// Returns the new body, or -1 if the physics world is full.
+static int AddBody(PhysicsWorld& physics, vec3 pos, vec3 size)
+{
+	if (physics.count == MAX_PHYSICS_BODIES)
+		return -1;
+
+	int body = physics.count++;
+
+	physics.pos[body] = pos;
+	physics.velocity[body] = vec3(0.0f);
+	physics.radius[body] = size * 0.5f;
+	physics.colFlags[body] = HIT_NONE;
+
+	return body;
+}
+
+static inline void RemoveBody(PhysicsWorld& physics, int body)
+{
+	int last = --physics.count;
+
+	physics.pos[body] = physics.pos[last];
+	physics.velocity[body] = physics.velocity[last];
+	physics.radius[body] = physics.radius[last];
+	physics.colFlags[body] = physics.colFlags[last];
+}
+
+static void ClearBodies(PhysicsWorld& physics)
+{
+	physics.count = 0;
+}
+
+// Keeps bodies in place when the world shifts around the player.
+static void ShiftBodies(PhysicsWorld& physics, vec3 offset)
+{
+	for (int i = 0; i < physics.count; i++)
+		physics.pos[i] += offset;
+}
+
+static inline uint32_t PhysicsCellHash(int x, int y, int z)
+{
+	return ((uint32_t)x * 73856093) ^ ((uint32_t)y * 19349663) ^ ((uint32_t)z * 83492791);
+}
+
+static inline int FindIsland(int* parent, int body)
+{
+	while (parent[body] != body)
+	{
+		parent[body] = parent[parent[body]];
+		body = parent[body];
+	}
+
+	return body;
+}
+
+static inline void JoinIslands(int* parent, int a, int b)
+{
+	a = FindIsland(parent, a);
+	b = FindIsland(parent, b);
+
+	if (a != b)
+		parent[Max(a, b)] = Min(a, b);
+}
+
+// Finds bodies whose movement this step could bring them into contact using a spatial
+// hash of their swept boxes, and joins them into islands.
+static void BuildIslands(PhysicsWorld& physics)
+{
+	float dt = physics.deltaTime;
+	vector<uint64_t>& cells = physics.cells;
+
+	cells.clear();
+
+	for (int i = 0; i < physics.count; i++)
+	{
+		vec3 delta = physics.velocity[i] * dt + vec3(0.0f, PHYSICS_GRAVITY * 0.5f * Square(dt), 0.0f);
+		vec3 radius = physics.radius[i] + abs(delta) * 0.5f;
+
+		MinMaxAABB bb = MinMaxAABBFromCenter(physics.pos[i] + delta * 0.5f, radius);
+		physics.bounds[i] = bb;
+		physics.islandParent[i] = i;
+
+		ivec3 min = BlockPos(bb.min / PHYSICS_CELL_SIZE);
+		ivec3 max = BlockPos(bb.max / PHYSICS_CELL_SIZE);
+
+		for (int z = min.z; z <= max.z; z++)
+		{
+			for (int y = min.y; y <= max.y; y++)
+			{
+				for (int x = min.x; x <= max.x; x++)
+					cells.push_back(((uint64_t)PhysicsCellHash(x, y, z) << 32) | (uint32_t)i);
+			}
+		}
+	}
+
+	sort(cells.begin(), cells.end());
+
+	for (int start = 0, end = 0; start < cells.size(); start = end)
+	{
+		uint32_t hash = (uint32_t)(cells[start] >> 32);
+
+		while (end < cells.size() && (uint32_t)(cells[end] >> 32) == hash)
+			end++;
+
+		for (int i = start; i < end; i++)
+		{
+			int a = (int)(uint32_t)cells[i];
+
+			for (int j = i + 1; j < end; j++)
+			{
+				int b = (int)(uint32_t)cells[j];
+
+				if (OverlapAABB(physics.bounds[a], physics.bounds[b]))
+					JoinIslands(physics.islandParent, a, b);
+			}
+		}
+	}
+
+	// List the bodies by island. The cell list is reused to sort bodies by their root.
+	cells.clear();
+
+	for (int i = 0; i < physics.count; i++)
+		cells.push_back(((uint64_t)FindIsland(physics.islandParent, i) << 32) | (uint32_t)i);
+
+	sort(cells.begin(), cells.end());
+
+	physics.islandBodies.clear();
+	physics.islandStarts.clear();
+
+	for (int i = 0; i < cells.size(); i++)
+	{
+		if (i == 0 || (cells[i] >> 32) != (cells[i - 1] >> 32))
+			physics.islandStarts.push_back(i);
+
+		physics.islandBodies.push_back((int)(uint32_t)cells[i]);
+	}
+
+	physics.islandStarts.push_back(physics.count);
+}
+
+// Groups whole islands into jobs of roughly PHYSICS_JOB_BODIES bodies.
+static void CreatePhysicsJobs(PhysicsWorld& physics, World* world)
+{
+	int islandCount = (int)physics.islandStarts.size() - 1;
+	physics.jobCount = 0;
+
+	for (int first = 0, last = 0; first < islandCount; first = last)
+	{
+		while (last < islandCount && physics.islandStarts[last] - physics.islandStarts[first] < PHYSICS_JOB_BODIES)
+			last++;
+
+		if (physics.jobCount == physics.jobs.size())
+			physics.jobs.emplace_back();
+
+		PhysicsJob& job = physics.jobs[physics.jobCount++];
+		job.physics = &physics;
+		job.world = world;
+		job.firstIsland = first;
+		job.lastIsland = last;
+	}
+}
+
+// Moves the body under gravity, sweeping it against the blocks in its path.
+static void MoveBody(World* world, PhysicsWorld& physics, int body, vector<AABB>& colliders)
+{
+	float dt = physics.deltaTime;
+
+	vec3& pos = physics.pos[body];
+	vec3& velocity = physics.velocity[body];
+	vec3 radius = physics.radius[body];
+
+	vec3 accel = vec3(0.0f, PHYSICS_GRAVITY, 0.0f);
+	vec3 delta = accel * 0.5f * Square(dt) + velocity * dt;
+
+	velocity = accel * dt + velocity;
+	velocity.y = Max(velocity.y, -100.0f);
+
+	ivec3 bSize = CeilToInt(radius * 2.0f);
+	LWorldP start = BlockPos(pos);
+	LWorldP end = BlockPos(pos + delta);
+
+	colliders.clear();
+
+	for (int z = Min(start.z, end.z) - bSize.z; z <= Max(start.z, end.z) + bSize.z; z++)
+	{
+		for (int y = Min(start.y, end.y) - bSize.y; y <= Max(start.y, end.y) + bSize.y; y++)
+		{
+			for (int x = Min(start.x, end.x) - bSize.x; x <= Max(start.x, end.x) + bSize.x; x++)
+			{
+				if (!IsPassable(world, GetBlock(world, x, y, z)))
+					colliders.push_back(AABBFromCorner(vec3(x, y, z), vec3(1.0f)));
+			}
+		}
+	}
+
+	SortColliders(colliders, pos);
+
+	float tRemaining = 1.0f;
+	BlockContact contact = {};
+
+	for (int it = 0; it < 3 && tRemaining > 0.0f; it++)
+	{
+		float tMin = 1.0f;
+		vec3 normal = vec3(0.0f);
+
+		AABB bb = { pos, radius };
+
+		for (int i = 0; i < colliders.size(); i++)
+			TestCollision(world, bb, colliders[i], delta, tMin, normal, contact);
+
+		pos += delta * tMin;
+
+		// Bodies stop against any wall. Block collide functions act on the player,
+		// so they aren't run for bodies.
+		if (normal != vec3(0.0f))
+		{
+			pos += WallOffset(normal, delta);
+			velocity -= dot(velocity, normal) * normal;
+			delta -= dot(delta, normal) * normal;
+		}
+
+		delta -= (delta * tMin);
+		tRemaining -= (tMin * tRemaining);
+	}
+
+	physics.colFlags[body] = contact.colFlags;
+}
+
+// Pushes apart overlapping bodies in an island along the axis of least overlap. A body
+// resting on another is moved up onto it and counts as landed.
+static void SeparateBodies(PhysicsWorld& physics, int* bodies, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		int a = bodies[i];
+
+		for (int j = i + 1; j < count; j++)
+		{
+			int b = bodies[j];
+
+			vec3 dist = physics.pos[b] - physics.pos[a];
+			vec3 overlap = physics.radius[a] + physics.radius[b] - abs(dist);
+
+			if (overlap.x <= 0.0f || overlap.y <= 0.0f || overlap.z <= 0.0f)
+				continue;
+
+			int axis = overlap.x < overlap.y ? (overlap.x < overlap.z ? 0 : 2) : (overlap.y < overlap.z ? 1 : 2);
+
+			if (axis == 1)
+			{
+				int lower = dist.y >= 0.0f ? a : b;
+				int upper = dist.y >= 0.0f ? b : a;
+
+				physics.pos[upper].y += overlap.y;
+				physics.velocity[upper].y = Max(physics.velocity[upper].y, physics.velocity[lower].y);
+				physics.colFlags[upper] |= HIT_DOWN;
+			}
+			else
+			{
+				float push = (dist[axis] >= 0.0f ? overlap[axis] : -overlap[axis]) * 0.5f;
+				physics.pos[a][axis] -= push;
+				physics.pos[b][axis] += push;
+
+				float vel = (physics.velocity[a][axis] + physics.velocity[b][axis]) * 0.5f;
+				physics.velocity[a][axis] = vel;
+				physics.velocity[b][axis] = vel;
+			}
+		}
+	}
+}
+
+static void RunPhysicsJob(PhysicsJob& job)
+{
+	PhysicsWorld& physics = *job.physics;
+
+	for (int island = job.firstIsland; island < job.lastIsland; island++)
+	{
+		int start = physics.islandStarts[island];
+		int end = physics.islandStarts[island + 1];
+
+		for (int i = start; i < end; i++)
+			MoveBody(job.world, physics, physics.islandBodies[i], job.colliders);
+
+		if (end - start > 1)
+			SeparateBodies(physics, physics.islandBodies.data() + start, end - start);
+	}
+}
+
+// Claims and runs jobs until none are left. Run by the main thread and by workers.
+static void RunPhysicsJobs(PhysicsWorld& physics)
+{
+	while (true)
+	{
+		LONG64 claim = physics.claim;
+		uint32_t job = (uint32_t)claim;
+
+		if (job >= (uint32_t)physics.jobCount)
+			break;
+
+		// Fails if another thread took the job first, or if the step ended since the claim
+		// was read, in which case the job count read above may already be the next step's.
+		if (InterlockedCompareExchange64(&physics.claim, claim + 1, claim) != claim)
+			continue;
+
+		RunPhysicsJob(physics.jobs[job]);
+		InterlockedDecrement(&physics.jobsLeft);
+	}
+}
+
+// Runners are left in the queue when the main thread finishes a step's jobs first.
+// Those that start later find the claims closed, or help with a later step.
+static void PhysicsRunner(GameState*, World*, void* physicsPtr)
+{
+	PhysicsWorld* physics = (PhysicsWorld*)physicsPtr;
+	RunPhysicsJobs(*physics);
+}
+
+// Removes bodies that have left the loaded world or fallen onto the kill zone.
+static void RemoveLostBodies(World* world, PhysicsWorld& physics)
+{
+	float max = (float)(world->size * CHUNK_SIZE_H);
+
+	for (int i = physics.count - 1; i >= 0; i--)
+	{
+		vec3 p = physics.pos[i];
+
+		if (p.x < 0.0f || p.z < 0.0f || p.x >= max || p.z >= max || p.y - physics.radius[i].y < WALL_EPSILON * 2.0f)
+			RemoveBody(physics, i);
+	}
+}
+
+// Islands don't affect each other, so jobs are run by worker threads alongside the main
+// thread. The main thread only waits for the step's jobs to finish, not for the runners
+// to return, and closes the claims before the next step reuses the job list.
+static void StepPhysics(GameState* state, World* world, PhysicsWorld& physics, float deltaTime, bool parallel)
+{
+	if (physics.count == 0) return;
+
+	TIMED_FUNCTION;
+
+	physics.deltaTime = deltaTime;
+
+	BuildIslands(physics);
+	CreatePhysicsJobs(physics, world);
+
+	physics.generation++;
+	physics.jobsLeft = physics.jobCount;
+
+	// Opens the claims for the new step once its jobs are built.
+	LONG64 generation = (LONG64)physics.generation << 32;
+	InterlockedExchange64(&physics.claim, generation);
+
+	if (parallel && physics.count >= PHYSICS_PARALLEL_MIN)
+	{
+		int runners = Min(state->threadCount, physics.jobCount - 1);
+
+		for (int i = 0; i < runners; i++)
+			QueueAsync(state, PhysicsRunner, world, &physics, nullptr, ASYNC_PRIORITY_HIGH);
+	}
+
+	RunPhysicsJobs(physics);
+
+	while (physics.jobsLeft > 0)
+		YieldProcessor();
+
+	InterlockedExchange64(&physics.claim, generation | PHYSICS_CLAIMS_CLOSED);
+
+	RemoveLostBodies(world, physics);
+}
@@ -0,0 +1,77 @@
+//
+// Gamecraft
+//
+
+#define MAX_PHYSICS_BODIES 16384
+
+// Size of the spatial hash cells used to find touching bodies, in blocks.
+#define PHYSICS_CELL_SIZE 4.0f
+
+// Below this many bodies, the whole step runs on the main thread.
+#define PHYSICS_PARALLEL_MIN 512
+
+// Islands are grouped into jobs of roughly this many bodies.
+#define PHYSICS_JOB_BODIES 256
+
+#define PHYSICS_GRAVITY -30.0f
+
+// Job index stored in PhysicsWorld::claim once a step has finished.
+#define PHYSICS_CLAIMS_CLOSED 0xFFFFFFFF
+
+struct PhysicsWorld;
+
+// A range of islands stepped by one worker. Each job keeps its own collision
+// candidates so that jobs can run at the same time.
+struct PhysicsJob
+{
+    PhysicsWorld* physics;
+    World* world;
+    int firstIsland, lastIsland;
+    vector<AABB> colliders;
+};
+
+// Axis-aligned boxes that fall under gravity and collide with blocks and with each
+// other. Each field is stored in its own array, indexed by body.
+struct PhysicsWorld
+{
+    int count;
+
+    vec3* pos;
+    vec3* velocity;
+    vec3* radius;
+    uint8_t* colFlags;
+
+    // Spatial hash entries for each cell a body's swept box overlaps, as the cell
+    // hash in the upper 32 bits and the body in the lower. Sorted to group cells.
+    vector<uint64_t> cells;
+
+    // Each body's box swept over the step, used to find touching bodies.
+    MinMaxAABB* bounds;
+
+    // Bodies that touch are joined into islands, which are stepped independently.
+    // Bodies are listed by island, with each island's start in islandStarts.
+    int* islandParent;
+    vector<int> islandBodies;
+    vector<int> islandStarts;
+
+    vector<PhysicsJob> jobs;
+    int jobCount;
+
+    float deltaTime;
+
+    // Each step has a new generation. The claim holds the step's generation in the
+    // upper 32 bits and the next job to claim in the lower. A claim only succeeds if
+    // the generation hasn't changed, so a runner that starts after its step ended
+    // can't claim a job from the list while the next step rebuilds it.
+    uint32_t generation;
+    volatile LONG64 claim;
+
+    // The number of jobs not yet finished.
+    volatile LONG jobsLeft;
+};
+
+static PhysicsWorld* NewPhysicsWorld();
+static int AddBody(PhysicsWorld& physics, vec3 pos, vec3 size);
+static void ClearBodies(PhysicsWorld& physics);
+static void ShiftBodies(PhysicsWorld& physics, vec3 offset);
+static void StepPhysics(GameState* state, World* world, PhysicsWorld& physics, float deltaTime, bool parallel = true);
@@ -0,0 +1,580 @@
+//
+// Gamecraft
+//
+
+// The part of the Win32 API the engine uses, implemented on POSIX so that the headless
+// benchmark builds on Linux. Only the calls the engine makes are supported, and only
+// with the arguments it passes them.
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <glob.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <x86intrin.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define MAXLONG 0x7FFFFFFF
+
+#define FALSE 0
+#define TRUE 1
+
+#define WINAPI
+
+typedef int BOOL;
+typedef uint8_t BOOLEAN;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef int64_t LONG64;
+typedef void* LPVOID;
+typedef char* LPSTR;
+
+union LARGE_INTEGER
+{
+	int64_t QuadPart;
+};
+
+// Atomics.
+
+template <typename T>
+static inline T InterlockedIncrement(volatile T* value)
+{
+	return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+template <typename T>
+static inline T InterlockedDecrement(volatile T* value)
+{
+	return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename V>
+static inline T InterlockedExchangeAdd(volatile T* value, V add)
+{
+	return __atomic_fetch_add(value, (T)add, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename V>
+static inline T InterlockedExchangeAdd64(volatile T* value, V add)
+{
+	return __atomic_fetch_add(value, (T)add, __ATOMIC_SEQ_CST);
+}
+
+// Returns the value before the exchange, like the Win32 version.
+template <typename T, typename V, typename C>
+static inline T InterlockedCompareExchange(volatile T* value, V exchange, C comparand)
+{
+	T expected = (T)comparand;
+	__atomic_compare_exchange_n(value, &expected, (T)exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+template <typename T, typename V>
+static inline T InterlockedExchange64(volatile T* value, V exchange)
+{
+	return __atomic_exchange_n(value, (T)exchange, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename V, typename C>
+static inline T InterlockedCompareExchange64(volatile T* value, V exchange, C comparand)
+{
+	return InterlockedCompareExchange(value, exchange, comparand);
+}
+
+#define YieldProcessor() _mm_pause()
+#define DebugBreak() __builtin_trap()
+
+// Locks. Slim reader/writer locks are only taken exclusively by the engine.
+
+typedef pthread_rwlock_t SRWLOCK;
+
+#define SRWLOCK_INIT PTHREAD_RWLOCK_INITIALIZER
+
+static inline void InitializeSRWLock(SRWLOCK* lock)
+{
+	pthread_rwlock_init(lock, nullptr);
+}
+
+static inline void AcquireSRWLockExclusive(SRWLOCK* lock)
+{
+	pthread_rwlock_wrlock(lock);
+}
+
+static inline BOOLEAN TryAcquireSRWLockExclusive(SRWLOCK* lock)
+{
+	return pthread_rwlock_trywrlock(lock) == 0;
+}
+
+static inline void ReleaseSRWLockExclusive(SRWLOCK* lock)
+{
+	pthread_rwlock_unlock(lock);
+}
+
+// Critical sections may be entered again by the thread that holds them.
+typedef pthread_mutex_t CRITICAL_SECTION;
+
+static inline void InitializeCriticalSection(CRITICAL_SECTION* cs)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(cs, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static inline void DeleteCriticalSection(CRITICAL_SECTION* cs)
+{
+	pthread_mutex_destroy(cs);
+}
+
+static inline void EnterCriticalSection(CRITICAL_SECTION* cs)
+{
+	pthread_mutex_lock(cs);
+}
+
+static inline BOOL TryEnterCriticalSection(CRITICAL_SECTION* cs)
+{
+	return pthread_mutex_trylock(cs) == 0;
+}
+
+static inline void LeaveCriticalSection(CRITICAL_SECTION* cs)
+{
+	pthread_mutex_unlock(cs);
+}
+
+typedef pthread_cond_t CONDITION_VARIABLE;
+
+static inline void InitializeConditionVariable(CONDITION_VARIABLE* cv)
+{
+	pthread_cond_init(cv, nullptr);
+}
+
+typedef pthread_barrier_t SYNCHRONIZATION_BARRIER;
+
+// The spin count is ignored.
+static inline BOOL InitializeSynchronizationBarrier(SYNCHRONIZATION_BARRIER* barrier, LONG threads, LONG)
+{
+	return pthread_barrier_init(barrier, nullptr, (unsigned)threads) == 0;
+}
+
+static inline BOOL EnterSynchronizationBarrier(SYNCHRONIZATION_BARRIER* barrier, DWORD)
+{
+	return pthread_barrier_wait(barrier) == PTHREAD_BARRIER_SERIAL_THREAD;
+}
+
+static inline BOOL DeleteSynchronizationBarrier(SYNCHRONIZATION_BARRIER* barrier)
+{
+	return pthread_barrier_destroy(barrier) == 0;
+}
+
+// Handles. A handle is one of the kinds below, and CloseHandle frees it. Threads are
+// detached when they're created, so closing a thread's handle doesn't wait for it.
+
+enum PosixHandleType
+{
+	POSIX_FILE,
+	POSIX_THREAD,
+	POSIX_SEMAPHORE,
+	POSIX_EVENT,
+	POSIX_FIND
+};
+
+struct PosixHandle
+{
+	PosixHandleType type;
+
+	int file;
+	sem_t semaphore;
+
+	// Events reset themselves when a waiting thread is released.
+	pthread_mutex_t eventLock;
+	pthread_cond_t eventCond;
+	bool signaled;
+
+	glob_t found;
+	size_t nextFound;
+};
+
+typedef PosixHandle* HANDLE;
+
+#define INVALID_HANDLE_VALUE ((HANDLE)-1)
+
+static inline HANDLE NewPosixHandle(PosixHandleType type)
+{
+	HANDLE handle = new PosixHandle();
+	handle->type = type;
+	return handle;
+}
+
+static BOOL CloseHandle(HANDLE handle)
+{
+	switch (handle->type)
+	{
+		case POSIX_FILE:
+			close(handle->file);
+			break;
+
+		case POSIX_SEMAPHORE:
+			sem_destroy(&handle->semaphore);
+			break;
+
+		case POSIX_EVENT:
+			pthread_cond_destroy(&handle->eventCond);
+			pthread_mutex_destroy(&handle->eventLock);
+			break;
+
+		default:
+			break;
+	}
+
+	delete handle;
+	return TRUE;
+}
+
+// Threads.
+
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+
+struct PosixThreadStart
+{
+	LPTHREAD_START_ROUTINE func;
+	LPVOID param;
+};
+
+static void* PosixThreadProc(void* ptr)
+{
+	PosixThreadStart start = *(PosixThreadStart*)ptr;
+	delete (PosixThreadStart*)ptr;
+
+	start.func(start.param);
+	return nullptr;
+}
+
+static inline DWORD GetCurrentThreadId()
+{
+	return (DWORD)syscall(SYS_gettid);
+}
+
+// Security attributes, stack size, and creation flags aren't supported. The thread
+// ID is not known to the caller until the thread runs, so 0 is returned for it.
+static HANDLE CreateThread(void*, size_t, LPTHREAD_START_ROUTINE func, LPVOID param, DWORD, DWORD* threadID)
+{
+	PosixThreadStart* start = new PosixThreadStart { func, param };
+	pthread_t thread;
+
+	if (pthread_create(&thread, nullptr, PosixThreadProc, start) != 0)
+	{
+		delete start;
+		return nullptr;
+	}
+
+	pthread_detach(thread);
+
+	if (threadID != nullptr)
+		*threadID = 0;
+
+	return NewPosixHandle(POSIX_THREAD);
+}
+
+static inline void Sleep(DWORD ms)
+{
+	if (ms == 0)
+		sched_yield();
+	else usleep(ms * 1000);
+}
+
+static HANDLE CreateSemaphore(void*, LONG initialCount, LONG, const char*)
+{
+	HANDLE handle = NewPosixHandle(POSIX_SEMAPHORE);
+	sem_init(&handle->semaphore, 0, (unsigned)initialCount);
+	return handle;
+}
+
+static inline BOOL ReleaseSemaphore(HANDLE handle, LONG count, LONG*)
+{
+	for (LONG i = 0; i < count; i++)
+		sem_post(&handle->semaphore);
+
+	return TRUE;
+}
+
+// Only auto-reset events are supported.
+static HANDLE CreateEvent(void*, BOOL, BOOL initialState, const char*)
+{
+	HANDLE handle = NewPosixHandle(POSIX_EVENT);
+	pthread_mutex_init(&handle->eventLock, nullptr);
+	pthread_cond_init(&handle->eventCond, nullptr);
+	handle->signaled = initialState;
+	return handle;
+}
+
+static BOOL SetEvent(HANDLE handle)
+{
+	pthread_mutex_lock(&handle->eventLock);
+	handle->signaled = true;
+	pthread_cond_signal(&handle->eventCond);
+	pthread_mutex_unlock(&handle->eventLock);
+	return TRUE;
+}
+
+// Only infinite waits on semaphores and events are supported.
+static DWORD WaitForSingleObject(HANDLE handle, DWORD)
+{
+	if (handle->type == POSIX_SEMAPHORE)
+	{
+		while (sem_wait(&handle->semaphore) != 0 && errno == EINTR);
+		return 0;
+	}
+
+	assert(handle->type == POSIX_EVENT);
+
+	pthread_mutex_lock(&handle->eventLock);
+
+	while (!handle->signaled)
+		pthread_cond_wait(&handle->eventCond, &handle->eventLock);
+
+	handle->signaled = false;
+	pthread_mutex_unlock(&handle->eventLock);
+
+	return 0;
+}
+
+struct SYSTEM_INFO
+{
+	DWORD dwNumberOfProcessors;
+};
+
+static inline void GetSystemInfo(SYSTEM_INFO* info)
+{
+	info->dwNumberOfProcessors = (DWORD)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+// Timing. The performance counter counts nanoseconds.
+
+static inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+static inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	counter->QuadPart = (int64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+	return TRUE;
+}
+
+// Memory.
+
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_RELEASE 0x8000
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READWRITE 0x04
+
+// Reserved pages are mapped without access, and committing them makes them writable.
+static void* VirtualAlloc(void* address, size_t size, DWORD type, DWORD protect)
+{
+	int prot = protect == PAGE_READWRITE ? PROT_READ | PROT_WRITE : PROT_NONE;
+
+	if (type & MEM_RESERVE)
+	{
+		void* ptr = mmap(address, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return ptr == MAP_FAILED ? nullptr : ptr;
+	}
+
+	if (size == 0)
+		return address;
+
+	return mprotect(address, size, prot) == 0 ? address : nullptr;
+}
+
+// Only releasing a whole reservation is supported, so the size must be the reserved size.
+static inline BOOL VirtualFree(void* address, size_t size, DWORD)
+{
+	return munmap(address, size) == 0;
+}
+
+static inline void* _aligned_malloc(size_t size, size_t align)
+{
+	void* ptr;
+	return posix_memalign(&ptr, align < sizeof(void*) ? sizeof(void*) : align, size) == 0 ? ptr : nullptr;
+}
+
+static inline void _aligned_free(void* ptr)
+{
+	free(ptr);
+}
+
+// Files.
+
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+
+#define FILE_SHARE_READ 0x1
+
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+
+#define FILE_ATTRIBUTE_NORMAL 0x80
+
+#define FILE_END 2
+#define INVALID_SET_FILE_POINTER ((DWORD)-1)
+
+// Sharing, security attributes, and file attributes are ignored.
+static HANDLE CreateFile(const char* path, DWORD access, DWORD, void*, DWORD disposition, DWORD, void*)
+{
+	int flags = (access & GENERIC_WRITE) ? ((access & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+
+	if (disposition == CREATE_ALWAYS)
+		flags |= O_CREAT | O_TRUNC;
+
+	int file = open(path, flags, 0644);
+
+	if (file == -1)
+		return INVALID_HANDLE_VALUE;
+
+	HANDLE handle = NewPosixHandle(POSIX_FILE);
+	handle->file = file;
+	return handle;
+}
+
+static BOOL ReadFile(HANDLE handle, void* buffer, DWORD size, DWORD* bytesRead, void*)
+{
+	ssize_t result;
+	while ((result = read(handle->file, buffer, size)) == -1 && errno == EINTR);
+
+	*bytesRead = result == -1 ? 0 : (DWORD)result;
+	return result != -1;
+}
+
+static BOOL WriteFile(HANDLE handle, const void* buffer, DWORD size, DWORD* bytesWritten, void*)
+{
+	DWORD written = 0;
+
+	while (written < size)
+	{
+		ssize_t result = write(handle->file, (const uint8_t*)buffer + written, size - written);
+
+		if (result == -1)
+		{
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		written += (DWORD)result;
+	}
+
+	*bytesWritten = written;
+	return written == size;
+}
+
+static inline BOOL GetFileSizeEx(HANDLE handle, LARGE_INTEGER* size)
+{
+	struct stat info;
+
+	if (fstat(handle->file, &info) != 0)
+		return FALSE;
+
+	size->QuadPart = info.st_size;
+	return TRUE;
+}
+
+static inline DWORD SetFilePointer(HANDLE handle, LONG distance, LONG*, DWORD method)
+{
+	off_t result = lseek(handle->file, distance, method == FILE_END ? SEEK_END : SEEK_SET);
+	return result == -1 ? INVALID_SET_FILE_POINTER : (DWORD)result;
+}
+
+static inline BOOL PathFileExists(const char* path)
+{
+	return access(path, F_OK) == 0;
+}
+
+static inline BOOL PathIsRelative(const char* path)
+{
+	return path[0] != '/';
+}
+
+static inline char* PathFindFileName(char* path)
+{
+	char* name = strrchr(path, '/');
+	return name == nullptr ? path : name + 1;
+}
+
+static inline BOOL CreateDirectory(const char* path, void*)
+{
+	return mkdir(path, 0755) == 0;
+}
+
+static inline BOOL DeleteFile(const char* path)
+{
+	return unlink(path) == 0;
+}
+
+// Returns the length of the path, or 0 if it doesn't fit.
+static inline DWORD GetModuleFileName(void*, char* buffer, DWORD size)
+{
+	ssize_t length = readlink("/proc/self/exe", buffer, size - 1);
+
+	if (length <= 0)
+		return 0;
+
+	buffer[length] = '\0';
+	return (DWORD)length;
+}
+
+struct WIN32_FIND_DATA
+{
+	char cFileName[MAX_PATH];
+};
+
+static BOOL FindNextFile(HANDLE handle, WIN32_FIND_DATA* data)
+{
+	if (handle->nextFound >= handle->found.gl_pathc)
+		return FALSE;
+
+	char* path = handle->found.gl_pathv[handle->nextFound++];
+	char* name = strrchr(path, '/');
+
+	snprintf(data->cFileName, MAX_PATH, "%s", name == nullptr ? path : name + 1);
+	return TRUE;
+}
+
+static HANDLE FindFirstFile(const char* pattern, WIN32_FIND_DATA* data)
+{
+	HANDLE handle = NewPosixHandle(POSIX_FIND);
+
+	if (glob(pattern, 0, nullptr, &handle->found) != 0 || !FindNextFile(handle, data))
+	{
+		globfree(&handle->found);
+		delete handle;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return handle;
+}
+
+static inline BOOL FindClose(HANDLE handle)
+{
+	if (handle == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	globfree(&handle->found);
+	delete handle;
+	return TRUE;
+}
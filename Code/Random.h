@@ -33,3 +33,39 @@ inline int RandRange(int min, int max)
 {
     return min + rand() % ((max + 1) - min);
 }
+
+// Deterministic generator for work run on the worker threads. The C runtime keeps
+// rand()'s state per thread, so its values depend on which thread runs the work.
+struct RandomStream
+{
+    uint32_t state;
+};
+
+inline RandomStream NewRandomStream(uint32_t seed)
+{
+    // Mix the seed so that nearby seeds give unrelated streams. Xorshift can't
+    // leave a zero state.
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6B;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35;
+    seed ^= seed >> 16;
+
+    return { seed == 0 ? 1 : seed };
+}
+
+inline uint32_t NextRandom(RandomStream& stream)
+{
+    uint32_t x = stream.state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    stream.state = x;
+    return x;
+}
+
+// Returns a random number between min and max.
+inline int RandRange(RandomStream& stream, int min, int max)
+{
+    return min + (int)(NextRandom(stream) % (uint32_t)((max + 1) - min));
+}
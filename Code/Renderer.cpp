@@ -172,6 +172,23 @@ static void SetAA(Renderer& rend, int samples)
 	}
 }
 
+// Sets the camera's frustum dimensions and the projection matrix for the given screen size.
+static void SetCameraProjection(Camera* cam, Renderer& rend, int width, int height)
+{
+	float fov = radians(CAMERA_FOV);
+	float ratio = (float)width / (float)height;
+
+	float t = (float)tan(fov * 0.5f);
+	cam->nearH = cam->nearDist * t;
+	cam->nearW = cam->nearH * ratio;
+	cam->farH = cam->farDist * t;
+	cam->farW = cam->farH * ratio;
+
+	rend.perspective = perspective(fov, ratio, cam->nearDist, cam->farDist);
+}
+
+#if !HEADLESS
+
 static void SetWindowSize(GLFWwindow* window, int width, int height)
 {
 	GameState* state = (GameState*)glfwGetWindowUserPointer(window);
@@ -184,21 +201,10 @@ static void SetWindowSize(GLFWwindow* window, int width, int height)
 
 	state->minimized = false;
 
-	Camera* cam = state->camera;
-
 	glViewport(0, 0, width, height);
 
-	float fov = radians(CAMERA_FOV);
-	float ratio = (float)width / (float)height;
-
-	float t = (float)tan(fov * 0.5f);
-	cam->nearH = cam->nearDist * t;
-	cam->nearW = cam->nearH * ratio;
-	cam->farH = cam->farDist * t;
-	cam->farW = cam->farH * ratio;
-
 	Renderer& rend = state->renderer;
-	rend.perspective = perspective(fov, ratio, cam->nearDist, cam->farDist);
+	SetCameraProjection(state->camera, rend, width, height);
 
 	if (rend.crosshair != nullptr)
 		SetCrosshairPos(rend.crosshair, width, height);
@@ -206,6 +212,8 @@ static void SetWindowSize(GLFWwindow* window, int width, int height)
 	CreateAAFBO(rend);
 }
 
+#endif
+
 static Camera* NewCamera()
 {
 	Camera* cam = new Camera();
@@ -272,6 +280,7 @@ static void ListUniforms(Shader* shader)
 
 static void ApplyClearColor(GameState* state, Renderer& rend)
 {
+	#if !HEADLESS
 	glClearColor(rend.clearColor.r, rend.clearColor.g, rend.clearColor.b, 1.0f);
 
 	AssetDatabase& db = state->assets;
@@ -287,10 +296,17 @@ static void ApplyClearColor(GameState* state, Renderer& rend)
 	Shader* alpha = &db.shaders[SHADER_BLOCK_TRANSPARENT];
 	UseShader(alpha);
     SetUniform(alpha->fogColor, rend.clearColor);
+	#else
+	Unused(state);
+	Unused(rend);
+	#endif
 }
 
 static void InitRenderer(GameState* state, Renderer& rend, int screenWidth, int screenHeight)
 {
+	rend.meshData.tag = MEMORY_MESH_DATA;
+	rend.meshData2D.tag = MEMORY_MESH_DATA;
+
 	glPolygonMode(GL_FRONT, GL_FILL);
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST);
@@ -504,12 +520,12 @@ static inline FrustumVisibility TestFrustum(Camera* cam, vec3 min, vec3 max)
 
 static void DrawMeshesOfType(Renderer& rend, Shader* shader, BlockMeshType type)
 {
-	size_t count = rend.meshLists[type].size();
+	ArenaVector<ChunkMesh>& list = *rend.meshLists[type];
 
-	for (int i = 0; i < count; i++)
+	for (int i = 0; i < list.size(); i++)
 	{
 		TRACK_MESH;
-		ChunkMesh cM = rend.meshLists[type][i];
+		ChunkMesh cM = list[i];
 		DrawMesh(cM.mesh, shader, cM.pos, type);
 	}
 }
@@ -565,10 +581,10 @@ static void RenderScene(GameState* state, Renderer& rend, Camera* cam)
 	// Particles.
 	glDisable(GL_CULL_FACE);
 
-	for (int i = 0; i < rend.emitters.size(); i++)
-		DrawParticles(state, *rend.emitters[i], cam);
+	ArenaVector<ParticleEmitter*>& emitters = *rend.emitters;
 
-	rend.emitters.clear();
+	for (int i = 0; i < emitters.size(); i++)
+		DrawParticles(state, *emitters[i], cam);
 
 	glEnable(GL_CULL_FACE);
 
@@ -617,7 +633,9 @@ static void RenderScene(GameState* state, Renderer& rend, Camera* cam)
 	if (!rend.disableFluidCull)
 		glDisable(GL_CULL_FACE);
 
+	#if !HEADLESS
 	RenderUI(state, rend, state->ui);
+	#endif
 
 	glDisable(GL_BLEND);
 	glEnable(GL_CULL_FACE);
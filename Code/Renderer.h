@@ -73,8 +73,9 @@ struct Renderer
 {
     mat4 perspective;
 
-    vector<ChunkMesh> meshLists[MESH_TYPE_COUNT];
-    vector<ParticleEmitter*> emitters;
+    // Created in the frame arena by PrepareWorldRender each frame.
+    ArenaVector<ChunkMesh>* meshLists[MESH_TYPE_COUNT];
+    ArenaVector<ParticleEmitter*>* emitters;
 
     BlockAnimation blockAnimation[MESH_TYPE_COUNT];
 
@@ -102,7 +103,7 @@ struct Renderer
     GLuint colAA, depthAA;
     GLuint fboAA;
 
-    ObjectPool<MeshData> meshData;
+    SharedObjectPool<MeshData> meshData;
     ObjectPool<MeshData2D> meshData2D;
 };
 
@@ -0,0 +1,306 @@
+//
+// Gamecraft
+//
+
+// Recording is started with -record <file> and playback with -replay <file>, adding -fixed
+// to play back at REPLAY_FIXED_DELTA. Both use their own save folder, which is cleared so
+// that the world is generated again from the recorded seed.
+static void ParseReplayArgs(Replay& replay, vector<char*>& args)
+{
+	for (int i = 0; i < args.size(); i++)
+	{
+		char* arg = args[i];
+
+		if (strcmp(arg, "-fixed") == 0)
+		{
+			replay.fixedTiming = true;
+			continue;
+		}
+
+		ReplayMode mode = REPLAY_NONE;
+
+		if (strcmp(arg, "-record") == 0)
+			mode = REPLAY_RECORDING;
+		else if (strcmp(arg, "-replay") == 0)
+			mode = REPLAY_PLAYING;
+
+		if (mode == REPLAY_NONE)
+			continue;
+
+		if (i + 1 >= args.size())
+			Error("Expected a file name after %s.\n", arg);
+
+		char* name = args[++i];
+		replay.mode = mode;
+
+		if (PathIsRelative(name))
+			PathToExe(name, replay.path, MAX_PATH);
+		else strcpy(replay.path, name);
+	}
+}
+
+static void ClearReplayWorld(GameState* state)
+{
+	char path[MAX_PATH];
+	sprintf(path, "%s/World", state->savePath);
+	DeleteDirectory(path);
+}
+
+// Opens the replay file. A recording picks a new seed, while playback reads it
+// from the file.
+static void OpenReplay(Replay& replay)
+{
+	ReplayHeader& header = replay.header;
+
+	if (replay.mode == REPLAY_RECORDING)
+	{
+		replay.file = fopen(replay.path, "wb");
+
+		if (replay.file == nullptr)
+			Error("Failed to create the replay file %s.\n", replay.path);
+
+		header.code = FORMAT_CODE('g', 'c', 'r');
+		header.version = REPLAY_VERSION;
+		header.buildID = g_buildID;
+		header.seed = (uint32_t)time(0);
+	}
+	else
+	{
+		replay.file = fopen(replay.path, "rb");
+
+		if (replay.file == nullptr)
+			Error("Failed to open the replay file %s.\n", replay.path);
+
+		if (fread(&header, sizeof(ReplayHeader), 1, replay.file) != 1 || header.code != (FORMAT_CODE('g', 'c', 'r')))
+			Error("Invalid replay file %s.\n", replay.path);
+
+		if (header.version != REPLAY_VERSION)
+			Error("Replay version %u is unsupported.\n", header.version);
+
+		replay.frameTimes.reserve(4096);
+	}
+}
+
+// Called once the game is set up. A recording saves the current settings, while
+// playback applies the recorded settings.
+static void StartReplay(GameState* state, Replay& replay, int screenWidth, int screenHeight)
+{
+	ReplayHeader& header = replay.header;
+
+	if (replay.mode == REPLAY_RECORDING)
+	{
+		header.settings = { state->audio.muted, state->renderer.samplesAA };
+		header.screenWidth = screenWidth;
+		header.screenHeight = screenHeight;
+		fwrite(&header, sizeof(ReplayHeader), 1, replay.file);
+	}
+	else
+	{
+		state->audio.muted = header.settings.audioMuted;
+
+		#if !HEADLESS
+		Renderer& rend = state->renderer;
+		rend.samplesAA = header.settings.samplesAA;
+		SetAA(rend, header.settings.samplesAA);
+		#endif
+	}
+}
+
+static inline uint64_t PackKeys(bool* keys)
+{
+	uint64_t bits = 0;
+
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		if (keys[i])
+			bits |= 1ull << i;
+	}
+
+	return bits;
+}
+
+static inline void UnpackKeys(uint64_t bits, bool* keys)
+{
+	for (int i = 0; i < KEY_COUNT; i++)
+		keys[i] = (bits & (1ull << i)) != 0;
+}
+
+// Called at the start of the frame, after input is polled. During playback, the polled
+// input is replaced by the recorded input, and the delta time by the recorded or fixed
+// delta time. Returns false once the replay has no more frames.
+static bool ReplayInput(GameState* state, Replay& replay, float& deltaTime)
+{
+	if (replay.mode != REPLAY_PLAYING)
+		return true;
+
+	ReplayFrame& frame = replay.frame;
+
+	if (fread(&frame, sizeof(ReplayFrame), 1, replay.file) != 1)
+		return false;
+
+	if (frame.commandLength > 0)
+	{
+		if (frame.commandLength >= MAX_COMMAND_LENGTH || fread(replay.command, frame.commandLength, 1, replay.file) != 1)
+			Error("The replay file %s is damaged.\n", replay.path);
+
+		replay.command[frame.commandLength] = '\0';
+	}
+
+	Input& input = state->input;
+	UnpackKeys(frame.keys, input.keys);
+	UnpackKeys(frame.single, input.single);
+
+	for (int i = 0; i < 2; i++)
+	{
+		input.mousePressed[i] = (frame.mouse & (1 << i)) != 0;
+		input.mouseHeld[i] = (frame.mouse & (4 << i)) != 0;
+	}
+
+	deltaTime = replay.fixedTiming ? REPLAY_FIXED_DELTA : frame.deltaTime;
+
+	// Commands are run directly on the frame they were entered. The command UI only
+	// reads text typed into the window, so it can't run them. The recorded enter key
+	// is dropped so that the UI doesn't submit again.
+	if (frame.commandLength > 0)
+	{
+		CommandProcessor& processor = state->cmdProcessor;
+		strcpy(processor.inputText, replay.command);
+
+		CommandResult result = ProcessCommand(state, processor);
+		memset(processor.inputText, 0, sizeof(processor.inputText));
+		input.single[KEY_ENTER] = false;
+
+		if (result.error == nullptr)
+		{
+			if (result.newState != NONE)
+				state->pauseState = (PauseState)result.newState;
+			else Unpause(state);
+		}
+	}
+
+	replay.frameStart = glfwGetTime();
+	return true;
+}
+
+// Records the camera rotation applied from the mouse this frame, or replaces it
+// with the recorded rotation during playback.
+static void ReplayRotation(Replay& replay, vec2& rotation)
+{
+	if (replay.mode == REPLAY_RECORDING)
+		replay.frame.rotation = rotation;
+	else if (replay.mode == REPLAY_PLAYING)
+		rotation = replay.frame.rotation;
+}
+
+static void RecordReplayCommand(Replay& replay, char* command)
+{
+	if (replay.mode != REPLAY_RECORDING)
+		return;
+
+	size_t length = strlen(command);
+	assert(length < MAX_COMMAND_LENGTH);
+
+	strcpy(replay.command, command);
+	replay.frame.commandLength = (uint8_t)length;
+}
+
+static void EndReplayFrame(GameState* state, Replay& replay, float deltaTime)
+{
+	ReplayFrame& frame = replay.frame;
+
+	if (replay.mode == REPLAY_RECORDING)
+	{
+		Input& input = state->input;
+		frame.keys = PackKeys(input.keys);
+		frame.single = PackKeys(input.single);
+		int mouse = 0;
+
+		for (int i = 0; i < 2; i++)
+		{
+			if (input.mousePressed[i]) mouse |= 1 << i;
+			if (input.mouseHeld[i]) mouse |= 4 << i;
+		}
+
+		frame.mouse = (uint8_t)mouse;
+
+		frame.deltaTime = deltaTime;
+		frame.pauseState = (uint8_t)state->pauseState;
+
+		fwrite(&frame, sizeof(ReplayFrame), 1, replay.file);
+
+		if (frame.commandLength > 0)
+			fwrite(replay.command, frame.commandLength, 1, replay.file);
+
+		frame = {};
+	}
+	else if (replay.mode == REPLAY_PLAYING)
+	{
+		replay.frameTimes.push_back((float)((glfwGetTime() - replay.frameStart) * 1000.0));
+
+		// The loading screen lasts until background work finishes, which doesn't take the
+		// same number of frames each run, so it's left to run its course.
+		PauseState recorded = (PauseState)frame.pauseState;
+
+		if (state->pauseState != recorded && state->pauseState != LOADING && recorded != LOADING)
+		{
+			if (recorded == PLAYING)
+				Unpause(state);
+			else Pause(state, recorded);
+		}
+	}
+}
+
+// Closes the replay file. After playback, the frame times are appended to ReplayReport.csv
+// next to the executable, so that runs of the same replay can be compared across builds.
+static void FinishReplay(Replay& replay)
+{
+	if (replay.mode == REPLAY_NONE)
+		return;
+
+	fclose(replay.file);
+	replay.file = nullptr;
+
+	if (replay.mode != REPLAY_PLAYING)
+		return;
+
+	vector<float>& times = replay.frameTimes;
+
+	if (times.empty())
+		return;
+
+	double total = 0.0;
+
+	for (int i = 0; i < times.size(); i++)
+		total += times[i];
+
+	sort(times.begin(), times.end());
+
+	int count = (int)times.size();
+	float p50 = times[count / 2];
+	float p95 = times[Min((int)(count * 0.95f), count - 1)];
+	float p99 = times[Min((int)(count * 0.99f), count - 1)];
+	float mean = (float)(total / count);
+
+	char path[MAX_PATH];
+	PathToExe("ReplayReport.csv", path, MAX_PATH);
+
+	bool exists = PathFileExists(path) != 0;
+	FILE* file = fopen(path, "a");
+
+	if (file == nullptr)
+		return;
+
+	if (!exists)
+		fprintf(file, "build,buildType,headless,replay,recordedBuild,timing,frames,mean,p50,p95,p99,max\n");
+
+	fprintf(file, "%i,%s,%i,%s,%i,%s,%i,%.3f,%.3f,%.3f,%.3f,%.3f\n", g_buildID, g_buildType, HEADLESS,
+		PathFindFileName(replay.path), replay.header.buildID, replay.fixedTiming ? "fixed" : "recorded", count,
+		mean, p50, p95, p99, times.back());
+
+	fclose(file);
+
+	#if HEADLESS
+	printf("Replayed %i frames: mean %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+		count, mean, p50, p95, p99, times.back());
+	#endif
+}
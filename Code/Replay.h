@@ -0,0 +1,70 @@
+//
+// Gamecraft
+//
+
+#define REPLAY_VERSION 1
+
+// Delta time used when a replay is fed back at fixed timing instead of the recorded timing.
+#define REPLAY_FIXED_DELTA (1.0f / 60.0f)
+
+enum ReplayMode
+{
+    REPLAY_NONE,
+    REPLAY_RECORDING,
+    REPLAY_PLAYING
+};
+
+// Written at the start of a replay file. The random seed is applied before anything
+// is created and the settings before the first frame, so that the replay starts from
+// the same state as the recording.
+struct ReplayHeader
+{
+    uint32_t code;
+    uint32_t version;
+    int buildID;
+    uint32_t seed;
+    SettingsFileData settings;
+    int screenWidth, screenHeight;
+};
+
+// One frame of input. Keys are stored as bitmasks and the mouse buttons as bits 0-1
+// (pressed) and 2-3 (held). The pause state is recorded so that menus driven by the
+// mouse, which aren't recorded, end in the same state. If a command was entered during
+// the frame, its text follows the frame in the file.
+struct ReplayFrame
+{
+    uint64_t keys, single;
+    float deltaTime;
+    vec2 rotation;
+    uint8_t mouse;
+    uint8_t pauseState;
+    uint8_t commandLength;
+};
+
+struct Replay
+{
+    ReplayMode mode;
+    FILE* file;
+    char path[MAX_PATH];
+
+    // If set, replayed frames use REPLAY_FIXED_DELTA rather than the recorded delta time.
+    bool fixedTiming;
+
+    ReplayHeader header;
+    ReplayFrame frame;
+    char command[MAX_COMMAND_LENGTH];
+
+    // Wall time of each replayed frame in milliseconds, for the report.
+    vector<float> frameTimes;
+    double frameStart;
+};
+
+static void ParseReplayArgs(Replay& replay, vector<char*>& args);
+static void ClearReplayWorld(GameState* state);
+static void OpenReplay(Replay& replay);
+static void StartReplay(GameState* state, Replay& replay, int screenWidth, int screenHeight);
+static bool ReplayInput(GameState* state, Replay& replay, float& deltaTime);
+static void ReplayRotation(Replay& replay, vec2& rotation);
+static void RecordReplayCommand(Replay& replay, char* command);
+static void EndReplayFrame(GameState* state, Replay& replay, float deltaTime);
+static void FinishReplay(Replay& replay);
@@ -0,0 +1,67 @@
+//
+// Gamecraft
+//
+
+// Plays back a recording made with the game's -record option, running the same update
+// as the game without the UI or rendering. Commands are run directly, and menus are
+// left to the recorded pause state.
+static int RunHeadlessReplay(GameState* state)
+{
+	Replay& replay = state->replay;
+	OpenReplay(replay);
+	srand(replay.header.seed);
+
+	char savePath[MAX_PATH];
+	InitHeadless(state, "ReplaySaves", savePath);
+
+	WorldConfig worldConfig = {};
+	worldConfig.radius = 1024;
+
+	ReplayHeader& header = replay.header;
+	World* world = CreateHeadlessWorld(state, worldConfig, header.screenWidth, header.screenHeight);
+	Player* player = world->player;
+
+	StartReplay(state, replay, header.screenWidth, header.screenHeight);
+
+	// There's no audio device to play sounds on.
+	state->audio.muted = true;
+
+	float deltaTime = 0.0f;
+
+	while (true)
+	{
+		FRAME_MARKER;
+		ResetFrameArena();
+
+		ResetInput(state->input);
+
+		if (!ReplayInput(state, replay, deltaTime))
+			break;
+
+		RunAsyncCallbacks(state);
+		Update(state, player, world, deltaTime);
+		UpdateViewMatrix(state->camera);
+
+		DEBUG_END_FRAME(state);
+		END_HEAP_FRAME;
+
+		EndReplayFrame(state, replay, deltaTime);
+	}
+
+	FinishReplay(replay);
+
+	return 0;
+}
+
+// GamecraftBench replay <file> [-fixed]. The options are the same as the game's -replay.
+static int RunReplayBench(GameState* state, vector<char*>& args)
+{
+	if (args.empty())
+		Error("Expected a recording to play back.\n");
+
+	vector<char*> replayArgs = args;
+	replayArgs.insert(replayArgs.begin(), "-replay");
+
+	ParseReplayArgs(state->replay, replayArgs);
+	return RunHeadlessReplay(state);
+}
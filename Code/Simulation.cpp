@@ -107,76 +107,128 @@ static float BlockRayIntersection(vec3 blockPos, Ray ray)
 	return nearP > 0.0f ? nearP : farP;
 }
 
-static bool VoxelRaycast(World* world, Ray ray, float dist, vec3* result)
+// Returns true if the chunk the accessor is in can't contain solid blocks, either 
+// because it lies above every column's surface or because its group isn't loaded.
+static inline bool RayCanSkipChunk(BlockAccessor& acc)
 {
-	ivec3 start = BlockPos(ray.origin);
-	ivec3 end = BlockPos(ray.origin + ray.dir * dist);
+	if (acc.pos.y < 0 || acc.pos.y >= WORLD_BLOCK_HEIGHT)
+		return false;
 
-	if (start.x > end.x)
-	{
-		int tmp = start.x;
-		start.x = end.x;
-		end.x = tmp;
-	}
-	
-	if (start.y > end.y) 
-	{
-		int tmp = start.y;
-		start.y = end.y;
-		end.y = tmp;
-	}
-	
-	if (start.z > end.z) 
+	if (acc.chunk == nullptr)
+		return true;
+
+	return acc.chunk->lwPos.y >= acc.group->maxSurface;
+}
+
+// Walks the blocks along the ray in order using the Amanatides-Woo traversal and 
+// stops at the first solid block. The normal is that of the face the ray entered 
+// through, and is zero if the ray starts inside a solid block. Blocks in chunks 
+// that can't contain solid blocks are stepped over without being read. Each step
+// only moves the accessor by one block.
+static HitInfo VoxelRaycast(BlockAccessor& acc, Ray ray, float dist)
+{
+	World* world = acc.world;
+	HitInfo info = {};
+
+	ivec3 p = BlockPos(ray.origin);
+	ivec3 step;
+	vec3 tMax, tDelta;
+
+	for (int i = 0; i < 3; i++)
 	{
-		int tmp = start.z;
-		start.z = end.z;
-		end.z = tmp;
+		float dir = ray.dir[i];
+
+		if (dir > EPSILON)
+		{
+			step[i] = 1;
+			tDelta[i] = 1.0f / dir;
+			tMax[i] = ((float)p[i] + 1.0f - ray.origin[i]) * tDelta[i];
+		}
+		else if (dir < -EPSILON)
+		{
+			step[i] = -1;
+			tDelta[i] = -1.0f / dir;
+			tMax[i] = (ray.origin[i] - (float)p[i]) * tDelta[i];
+		}
+		else
+		{
+			step[i] = 0;
+			tDelta[i] = FLT_MAX;
+			tMax[i] = FLT_MAX;
+		}
 	}
 
-	float minDistance = dist;
+	float t = 0.0f;
+	int axis = -1;
+
+	MoveAccessorTo(acc, p);
 
-	for (int z = start.z; z <= end.z; z++) 
+	while (t <= dist)
 	{
-		for (int y = start.y; y <= end.y; y++) 
+		Block block = GetBlock(acc);
+
+		if (!IsPassable(world, block))
 		{
-			for (int x = start.x; x <= end.x; x++) 
+			info.hit = true;
+			info.block = block;
+			info.hitPos = p;
+			info.adjPos = p;
+			info.dist = t;
+
+			if (axis >= 0)
 			{
-				Block block = GetBlock(world, x, y, z);
+				info.adjPos[axis] -= step[axis];
+				info.normal[axis] = (float)-step[axis];
+			}
 
-				if (IsPassable(world, block)) continue;
+			return info;
+		}
 
-				float newDist = BlockRayIntersection(vec3((float)x, (float)y, (float)z), ray);
-				minDistance = Min(minDistance, newDist);
-			}
+		bool skip = RayCanSkipChunk(acc);
+
+		ivec3 chunkMin = ivec3(p.x & ~CHUNK_H_MASK, p.y & ~CHUNK_V_MASK, p.z & ~CHUNK_H_MASK);
+		ivec3 chunkMax = chunkMin + ivec3(CHUNK_SIZE_H, CHUNK_SIZE_V, CHUNK_SIZE_H);
+
+		do
+		{
+			if (tMax.x < tMax.y)
+				axis = tMax.x < tMax.z ? 0 : 2;
+			else axis = tMax.y < tMax.z ? 1 : 2;
+
+			t = tMax[axis];
+			p[axis] += step[axis];
+			tMax[axis] += tDelta[axis];
 		}
-	}
+		while (skip && t <= dist && p[axis] >= chunkMin[axis] && p[axis] < chunkMax[axis]);
 
-	if (minDistance != dist)
-	{
-		*result = ray.origin + ray.dir * minDistance;
-		return true;
+		// Without a skip the ray took a single step along the axis.
+		if (skip) MoveAccessorTo(acc, p);
+		else MoveAccessor(acc, axis == 0 ? step.x : 0, axis == 1 ? step.y : 0, axis == 2 ? step.z : 0);
 	}
 
-	return false;
+	return info;
 }
 
-static HitInfo GetVoxelHit(GameState* state, Camera* cam, World* world)
+static HitInfo VoxelRaycast(World* world, Ray ray, float dist)
 {
-	HitInfo info = {};
-	Ray ray = ScreenCenterToRay(state, cam);
+	BlockAccessor acc = NewAccessor(world);
+	return VoxelRaycast(acc, ray, dist);
+}
 
-	vec3 point;
-	
-	if (VoxelRaycast(world, ray, 15.0f, &point))
-	{
-		info.hit = true;
-		info.hitPos = BlockPos(point + ray.dir * 0.01f);
-		point -= (ray.dir * 0.01f);
-		info.adjPos = BlockPos(point);
-		info.normal = GetV3(info.hitPos - info.adjPos);
-	}
+// Casts many rays with a shared accessor. Rays that start near each other, such as 
+// those for a search around one point, reuse the chunks the previous ray read.
+static void VoxelRaycast(World* world, Ray* rays, int count, float dist, HitInfo* hits)
+{
+	BlockAccessor acc = NewAccessor(world);
 
-	return info;
+	for (int i = 0; i < count; i++)
+		hits[i] = VoxelRaycast(acc, rays[i], dist);
+}
+
+static HitInfo GetVoxelHit(GameState* state, Camera* cam, World* world)
+{
+	Ray ray = ScreenCenterToRay(state, cam);
+	return VoxelRaycast(world, ray, 15.0f);
 }
 
 static void TeleportPlayerCallback(GameState* state, World* world)
@@ -192,6 +244,9 @@ static void TeleportPlayerCallback(GameState* state, World* world)
 	player->suspended = true;
 	player->pos = vec3(lwP.x + 0.5f, lwP.y + 1.0f, lwP.z + 0.5f);
 
+	// Bodies can't be placed relative to the new location, so they're discarded.
+	ClearBodies(*world->physics);
+
 	MoveCamera(state->camera, player->pos);
 	UpdateCameraVectors(state->camera);
 
@@ -241,7 +296,9 @@ static inline bool TestWall(vec3 delta, vec3 p, float wallP, vec3 wMin, vec3 wMa
 	return false;
 }
 
-static inline void TestCollision(World* world, Player* player, AABB a, AABB b, vec3 delta, float& tMin, vec3& normal, Block& collideBlock)
+// Sweeps box a along delta against the block box b. Walls shared with a solid 
+// neighbor can't be hit, so they are skipped.
+static inline void TestCollision(World* world, AABB a, AABB b, vec3 delta, float& tMin, vec3& normal, BlockContact& contact)
 {
 	ExpandAABB(b, a.radius);
 	ShrinkAABB(a, a.radius);
@@ -263,10 +320,9 @@ static inline void TestCollision(World* world, Player* player, AABB a, AABB b, v
 		
 		if (delta.y < 0.0f)
 		{
-			player->colFlags |= HIT_DOWN;
-			Block block = GetBlock(world, bPos);
-			player->surface = GetSurface(world, block);
-			collideBlock = block;
+			contact.colFlags |= HIT_DOWN;
+			contact.ground = GetBlock(world, bPos);
+			contact.block = contact.ground;
 		}
 	}
 
@@ -274,43 +330,69 @@ static inline void TestCollision(World* world, Player* player, AABB a, AABB b, v
 	if (IsPassable(world, down) && TestWall(delta, a.center, wMin.y, wMin, wMax, 1, 0, 2, tMin))
 	{
 		normal = vec3(0.0f, -1.0f, 0.0f);
-		player->colFlags |= HIT_UP;
-		collideBlock = GetBlock(world, bPos);
+		contact.colFlags |= HIT_UP;
+		contact.block = GetBlock(world, bPos);
 	}
 
 	// Left wall.
 	if (IsPassable(world, left) && TestWall(delta, a.center, wMin.x, wMin, wMax, 0, 1, 2, tMin))
 	{
 		normal = vec3(-1.0f, 0.0f, 0.0f);
-		player->colFlags |= HIT_SIDES;
-		collideBlock = GetBlock(world, bPos);
+		contact.colFlags |= HIT_SIDES;
+		contact.block = GetBlock(world, bPos);
 	}
 
 	// Right wall.
 	if (IsPassable(world, right) && TestWall(delta, a.center, wMax.x, wMin, wMax, 0, 1, 2, tMin))
 	{
 		normal = vec3(1.0f, 0.0f, 0.0f);
-		player->colFlags |= HIT_SIDES;
-		collideBlock = GetBlock(world, bPos);
+		contact.colFlags |= HIT_SIDES;
+		contact.block = GetBlock(world, bPos);
 	}
 
 	// Front wall.
 	if (IsPassable(world, front) && TestWall(delta, a.center, wMax.z, wMin, wMax, 2, 0, 1, tMin))
 	{
 		normal = vec3(0.0f, 0.0f, 1.0f);
-		player->colFlags |= HIT_SIDES;
-		collideBlock = GetBlock(world, bPos);
+		contact.colFlags |= HIT_SIDES;
+		contact.block = GetBlock(world, bPos);
 	}
 
 	// Back wall.
 	if (IsPassable(world, back) && TestWall(delta, a.center, wMin.z, wMin, wMax, 2, 0, 1, tMin))
 	{
 		normal = vec3(0.0f, 0.0f, -1.0f);
-		player->colFlags |= HIT_SIDES;
-		collideBlock = GetBlock(world, bPos);
+		contact.colFlags |= HIT_SIDES;
+		contact.block = GetBlock(world, bPos);
 	}
 }
 
+// Returns the offset that keeps a box that hit a wall slightly away from it, so 
+// that the next sweep doesn't start inside the wall.
+static inline vec3 WallOffset(vec3 normal, vec3 delta)
+{
+	vec3 nOffset = (normal * WALL_EPSILON);
+	vec3 dOffset = (normalize(delta) * -WALL_EPSILON);
+
+	float offX = fabs(nOffset.x) > fabs(dOffset.x) ? nOffset.x : dOffset.x;
+	float offY = fabs(nOffset.y) > fabs(dOffset.y) ? nOffset.y : dOffset.y;
+	float offZ = fabs(nOffset.z) > fabs(dOffset.z) ? nOffset.z : dOffset.z;
+
+	return vec3(offX, offY, offZ);
+}
+
+// Sorts collision candidates so that the nearest are tested first.
+template <typename Colliders>
+static inline void SortColliders(Colliders& colliders, vec3 pos)
+{
+	sort(colliders.begin(), colliders.end(), [pos](auto a, auto b) 
+    { 
+        float distA = distance2(a.center, pos);
+        float distB = distance2(b.center, pos);
+		return distA < distB;
+    });
+}
+
 static void ApplyBlockSurface(Player* player, vec3 accel, float deltaTime)
 {
 	switch (player->surface)
@@ -363,8 +445,6 @@ static void MovePlayer(GameState* state, World* world, vec3 accel, float deltaTi
 	vec3 target = player->pos + delta;
 	AABB playerBB = GetPlayerAABB(player);
 
-	player->colFlags = HIT_NONE;
-
 	// Player size in blocks.
 	ivec3 bSize = CeilToInt(playerBB.radius * 2.0f);
 
@@ -387,6 +467,9 @@ static void MovePlayer(GameState* state, World* world, vec3 accel, float deltaTi
 	player->lowerOverlap.clear();
 	player->upperOverlap.clear();
 
+	ScratchScope scratch;
+	ArenaVector<AABB> possibleCollides(scratch.arena);
+
 	for (int z = minZ; z <= maxZ; z++)
 	{
 		for (int y = minY; y <= maxY; y++)
@@ -398,7 +481,7 @@ static void MovePlayer(GameState* state, World* world, vec3 accel, float deltaTi
 				if (!IsPassable(world, block))
 				{
 					AABB bb = AABBFromCorner(vec3(x, y, z), vec3(1.0f));
-					player->possibleCollides.push_back(bb);
+					possibleCollides.push_back(bb);
 				}
 				else if (block != BLOCK_AIR)
 				{
@@ -414,45 +497,37 @@ static void MovePlayer(GameState* state, World* world, vec3 accel, float deltaTi
 		}
 	}
 
-	sort(player->possibleCollides.begin(), player->possibleCollides.end(), [player](auto a, auto b) 
-    { 
-        float distA = distance2(a.center, player->pos);
-        float distB = distance2(b.center, player->pos);
-		return distA < distB;
-    });
+	SortColliders(possibleCollides, player->pos);
 
 	float tRemaining = 1.0f;
+	BlockContact contact = {};
 
 	for (int it = 0; it < 3 && tRemaining > 0.0f; it++)
 	{
 		float tMin = 1.0f;
 		vec3 normal = vec3(0.0f);
 
-		Block collideBlock = BLOCK_AIR;
+		contact.block = BLOCK_AIR;
 
-		for (int i = 0; i < player->possibleCollides.size(); i++)
+		for (int i = 0; i < possibleCollides.size(); i++)
 		{
-			AABB bb = player->possibleCollides[i];
-			TestCollision(world, player, playerBB, bb, delta, tMin, normal, collideBlock);
+			AABB bb = possibleCollides[i];
+			TestCollision(world, playerBB, bb, delta, tMin, normal, contact);
 	 	}
 
-	 	player->pos += delta * tMin;
+	 	player->colFlags = contact.colFlags;
 
-	 	if (normal != vec3(0.0f))
-	 	{
-	 		vec3 nOffset = (normal * WALL_EPSILON);
-	 		vec3 dOffset = (normalize(delta) * -WALL_EPSILON);
+	 	if (contact.colFlags & HIT_DOWN)
+	 		player->surface = GetSurface(world, contact.ground);
 
-	 		float offX = fabs(nOffset.x) > fabs(dOffset.x) ? nOffset.x : dOffset.x;
-	 		float offY = fabs(nOffset.y) > fabs(dOffset.y) ? nOffset.y : dOffset.y;
-	 		float offZ = fabs(nOffset.z) > fabs(dOffset.z) ? nOffset.z : dOffset.z;
+	 	player->pos += delta * tMin;
 
-	 		player->pos += vec3(offX, offY, offZ);
-	 	}
+	 	if (normal != vec3(0.0f))
+	 		player->pos += WallOffset(normal, delta);
 
 	 	playerBB = GetPlayerAABB(player);
 
-	 	GetCollideFunc(world, collideBlock)(state, world, delta, normal, collideBlock);
+	 	GetCollideFunc(world, contact.block)(state, world, delta, normal, contact.block);
 
 	 	delta -= (delta * tMin);
 	 	tRemaining -= (tMin * tRemaining);
@@ -460,8 +535,6 @@ static void MovePlayer(GameState* state, World* world, vec3 accel, float deltaTi
 
 	if (!(player->colFlags & HIT_DOWN))
 		player->surface = SURFACE_NORMAL;
-
-    player->possibleCollides.clear();
 }
 
 static void IgnoreCollideFunc(GameState*, World*, vec3&, vec3, Block) {}
@@ -708,6 +781,7 @@ static void Simulate(GameState* state, World* world, Player* player, float delta
 	
 	SetMoveParams(world, player, input, accel, gravity);
 	MovePlayer(state, world, accel, deltaTime, gravity);
+	StepPhysics(state, world, *world->physics, deltaTime);
 
 	// Delete impassible blocks the player has entered.
 	vec3& p = player->pos;
@@ -786,6 +860,7 @@ static vec2 TryFindLand(World* world)
 {
 	ChunkGroup* group = GetGroup(world, world->loadRange, world->loadRange);
 
+
 	vec2 center = vec2(CHUNK_SIZE_H * 0.5f);
 	float closestDist = FLT_MAX;
 	vec2 closestP = center;
@@ -832,10 +907,10 @@ static void SpawnPlayer(GameState* state, World* world, Player* player, Rectf sp
 
 	Ray ray = { vec3(spawn.x, WORLD_BLOCK_HEIGHT, spawn.z), vec3(0.0, -1.0f, 0.0f) };
 
-	vec3 loc;
+	HitInfo hit = VoxelRaycast(world, ray, WORLD_BLOCK_HEIGHT);
 	
-	if (VoxelRaycast(world, ray, WORLD_BLOCK_HEIGHT, &loc))
-		spawn.y = loc.y + 2.0f;
+	if (hit.hit)
+		spawn.y = hit.hitPos.y + 3.0f;
 	else spawn.y = 258.0f;
 	
 	player->pos = spawn;
@@ -13,12 +13,16 @@ enum CollisionFlags
     HIT_SIDES = 4
 };
 
+// Result of a voxel raycast. The adjacent position is the block in front of the hit 
+// face, and the normal points out of that face.
 struct HitInfo
 {
     bool hit;
+    Block block;
     ivec3 hitPos;
     ivec3 adjPos;
     vec3 normal;
+    float dist;
 };
 
 struct AABB
@@ -27,6 +31,14 @@ struct AABB
     vec3 radius;
 };
 
+// Collision results gathered while sweeping a box through the world's blocks. The 
+// block is the last one hit, and ground is the last block landed on.
+struct BlockContact
+{
+    uint8_t colFlags;
+    Block block, ground;
+};
+
 struct MinMaxAABB
 {
     vec3 min;
@@ -58,8 +70,6 @@ struct Player
     vector<Block> upperOverlap;
     vector<Block> lowerOverlap;
 
-    vector<AABB> possibleCollides;
-
     int health, maxHealth;
 
     Color damageFade;
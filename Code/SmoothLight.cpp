@@ -0,0 +1,87 @@
+//
+// Gamecraft
+//
+
+// Sample indices for the four vertices of each face, in BlockFace order and in the 
+// vertex order used by the mesher. For each face there are four rows: the block the 
+// face looks into (a), the two edge neighbors (b, c) and the corner neighbor (d).
+alignas(16) static const int32_t faceSamples[6][4][4] =
+{
+    { { 16, 16, 16, 16 }, { 17, 17, 15, 15 }, { 7, 25, 25, 7 }, { 8, 26, 24, 6 } },
+    { { 10, 10, 10, 10 }, { 9, 9, 11, 11 }, { 1, 19, 19, 1 }, { 0, 18, 20, 2 } },
+    { { 22, 22, 22, 22 }, { 21, 21, 23, 23 }, { 19, 25, 25, 19 }, { 18, 24, 26, 20 } },
+    { { 4, 4, 4, 4 }, { 5, 5, 3, 3 }, { 1, 7, 7, 1 }, { 2, 8, 6, 0 } },
+    { { 14, 14, 14, 14 }, { 11, 17, 17, 11 }, { 23, 23, 5, 5 }, { 20, 26, 8, 2 } },
+    { { 12, 12, 12, 12 }, { 9, 15, 15, 9 }, { 3, 3, 21, 21 }, { 0, 6, 24, 18 } }
+};
+
+// Blocks away from the chunk's edges read their neighbors directly. Others are 
+// rebased into the neighboring chunks.
+static void GatherBlockLight(World* world, Chunk* chunk, int x, int y, int z, BlockLightSamples& samples)
+{
+    bool interior = x > 0 && x < CHUNK_SIZE_H - 1 && y > 0 && y < CHUNK_SIZE_V - 1 && z > 0 && z < CHUNK_SIZE_H - 1;
+    int i = 0;
+
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++, i++)
+            {
+                Block block;
+
+                if (interior)
+                {
+                    block = GetBlock(chunk, x + dx, y + dy, z + dz);
+                    samples.light[i] = GetFinalLight(chunk, x + dx, y + dy, z + dz);
+                }
+                else
+                {
+                    RebasedPos p = Rebase(world, chunk->lcPos, x + dx, y + dy, z + dz);
+                    block = GetBlockSafe(p);
+                    samples.light[i] = GetFinalLight(p.chunk, p.rX, p.rY, p.rZ);
+                }
+
+                samples.opaque[i] = IsOpaque(world, block) ? -1 : 0;
+            }
+        }
+    }
+}
+
+// Computes the smooth light for the 24 face vertices of a block, one face per 
+// iteration. Each vertex averages the four samples around it, or only a, b and c 
+// when both edge neighbors are opaque. Matches the results of VertexLight.
+static void ComputeBlockLight(BlockLightSamples& samples, Colori* out)
+{
+    const int* light = (const int*)samples.light;
+    const int* opaque = samples.opaque;
+
+    // Multiplying by 21846 and keeping the high 16 bits divides by 3 exactly 
+    // for sums of three 8-bit values.
+    __m256i third = _mm256_set1_epi16(21846);
+
+    for (int f = 0; f < 6; f++)
+    {
+        __m128i ia = _mm_load_si128((__m128i*)faceSamples[f][0]);
+        __m128i ib = _mm_load_si128((__m128i*)faceSamples[f][1]);
+        __m128i ic = _mm_load_si128((__m128i*)faceSamples[f][2]);
+        __m128i id = _mm_load_si128((__m128i*)faceSamples[f][3]);
+
+        // Four vertices with four 16-bit channels each.
+        __m256i a = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(light, ia, 4));
+        __m256i b = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(light, ib, 4));
+        __m256i c = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(light, ic, 4));
+        __m256i d = _mm256_cvtepu8_epi16(_mm_i32gather_epi32(light, id, 4));
+
+        __m128i blocked = _mm_and_si128(_mm_i32gather_epi32(opaque, ib, 4), _mm_i32gather_epi32(opaque, ic, 4));
+        __m256i useThree = _mm256_cvtepi8_epi16(blocked);
+
+        __m256i sum3 = _mm256_add_epi16(_mm256_add_epi16(a, b), c);
+        __m256i avg4 = _mm256_srli_epi16(_mm256_add_epi16(sum3, d), 2);
+        __m256i avg3 = _mm256_mulhi_epu16(sum3, third);
+        __m256i avg = _mm256_blendv_epi8(avg4, avg3, useThree);
+
+        __m128i result = _mm_packus_epi16(_mm256_castsi256_si128(avg), _mm256_extracti128_si256(avg, 1));
+        _mm_storeu_si128((__m128i*)(out + f * 4), result);
+    }
+}
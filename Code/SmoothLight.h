@@ -0,0 +1,14 @@
+//
+// Gamecraft
+//
+
+// Light and opacity of the 3x3x3 blocks centered on a block, indexed by 
+// (dx + 1) + 3 * ((dy + 1) + 3 * (dz + 1)). Opaque entries are -1, others 0.
+struct BlockLightSamples
+{
+    Colori light[27];
+    int32_t opaque[27];
+};
+
+static void GatherBlockLight(World* world, Chunk* chunk, int x, int y, int z, BlockLightSamples& samples);
+static void ComputeBlockLight(BlockLightSamples& samples, Colori* out);
@@ -173,4 +173,7 @@ static void MergeSort(T* items, int size)
 	MergeSort(right, rightSize);
 
 	Merge(items, left, leftSize, right, rightSize);
+
+	delete[] left;
+	delete[] right;
 }
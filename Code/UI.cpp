@@ -536,11 +536,22 @@ static void CreateCommandHelp(CommandProcessor& processor)
     CommandHelpText("teleport <x> <y> <z>:", "teleports the player to the given location.");
     CommandHelpText("teleport home:", "teleports the player to the saved home location.");
     CommandHelpText("sethome:", "sets the saved home position to the player's current location.");
+    CommandHelpText("groupcache <value>:", "sets the memory budget in megabytes for recently unloaded terrain. 0 disables the cache.");
 
     #if DEBUG_SERVICES
     CommandHelpText("outlines:", "toggle debug chunk outlines.");
     CommandHelpText("profiler <start, stop, hide>:", "start, stop, or hide the profiler.");
     CommandHelpText("p:", "quickly toggle the profiler between paused and recording state.");
+    CommandHelpText("profile <export, baseline, reset>:", "writes profiler stats to ProfileStats.csv, saves them as the regression baseline, or clears them.");
+    CommandHelpText("memory:", "writes the memory tracked for each subsystem to Memory.csv.");
+    CommandHelpText("memory peak:", "resets the peak of each memory tag to its current size.");
+    CommandHelpText("memory traffic:", "shows the average heap traffic per frame since it was last shown.");
+    CommandHelpText("memory budget <tag> <mb>:", "logs when the tag goes over the given megabytes. 0 removes the budget.");
+    CommandHelpText("trace <frames>:", "records the given number of frames (300 by default) to Trace.json for chrome://tracing or Perfetto.");
+    #endif
+
+    #if PIPELINE_STATS
+    CommandHelpText("pipeline <reset, log>:", "clears the pipeline latency stats, or toggles writing them to Pipeline.csv every 5 seconds.");
     #endif
 
     ImGui::End();
@@ -631,6 +642,53 @@ static double GetFPS()
 
 #if DEBUG_SERVICES
 
+// Lists the slowest records over the last PROFILE_STAT_FRAMES frames to the right of 
+// the chart. Records slower than the baseline are shown in red.
+static void CreateProfileStatsUI(float minX)
+{
+    static vector<RecordStats> stats;
+    ComputeProfileStats(stats);
+
+    char* headers[] = { "Record", "Calls", "Mean", "Self", "Min", "P99", "Max", "Base" };
+    float columns[] = { 0.0f, 180.0f, 230.0f, 285.0f, 340.0f, 395.0f, 450.0f, 505.0f };
+
+    float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+
+    int headerCount = ArrayCount(headers);
+
+    for (int c = 0; c < headerCount; c++)
+    {
+        ImGui::SetCursorPos(ImVec2(minX + columns[c], 5.0f));
+        ImGui::Text(headers[c]);
+    }
+
+    ImVec4 white = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+    ImVec4 red = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+
+    int count = Min((int)stats.size(), 32);
+
+    for (int i = 0; i < count; i++)
+    {
+        RecordStats& s = stats[i];
+        ImVec4 color = s.regressed ? red : white;
+
+        float values[] = { s.calls, s.mean, s.self, s.min, s.p99, s.max, s.baseline };
+        float y = 5.0f + lineHeight * (i + 1);
+
+        ImGui::SetCursorPos(ImVec2(minX, y));
+        ImGui::TextColored(color, "%s", g_debugTable.records[s.recordID].func);
+
+        for (int c = 0; c < headerCount - 1; c++)
+        {
+            ImGui::SetCursorPos(ImVec2(minX + columns[c + 1], y));
+
+            if (values[c] < 0.0f)
+                ImGui::TextColored(color, "-");
+            else ImGui::TextColored(color, "%.2f", values[c]);
+        }
+    }
+}
+
 static void CreateProfilerUI(ivec2 windowSize)
 {
     DebugTable& t = g_debugTable;
@@ -725,8 +783,71 @@ static void CreateProfilerUI(ivec2 windowSize)
         if (t.profilerState == PROFILER_STOPPED)
             t.profilerState = PROFILER_RECORD_ONCE;
     }
+
+    CreateProfileStatsUI(chartMinX + chartWidth + 20.0f);
 }
 
+static void CreateMemoryUI()
+{
+    MultiSpacing(2);
+    ImGui::Text("Memory (MB):");
+
+    ImVec4 white = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+    ImVec4 red = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+
+    for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+    {
+        MemoryTagStats& stats = g_memory.tags[i];
+
+        if (stats.peak == 0)
+            continue;
+
+        ImVec4 color = g_memory.overBudget[i] ? red : white;
+
+        if (g_memory.budgets[i] > 0)
+        {
+            ImGui::TextColored(color, "%s: %.1f (peak %.1f, budget %.1f), %d allocations", g_memoryTagNames[i], 
+                stats.bytes / (1024.0 * 1024.0), stats.peak / (1024.0 * 1024.0), g_memory.budgets[i] / (1024.0 * 1024.0), stats.count);
+        }
+        else
+        {
+            ImGui::TextColored(color, "%s: %.1f (peak %.1f), %d allocations", g_memoryTagNames[i], 
+                stats.bytes / (1024.0 * 1024.0), stats.peak / (1024.0 * 1024.0), stats.count);
+        }
+    }
+
+    #if HEAP_TRAFFIC
+    HeapTrafficStats& heap = g_heapTraffic;
+    ImGui::Text("Heap traffic last frame: %lli allocations (%.1f KB) on the main thread, %lli (%.1f KB) on all threads",
+        heap.mainFrame.allocs, heap.mainFrame.bytes / 1024.0, heap.allFrame.allocs, heap.allFrame.bytes / 1024.0);
+    #endif
+}
+
+#if PIPELINE_STATS
+
+static void CreatePipelineUI()
+{
+    PipelineStats& stats = g_pipelineStats;
+
+    MultiSpacing(2);
+    ImGui::Text("Pipeline Latency (ms):");
+
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++)
+    {
+        LatencyHistogram& hist = stats.stages[i];
+
+        ImGui::Text("%s: %u, p50 %.1f, p95 %.1f, p99 %.1f, max %.1f", g_pipelineStageNames[i], hist.total, 
+            LatencyPercentile(hist, 0.5f), LatencyPercentile(hist, 0.95f), LatencyPercentile(hist, 0.99f), hist.max);
+    }
+
+    ImGui::Text("Async Queued: %d (max %d), Destroy Queued: %d (max %d)", stats.asyncQueued, stats.maxAsyncQueued, 
+        stats.destroyQueued, stats.maxDestroyQueued);
+    ImGui::Text("To Load: %d, Loading: %d, To Check: %d, To Fill: %d, Work: %d", stats.groupsToLoad, stats.loadsInFlight, 
+        stats.groupsToCheck, stats.chunksToFill, stats.workCount);
+}
+
+#endif
+
 #endif
 
 static void CreateHUD(GameState* state, World* world)
@@ -787,7 +908,17 @@ static void CreateHUD(GameState* state, World* world)
 
         MultiSpacing(2);
         ImGui::Text("Visible Meshes: %d", g_debugTable.visibleMeshes);
+        ImGui::Text("Edit Latency: %.1f ms (max %.1f ms)", g_debugTable.editLatency, g_debugTable.maxEditLatency);
+
+        GroupCache* cache = world->groupCache;
+        ImGui::Text("Group Cache: %d groups, %.1f / %.1f MB, %d hits, %d misses", cache->count, 
+            cache->bytes / (1024.0 * 1024.0), cache->budget / (1024.0 * 1024.0), cache->hits, cache->misses);
+
+        #if PIPELINE_STATS
+        CreatePipelineUI();
+        #endif
 
+        CreateMemoryUI();
         CreateProfilerUI(size);
 
         #endif
@@ -913,7 +1044,7 @@ static void CreateUI(GameState* state, GLFWwindow* window, World* world, WorldCo
 static void SaveGameSettings(GameState* state)
 {
     char path[MAX_PATH];
-    sprintf(path, "%s\\Settings.txt", state->savePath);
+    sprintf(path, "%s/Settings.txt", state->savePath);
 
     SettingsFileData settings = { state->audio.muted, state->renderer.samplesAA };
     WriteBinary(path, (char*)&settings, sizeof(SettingsFileData));
@@ -922,7 +1053,7 @@ static void SaveGameSettings(GameState* state)
 static void LoadGameSettings(GameState* state)
 {
     char path[MAX_PATH];
-    sprintf(path, "%s\\Settings.txt", state->savePath);
+    sprintf(path, "%s/Settings.txt", state->savePath);
 
     Renderer& rend = state->renderer;
     
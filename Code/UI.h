@@ -8,7 +8,10 @@ struct Renderer;
 
 struct UI
 {
+	#if !HEADLESS
 	GLFWcursor* cursors[ImGuiMouseCursor_COUNT];
+	#endif
+
 	bool mouseJustPressed[2];
 	GLuint fontTexture, va, vb, ib;
 };
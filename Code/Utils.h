@@ -338,21 +338,18 @@ static inline string Trim(string& str)
     return string();
 }
 
-static vector<char*> Split(string& str, char delim)
+// Splits the string in place, adding the parts to the given vector.
+template <typename Vector>
+static void Split(string& str, char delim, Vector& parts)
 {
     char delims[2] = {};
     delims[0] = delim;
 
-    char* part;
-
-    vector<char*> parts;
-    part = strtok((char*)str.c_str(), delims);
+    char* part = strtok((char*)str.c_str(), delims);
 
     while (part != nullptr)
     {
         parts.push_back(part);
         part = strtok(nullptr, delims);
     }
-
-    return parts;
 }
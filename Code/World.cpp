@@ -43,10 +43,12 @@ static inline bool ChunkInsideWorld(World* world, int x, int y, int z)
     return GroupInsideWorld(world, x, z) && ChunkInsideGroup(y);
 }
 
+// Edge groups have a neighbor outside the load area. They are loaded so that 
+// their neighbors can be processed, but aren't processed themselves.
 static inline bool IsEdgeChunk(World* world, Chunk* chunk)
 {
     LChunkP p = chunk->lcPos;
-    return p.x == 0 || p.z == 0 || p.x == world->size - 1 || p.z == world->size - 1;
+    return !HasFlag(world->loadArea[p.z * world->size + p.x], LOAD_AREA_INTERIOR);
 }
 
 static inline bool IsEdgeGroup(World* world, ChunkGroup* group)
@@ -477,6 +479,137 @@ static inline Block GetBlock(World* world, LWorldP pos)
     return GetBlock(world, pos.x, pos.y, pos.z);
 }
 
+static inline BlockAccessor NewAccessor(World* world)
+{
+    BlockAccessor acc = {};
+    acc.world = world;
+    return acc;
+}
+
+static inline void SetAccessorChunk(BlockAccessor& acc, ChunkGroup* group, int lcY)
+{
+    if (group == nullptr || group->state == GROUP_DEFAULT)
+    {
+        acc.group = nullptr;
+        acc.chunk = nullptr;
+        return;
+    }
+
+    acc.group = group;
+    acc.chunk = GetChunk(group, lcY);
+    acc.index = BlockIndex(acc.rel.x, acc.rel.y, acc.rel.z);
+}
+
+static void MoveAccessorTo(BlockAccessor& acc, int lwX, int lwY, int lwZ)
+{
+    World* world = acc.world;
+
+    int dX = lwX - acc.pos.x, dY = lwY - acc.pos.y, dZ = lwZ - acc.pos.z;
+    RelP rel = ivec3(acc.rel.x + dX, acc.rel.y + dY, acc.rel.z + dZ);
+
+    acc.pos.x = lwX;
+    acc.pos.y = lwY;
+    acc.pos.z = lwZ;
+
+    if (acc.chunk != nullptr)
+    {
+        bool insideH = (uint32_t)rel.x < CHUNK_SIZE_H && (uint32_t)rel.z < CHUNK_SIZE_H;
+
+        if (insideH && (uint32_t)rel.y < CHUNK_SIZE_V)
+        {
+            acc.rel = rel;
+            acc.index += dX + dY * CHUNK_SIZE_H + dZ * (CHUNK_SIZE_H * CHUNK_SIZE_V);
+            return;
+        }
+
+        if (lwY < 0 || lwY >= WORLD_BLOCK_HEIGHT)
+        {
+            acc.group = nullptr;
+            acc.chunk = nullptr;
+            return;
+        }
+
+        acc.rel = ivec3(rel.x & CHUNK_H_MASK, lwY & CHUNK_V_MASK, rel.z & CHUNK_H_MASK);
+
+        // Vertical moves stay within the cached group.
+        if (insideH)
+        {
+            SetAccessorChunk(acc, acc.group, lwY >> CHUNK_V_BITS);
+            return;
+        }
+
+        LChunkP lcPos = acc.chunk->lcPos;
+        int lcX = lcPos.x + (rel.x >> CHUNK_H_BITS);
+        int lcZ = lcPos.z + (rel.z >> CHUNK_H_BITS);
+
+        SetAccessorChunk(acc, GetGroupSafe(world, lcX, lcZ), lwY >> CHUNK_V_BITS);
+        return;
+    }
+
+    if (lwY < 0 || lwY >= WORLD_BLOCK_HEIGHT || !BlockInsideWorldH(world, lwX, lwZ))
+        return;
+
+    LChunkP lcPos = LWorldToLChunkP(lwX, lwY, lwZ);
+    acc.rel = LWorldToRelP(lwX, lwY, lwZ);
+
+    SetAccessorChunk(acc, GetGroup(world, lcPos.x, lcPos.z), lcPos.y);
+}
+
+static inline void MoveAccessorTo(BlockAccessor& acc, LWorldP pos)
+{
+    MoveAccessorTo(acc, pos.x, pos.y, pos.z);
+}
+
+// A step that stays within the chunk only offsets the index.
+static inline void MoveAccessor(BlockAccessor& acc, int dX, int dY, int dZ)
+{
+    int rX = acc.rel.x + dX, rY = acc.rel.y + dY, rZ = acc.rel.z + dZ;
+
+    if (acc.chunk != nullptr && (uint32_t)rX < CHUNK_SIZE_H && (uint32_t)rY < CHUNK_SIZE_V && (uint32_t)rZ < CHUNK_SIZE_H)
+    {
+        acc.rel.x = rX;
+        acc.rel.y = rY;
+        acc.rel.z = rZ;
+
+        acc.pos.x += dX;
+        acc.pos.y += dY;
+        acc.pos.z += dZ;
+
+        acc.index += dX + dY * CHUNK_SIZE_H + dZ * (CHUNK_SIZE_H * CHUNK_SIZE_V);
+        return;
+    }
+
+    MoveAccessorTo(acc, acc.pos.x + dX, acc.pos.y + dY, acc.pos.z + dZ);
+}
+
+static inline void MoveAccessor(BlockAccessor& acc, ivec3 dir)
+{
+    MoveAccessor(acc, dir.x, dir.y, dir.z);
+}
+
+// Returns the block at the accessor's position, matching GetBlock for positions 
+// that aren't loaded.
+static inline Block GetBlock(BlockAccessor& acc)
+{
+    if (acc.chunk == nullptr)
+        return acc.pos.y < 0 ? BLOCK_KILL_ZONE : BLOCK_AIR;
+
+    Block block = acc.chunk->blocks[acc.index];
+    assert(block >= 0 && block < BLOCK_COUNT);
+    return block;
+}
+
+static inline Block GetBlock(BlockAccessor& acc, int lwX, int lwY, int lwZ)
+{
+    MoveAccessorTo(acc, lwX, lwY, lwZ);
+    return GetBlock(acc);
+}
+
+static inline Block GetBlock(BlockAccessor& acc, LWorldP pos)
+{
+    return GetBlock(acc, pos.x, pos.y, pos.z);
+}
+
 static inline void SetBlock(Chunk* chunk, int index, Block block)
 {
     assert(block >= 0 && block < BLOCK_COUNT);
@@ -504,10 +637,28 @@ static inline void SetBlock(ChunkGroup* group, int rX, int lwY, int rZ, Block bl
     SetBlock(chunk, rX, lwY & CHUNK_V_MASK, rZ, block);
 }
 
+// Flags the section containing the given y value, relative to the chunk, for rebuilding.
+static inline void FlagChunkDirty(Chunk* chunk, int rY)
+{
+    chunk->pendingUpdate = true;
+    chunk->dirtySections |= 1 << (rY >> CHUNK_SECTION_BITS);
+    chunk->version++;
+}
+
+static inline void FlagChunkEdited(Chunk* chunk, int rY, double time)
+{
+    FlagChunkDirty(chunk, rY);
+
+    if (chunk->editTime == 0.0)
+        chunk->editTime = time;
+}
+
 static void FlagChunkForUpdate(World* world, Chunk* chunk, LChunkP lP, RelP rP, bool modified = true)
 {
+    double time = glfwGetTime();
+
     chunk->modified = modified;
-    chunk->pendingUpdate = true;
+    chunk->edited = true;
 
     for (int z = -1; z <= 1; z++)
     {
@@ -518,6 +669,9 @@ static void FlagChunkForUpdate(World* world, Chunk* chunk, LChunkP lP, RelP rP,
                 RelP r = rP + ivec3(x, y, z);
                 LChunkP target = lP;
 
+                // Position of the block within the target chunk's sections.
+                int rY = Clamp(r.y, 0, CHUNK_V_MASK);
+
                 if (r.x < 0) target += DIR_LEFT;
                 else if (r.x >= CHUNK_SIZE_H) target += DIR_RIGHT;
 
@@ -529,17 +683,23 @@ static void FlagChunkForUpdate(World* world, Chunk* chunk, LChunkP lP, RelP rP,
                     LChunkP temp = target + DIR_DOWN;
 
                     if (temp.y >= 0)
+                    {
                         target = temp;
+                        rY = CHUNK_V_MASK;
+                    }
                 }
                 else if (r.y >= CHUNK_SIZE_V)
                 {
                     LChunkP temp = target + DIR_UP;
 
                     if (temp.y < WORLD_CHUNK_HEIGHT)
+                    {
                         target = temp;
+                        rY = 0;
+                    }
                 }
 
-                GetChunk(world, target)->pendingUpdate = true;
+                FlagChunkEdited(GetChunk(world, target), rY, time);
             }
         }
     }
@@ -609,19 +769,49 @@ static void LoadGroup(GameState*, World* world, void* groupPtr)
 {
     ChunkGroup* group = (ChunkGroup*)groupPtr;
 
-    if (!LoadGroupFromDisk(world, group))
+    // Groups loaded entirely from disk restore their surface along with their blocks.
+    if (group->cached != nullptr)
+        LoadGroupFromCache(group);
+    else if (!LoadGroupFromDisk(world, group))
+    {
         world->biomes[world->properties.biome].func(world, group);
+        ComputeSurface(group);
+    }
 
-    ComputeSurface(group);
+    ComputeMaxSurface(group);
     group->state = GROUP_LOADED;
 }
 
-static void OnGroupLoaded(GameState*, World* world, void*)
+// Queues the group and its neighbors to be checked on the next update, as whether 
+// a group can be preprocessed or shown depends on the states of its neighbors.
+static void FlagGroupChanged(World* world, ChunkGroup* group)
+{
+    LChunkP p = group->chunks->lcPos;
+
+    for (int i = 0; i < 9; i++)
+    {
+        LChunkP next = p + DIRS_2[i];
+        ChunkGroup* adj = GetGroupSafe(world, next.x, next.z);
+
+        if (adj != nullptr && !adj->pendingCheck)
+        {
+            adj->pendingCheck = true;
+            world->groupsToCheck.push_back(adj);
+        }
+    }
+}
+
+static void OnGroupLoaded(GameState*, World* world, void* groupPtr)
 {
+    ChunkGroup* group = (ChunkGroup*)groupPtr;
+    PIPELINE_STAGE(PIPELINE_LOAD, group->stageTime);
+
     world->workCount--;
+    world->loadsInFlight--;
+    FlagGroupChanged(world, group);
 }
 
-static ChunkGroup* CreateChunkGroup(GameState* state, World* world, int lcX, int lcZ, int cX, int cZ)
+static ChunkGroup* CreateChunkGroup(World* world, int lcX, int lcZ, int cX, int cZ)
 {
     int index = GroupIndex(world, lcX, lcZ);
 	ChunkGroup* group = world->groups[index];
@@ -642,8 +832,12 @@ static ChunkGroup* CreateChunkGroup(GameState* state, World* world, int lcX, int
             chunk->group = group;
         }
 
+        PIPELINE_BEGIN(group->createTime);
+        PIPELINE_BEGIN(group->stageTime);
+
+        // The load is queued by ScheduleGroupLoads.
         world->workCount++;
-        QueueAsync(state, LoadGroup, world, group, OnGroupLoaded);
+        world->groupsToLoad.push_back(group);
 
 		world->groups[index] = group;
 	}
@@ -666,10 +860,16 @@ static void DestroyGroup(GameState* state, World* world, void* groupPtr)
     world->groupPool.Return(group);
 }
 
+static void OnGroupSaved(GameState* state, World* world, void* groupPtr)
+{
+    world->pendingSaves--;
+    DestroyGroup(state, world, groupPtr);
+}
+
 // To allow "infinite" terrain, the world is always located near the origin.
 // This function fills the world near the origin based on the reference
 // world position within the world.
-static void ShiftWorld(GameState* state, World* world)
+static void ShiftWorld(GameState*, World* world)
 {
     // Return all chunks in the active area to the hash table.
 	for (int i = 0; i < world->totalGroups; i++)
@@ -686,6 +886,9 @@ static void ShiftWorld(GameState* state, World* world)
 	{
 		for (int x = 0; x < world->size; x++)
         {
+            if (!HasFlag(world->loadArea[GroupIndex(world, x, z)], LOAD_AREA_INSIDE))
+                continue;
+
             int wX = world->ref.x + x;
             int wZ = world->ref.z + z;
 
@@ -707,24 +910,44 @@ static void ShiftWorld(GameState* state, World* world)
 		}
 	}
 
-    vec2 playerChunk = vec2(world->loadRange, world->loadRange);
-
-    sort(groupsToCreate.begin(), groupsToCreate.end(), [playerChunk](auto a, auto b) 
-    { 
-        float distA = distance2(vec2(a.x, a.y), playerChunk);
-        float distB = distance2(vec2(b.x, b.y), playerChunk);
-        return distA < distB;
-    });
-
     for (int i = 0; i < groupsToCreate.size(); i++)
     {
         // Encoded ivec4 values as x, y = local x, z and z, w = world x, z.
         ivec4 p = groupsToCreate[i];
-        CreateChunkGroup(state, world, p.x, p.y, p.z, p.w);
+        CreateChunkGroup(world, p.x, p.y, p.z, p.w);
     }
 
     groupsToCreate.clear();
 
+    // Neighbors and edge groups change with the shift, so every group is checked again.
+    world->groupsToCheck.clear();
+
+    for (int i = 0; i < world->totalGroups; i++)
+    {
+        ChunkGroup* group = world->groups[i];
+
+        if (group == nullptr)
+            continue;
+
+        group->renderable = false;
+        group->pendingCheck = true;
+        world->groupsToCheck.push_back(group);
+    }
+
+    world->renderListChanged = true;
+
+    // Drop chunks waiting to be filled whose groups are leaving the world.
+    auto& fill = world->chunksToFill;
+    int remaining = 0;
+
+    for (int i = 0; i < fill.size(); i++)
+    {
+        if (fill[i]->group->active)
+            fill[remaining++] = fill[i];
+    }
+
+    fill.resize(remaining);
+
     // Any remaining chunks in the hash table are outside of the loaded area range
     // and should be returned to the pool.
 	for (int c = 0; c < GROUP_HASH_SIZE; c++)
@@ -738,6 +961,164 @@ static void ShiftWorld(GameState* state, World* world)
 	}
 }
 
+// Estimates how soon the player will need the group: the time to reach it moving 
+// toward it at the player's current speed plus a base speed, doubled for groups 
+// outside the view. Groups next to the player always come first.
+static float StreamPriority(World* world, Camera* cam, Player* player, ChunkGroup* group)
+{
+    LWorldP lwP = group->chunks->lwPos;
+    vec2 center = vec2(lwP.x, lwP.z) + (CHUNK_SIZE_H * 0.5f);
+
+    vec2 origin;
+
+    if (player->spawned)
+        origin = vec2(player->pos.x, player->pos.z);
+    else origin = vec2((world->loadRange + 0.5f) * CHUNK_SIZE_H);
+
+    vec2 toGroup = center - origin;
+    float dist = length(toGroup);
+
+    if (dist < CHUNK_SIZE_H * 1.5f)
+        return 0.0f;
+
+    vec2 velocity = vec2(player->velocity.x, player->velocity.z);
+    float closing = Max(dot(velocity, toGroup) / dist, 0.0f);
+    float time = dist / (STREAM_BASE_SPEED + closing);
+
+    vec3 min = vec3(lwP.x, 0.0f, lwP.z);
+    vec3 max = min + vec3(CHUNK_SIZE_H, WORLD_BLOCK_HEIGHT, CHUNK_SIZE_H);
+
+    if (TestFrustum(cam, min, max) == FRUSTUM_INVISIBLE)
+        time *= 2.0f;
+
+    return time;
+}
+
+static inline bool IsPrefetching(World* world, ChunkP pos)
+{
+    auto& prefetching = world->prefetching;
+    return find(prefetching.begin(), prefetching.end(), pos) != prefetching.end();
+}
+
+// Queues loads for waiting groups in priority order. Few loads are in flight at once, 
+// so the remaining groups are reordered each frame as the player moves and turns.
+static void ScheduleGroupLoads(GameState* state, World* world, Camera* cam, Player* player)
+{
+    auto& groups = world->groupsToLoad;
+
+    if (groups.empty() || world->loadsInFlight >= MAX_GROUP_LOADS)
+        return;
+
+    for (int i = 0; i < groups.size(); i++)
+        groups[i]->priority = StreamPriority(world, cam, player, groups[i]);
+
+    sort(groups.begin(), groups.end(), [](auto a, auto b) { return a->priority < b->priority; });
+
+    int remaining = 0;
+
+    for (int i = 0; i < groups.size(); i++)
+    {
+        ChunkGroup* group = groups[i];
+
+        // A group being prefetched waits until the prefetch has cached it.
+        if (world->loadsInFlight < MAX_GROUP_LOADS && !IsPrefetching(world, group->pos))
+        {
+            group->cached = TakeCachedGroup(world, group->pos);
+            world->loadsInFlight++;
+            PIPELINE_STAGE(PIPELINE_LOAD_WAIT, group->stageTime);
+            QueueAsync(state, LoadGroup, world, group, OnGroupLoaded);
+        }
+        else groups[remaining++] = group;
+    }
+
+    groups.resize(remaining);
+}
+
+// Loads or generates a group outside the loaded area, saves it and adds it to the 
+// group cache, the same as a group leaving the loaded area. The group's region reference 
+// is released here, since releasing the last one writes the region file.
+static void PrefetchGroup(GameState* state, World* world, void* groupPtr)
+{
+    LoadGroup(state, world, groupPtr);
+    SaveAndCacheGroup(state, world, groupPtr);
+    RemoveFromRegion(world, (ChunkGroup*)groupPtr);
+}
+
+static void OnGroupPrefetched(GameState*, World* world, void* groupPtr)
+{
+    ChunkGroup* group = (ChunkGroup*)groupPtr;
+
+    auto& prefetching = world->prefetching;
+    prefetching.erase(find(prefetching.begin(), prefetching.end(), group->pos));
+
+    world->groupPool.Return(group);
+}
+
+// While the player moves quickly, prefetches the groups just beyond the front of the 
+// load area along the main axis of travel, nearest to the player first. Prefetching only 
+// runs once the loaded area has no loads or saves left, so it never delays them.
+static void PrefetchGroups(GameState* state, World* world, Player* player)
+{
+    if (!player->spawned || world->groupCache->budget == 0)
+        return;
+
+    if (!world->groupsToLoad.empty() || world->loadsInFlight > 0 || !world->destroyQueue.empty() || world->pendingSaves > 0)
+        return;
+
+    vec2 velocity = vec2(player->velocity.x, player->velocity.z);
+
+    if (length(velocity) < PREFETCH_MIN_SPEED)
+        return;
+
+    bool alongX = abs(velocity.x) >= abs(velocity.y);
+
+    int size = world->size;
+    ChunkP ref = world->ref;
+    LChunkP playerChunk = LWorldToLChunkP(BlockPos(player->pos));
+
+    for (int i = 0; i < size && world->prefetching.size() < MAX_GROUP_PREFETCHES; i++)
+    {
+        // Offsets alternate outward from the player: 0, -1, 1, -2, 2...
+        int offset = (i & 1) ? -((i + 1) / 2) : i / 2;
+        ChunkP pos;
+
+        if (alongX)
+        {
+            int z = playerChunk.z + offset;
+            if (z < 0 || z >= size) continue;
+
+            int front = world->rowHalfWidths[z] + 1;
+            pos = ivec3(ref.x + world->loadRange + (velocity.x > 0.0f ? front : -front), 0, ref.z + z);
+        }
+        else
+        {
+            int x = playerChunk.x + offset;
+            if (x < 0 || x >= size) continue;
+
+            int front = world->rowHalfWidths[x] + 1;
+            pos = ivec3(ref.x + x, 0, ref.z + world->loadRange + (velocity.y > 0.0f ? front : -front));
+        }
+
+        if (IsPrefetching(world, pos) || IsGroupCached(world, pos))
+            continue;
+
+        ChunkGroup* group = world->groupPool.Get();
+        memset(group, 0, sizeof(ChunkGroup));
+        group->pos = pos;
+
+        for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+        {
+            Chunk* chunk = group->chunks + y;
+            chunk->lcPos = ivec3(0, y, 0);
+            chunk->lwPos = LChunkToLWorldP(chunk->lcPos);
+            chunk->group = group;
+        }
+
+        world->prefetching.push_back(pos);
+        QueueAsync(state, PrefetchGroup, world, group, OnGroupPrefetched);
+    }
+}
+
 static void CheckWorld(GameState* state, World* world, Player* player)
 {
     Rectf bounds = world->pBounds;
@@ -777,6 +1158,7 @@ static void CheckWorld(GameState* state, World* world, Player* player)
 
     if (shift) 
     {
+        ShiftBodies(*world->physics, pos - player->pos);
         player->pos = pos;
         MoveCamera(state->camera, player->pos);
         UpdateCameraVectors(state->camera);
@@ -792,6 +1174,8 @@ static inline bool HasBackgroundWork(World* world)
 
 static void UpdateWorld(GameState* state, World* world, Camera* cam, Player* player)
 {
+    TIMED_FUNCTION;
+
     if (player->suspended)
     {
         LChunkP cP = LWorldToLChunkP(player->pos);
@@ -816,6 +1200,9 @@ static void UpdateWorld(GameState* state, World* world, Camera* cam, Player* pla
 
     GetCameraPlanes(cam);
 
+    ScheduleGroupLoads(state, world, cam, player);
+    PrefetchGroups(state, world, player);
+
     WorldRenderUpdate(state, world, cam);
     PrepareWorldRender(state, world, state->renderer);
 
@@ -827,8 +1214,11 @@ static void UpdateWorld(GameState* state, World* world, Camera* cam, Player* pla
         ChunkGroup* group = destroyQueue.front();
         destroyQueue.pop();
         group->pendingDestroy = true;
-        QueueAsync(state, SaveGroup, world, group, DestroyGroup);
+        world->pendingSaves++;
+        QueueAsync(state, SaveAndCacheGroup, world, group, OnGroupSaved);
     }
+
+    UPDATE_PIPELINE_STATS(state, world);
 }
 
 static void TeleportHome(GameState* state, World* world)
@@ -853,6 +1243,85 @@ static inline void UpdateWorldRef(World* world, ChunkP p)
     world->ref = ref;
 }
 
+// Marks the groups inside the load area and the interior groups among them. With a 
+// circular area, a group is inside if its offset from the center group is within the 
+// load range plus half a group, which keeps the full range along each axis.
+static void CreateLoadArea(World* world)
+{
+    int size = world->size;
+    int range = world->loadRange;
+    float radius = range + 0.5f;
+
+    world->loadArea = new uint8_t[world->totalGroups]();
+    world->rowHalfWidths = new int[size]();
+
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int dx = x - range, dz = z - range;
+
+            #if CIRCULAR_LOAD_AREA
+            bool inside = (float)(dx * dx + dz * dz) <= radius * radius;
+            #else
+            bool inside = true;
+            #endif
+
+            if (inside)
+            {
+                world->loadArea[GroupIndex(world, x, z)] = LOAD_AREA_INSIDE;
+
+                // The area is symmetric, so row and column widths are the same.
+                world->rowHalfWidths[z] = Max(world->rowHalfWidths[z], abs(dx));
+            }
+        }
+    }
+
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            bool interior = true;
+
+            for (int i = 0; i < 9; i++)
+            {
+                LChunkP next = ivec3(x, 0, z) + DIRS_2[i];
+
+                if (!GroupInsideWorld(world, next.x, next.z) || !HasFlag(world->loadArea[GroupIndex(world, next.x, next.z)], LOAD_AREA_INSIDE))
+                {
+                    interior = false;
+                    break;
+                }
+            }
+
+            if (interior)
+                world->loadArea[GroupIndex(world, x, z)] |= LOAD_AREA_INTERIOR;
+        }
+    }
+}
+
+static void CreateSpiral(World* world)
+{
+    int size = world->size;
+    ivec2 center = ivec2(world->loadRange);
+
+    auto& spiral = world->spiral;
+    spiral.clear();
+
+    for (int i = 0; i < world->totalGroups; i++)
+    {
+        if (HasFlag(world->loadArea[i], LOAD_AREA_INSIDE))
+            spiral.push_back(i);
+    }
+
+    stable_sort(spiral.begin(), spiral.end(), [size, center](int a, int b)
+    {
+        ivec2 distA = ivec2(a % size, a / size) - center;
+        ivec2 distB = ivec2(b % size, b / size) - center;
+        return distA.x * distA.x + distA.y * distA.y < distB.x * distB.x + distB.y * distB.y;
+    });
+}
+
 static World* NewWorld(GameState* state, int loadRange, WorldConfig& config, World* existing = nullptr)
 {
     World* world;
@@ -869,17 +1338,28 @@ static World* NewWorld(GameState* state, int loadRange, WorldConfig& config, Wor
         world->totalGroups = Square(world->size);
         world->groups = new ChunkGroup*[world->totalGroups]();
 
-        world->visibleChunks.reserve(world->totalGroups * WORLD_CHUNK_HEIGHT);
+        world->groupPool.tag = MEMORY_GROUPS;
+        world->regionPool.tag = MEMORY_REGIONS;
+
+        // Each group is over a megabyte, so only about a load area's worth are kept idle.
+        world->groupPool.maxMagazines = world->totalGroups / POOL_MAGAZINE_SIZE + 1;
+
+        // Recreated every frame, but read before the first update.
+        world->visibleChunks = NewFrameVector<Chunk*>();
         world->groupsToCreate.reserve(world->totalGroups);
 
         world->loadRange = loadRange;
 
+        CreateLoadArea(world);
+        CreateSpiral(world);
+
         float min = (float)(loadRange * CHUNK_SIZE_H);
         float max = min + CHUNK_SIZE_H;
 
         world->pBounds = NewRect(vec3(min, 0.0f, min), vec3(max, 0.0f, max));
 
         CreateBlockData(state, world->blockData);
+        CreateBlockProperties(world->blockData, world->blockProps);
 
         if (!LoadWorldFileData(state, world))
             world->properties = { rand(), config.radius, BIOME_FOREST };
@@ -888,6 +1368,12 @@ static World* NewWorld(GameState* state, int loadRange, WorldConfig& config, Wor
 
         InitializeCriticalSection(&world->regionCS);
         InitializeConditionVariable(&world->regionsEmpty);
+
+        world->groupCache = new GroupCache();
+        world->groupCache->budget = GROUP_CACHE_DEFAULT_BUDGET;
+        InitializeCriticalSection(&world->groupCache->cs);
+
+        world->physics = NewPhysicsWorld();
     }
     else 
     {
@@ -897,10 +1383,18 @@ static World* NewWorld(GameState* state, int loadRange, WorldConfig& config, Wor
         // We don't want to save any chunks here.
         for (int i = 0; i < world->totalGroups; i++)
         {
-            DestroyGroup(state, world, world->groups[i]);
+            if (world->groups[i] != nullptr)
+                DestroyGroup(state, world, world->groups[i]);
+
             world->groups[i] = nullptr;
         }
 
+        world->chunksToFill.clear();
+
+        // Cached groups belong to the world being replaced.
+        ClearGroupCache(world);
+        ClearBodies(*world->physics);
+
         world->properties.seed = rand();
         world->properties.radius = config.infinite ? INT_MAX : config.radius;
         world->properties.biome = config.biome;
@@ -916,6 +1410,7 @@ static World* NewWorld(GameState* state, int loadRange, WorldConfig& config, Wor
 
     RegisterCommand(state, "sethome", SetHomeCommand, world);
     RegisterCommand(state, "teleport", PlayerTeleportCommand, world);
+    RegisterCommand(state, "groupcache", GroupCacheCommand, world);
 
     return world;
 }
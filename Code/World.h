@@ -16,6 +16,12 @@
 #define CHUNK_SIZE_3 65536
 #define CHUNK_SIZE_2 1024
 
+// Chunks are meshed in horizontal sections so that an edit 
+// only rebuilds the part of the chunk it affects.
+#define CHUNK_SECTIONS 4
+#define CHUNK_SECTION_BITS 4
+#define ALL_CHUNK_SECTIONS 15
+
 #define GROUP_HASH_SIZE 2048
 
 #define WORLD_CHUNK_HEIGHT 4
@@ -23,6 +29,22 @@
 
 #define GROUP_DESTROY_LIMIT 6
 
+// Maximum number of chunk rebuild batches that may be in flight at once.
+#define MAX_REBUILD_BATCHES 4
+
+// Maximum number of group loads and prefetches that may be in flight at once. 
+// Keeping these small lets waiting work be reordered as the player moves.
+#define MAX_GROUP_LOADS 8
+#define MAX_GROUP_PREFETCHES 4
+
+// Speed, in blocks per second, added to the player's speed toward a group when 
+// estimating the time to reach it, so that groups are ordered by distance at rest.
+#define STREAM_BASE_SPEED 10.0f
+
+// Horizontal speed, in blocks per second, above which groups beyond the loaded 
+// area are prefetched in the direction of travel.
+#define PREFETCH_MIN_SPEED 20.0f
+
 // The position of the chunk in local space around the player.
 // All loaded chunks are in a local array. This indexes into it.
 typedef ivec3 LChunkP;
@@ -65,6 +87,8 @@ enum GroupState
 };
 
 struct ChunkGroup;
+struct RebuildBatch;
+struct CachedGroup;
 
 struct Chunk
 {
@@ -80,9 +104,30 @@ struct Chunk
     Mesh mesh;
     MeshData* meshData;
 
-    bool pendingUpdate, hasMeshes, modified;
+    bool pendingUpdate, modified;
     ChunkState state;
 
+    // Bitmasks of the sections that need rebuilding and of those being built.
+    uint8_t dirtySections, buildSections;
+
+    // Incremented whenever the blocks or light the chunk's mesh depends on change.
+    // Meshing reads the chunk while it may be edited, so a mesh is only kept if the 
+    // version it was built from is still current once it completes.
+    uint32_t version, meshVersion;
+    bool rebuilding;
+
+    // Set if the chunk contains an edited block, so its rebuild is given priority.
+    bool edited;
+
+    // Time of the earliest edit not yet shown by the chunk's mesh, and the 
+    // same for the edits included in the mesh being built. 0 if none.
+    double editTime, meshEditTime;
+
+    // Time the chunk's first build was queued or completed, for pipeline profiling.
+    double stageTime;
+
+    RebuildBatch* rebuildBatch;
+
     ChunkGroup* group;
 };
 
@@ -93,8 +138,35 @@ struct ChunkGroup
 
     uint8_t surface[CHUNK_SIZE_2];
 
+    // The highest surface of any column. Chunks starting at or above it hold only air.
+    uint8_t maxSurface;
+
     GroupState state;
     bool active, pendingDestroy;
+
+    // Persistence state for the group's blocks and lighting. A group is fromDisk if
+    // every chunk was loaded from its region. Restored light was read from disk and is
+    // only trusted if all eight neighbors also came from disk. Light is complete once 
+    // the group and all of its neighbors have been preprocessed.
+    bool fromDisk, hasSavedLight, lightRestored;
+    bool lightComplete, lightDirty;
+
+    // Whether the group holds a reference to its region. Groups restored from the
+    // group cache only acquire their region once they need to write to it.
+    bool inRegion;
+
+    // Cache entry to restore the group from, if it was found in the group cache.
+    CachedGroup* cached;
+
+    // Streaming priority for this frame. Lower values are loaded and processed first.
+    float priority;
+
+    // Set while the group is waiting in the world's check list, and once the group 
+    // and all of its neighbors are preprocessed so that it can be shown.
+    bool pendingCheck, renderable;
+
+    // Times the group was created and entered its current stage, for pipeline profiling.
+    double createTime, stageTime;
 };
 
 struct WorldLocation
@@ -103,8 +175,18 @@ struct WorldLocation
     RelP rP;
 };
 
+// Per-group flags describing the load area's shape. Interior groups have all 
+// eight neighbors inside the load area and are the only ones that are processed.
+enum LoadAreaFlags : uint8_t
+{
+    LOAD_AREA_INSIDE = 1,
+    LOAD_AREA_INTERIOR = 2
+};
+
 struct Player;
+struct PhysicsWorld;
 struct Region;
+struct GroupCache;
 
 struct WorldProperties
 {
@@ -123,22 +205,53 @@ struct World
     // The radius at which the terrain begins falling off into sea.
     int falloffRadius;
 
-    ObjectPool<ChunkGroup> groupPool;
-    ObjectPool<Region> regionPool;
+    SharedObjectPool<ChunkGroup> groupPool;
+    SharedObjectPool<Region> regionPool;
 
-    // All actively loaded chunk groups around the player.
+    // All actively loaded chunk groups around the player. Groups outside the 
+    // load area are null.
     ChunkGroup** groups;
     int totalGroups;
+
+    // Load area flags for each group index, and the number of groups on each side 
+    // of the center in each row of the load area.
+    uint8_t* loadArea;
+    int* rowHalfWidths;
+
     int workCount;
     
     vector<ivec4> groupsToCreate;
-    vector<ChunkGroup*> groupsToProcess;
+
+    // Group indices ordered by distance from the center group. The player is always 
+    // in the center group, so this is the order of the groups by distance to the player.
+    vector<int> spiral;
+
+    // Groups whose state or whose neighbors' state changed since the last update.
+    vector<ChunkGroup*> groupsToCheck;
+
+    // Renderable groups in spiral order, rebuilt when a group becomes renderable.
+    vector<ChunkGroup*> groupsToRender;
+    bool renderListChanged;
+
+    // Created groups waiting for their load to be queued.
+    vector<ChunkGroup*> groupsToLoad;
+    int loadsInFlight;
+
+    // Positions of groups beyond the loaded area being loaded into the group cache, 
+    // and the number of groups saving before they're destroyed.
+    vector<ChunkP> prefetching;
+    int pendingSaves;
     
     // Chunk hash table to store chunks that need to transition.
     ChunkGroup* groupHash[GROUP_HASH_SIZE];
 
-    vector<Chunk*> visibleChunks;
+    // Created in the frame arena by WorldRenderUpdate, so it's valid until the next frame starts.
+    ArenaVector<Chunk*>* visibleChunks;
+
+    // Chunks whose mesh data is ready to be filled.
+    vector<Chunk*> chunksToFill;
     vector<Chunk*> chunksToRebuild;
+    int rebuildBatches;
 
     // Chunks currently awaiting destruction.
     queue<ChunkGroup*> destroyQueue;
@@ -157,16 +270,20 @@ struct World
     // Doubly-linked list of loaded regions.
     list<Region*> regions;
 
+    GroupCache* groupCache;
+
     CRITICAL_SECTION regionCS;
     CONDITION_VARIABLE regionsEmpty;
 
-    bool chunksRebuilding;
-
     Player* player;
 
+    // Bodies other than the player, such as mobs and dropped items.
+    PhysicsWorld* physics;
+
     WorldProperties properties;
 
     BlockData blockData[BLOCK_COUNT];
+    BlockProperties blockProps;
     BlockType blockToSet;
 
     Biome biomes[BIOME_COUNT];
@@ -188,6 +305,20 @@ struct RebasedGroupPos
     int rX, rZ;
 };
 
+// Reads blocks at local world positions while caching the chunk the last position 
+// fell in. Moving within the chunk only updates the index, and crossing into another 
+// chunk looks up the neighbor from the cached chunk's position. The chunk is null if 
+// the position is outside the world or its group isn't loaded.
+struct BlockAccessor
+{
+    World* world;
+    ChunkGroup* group;
+    Chunk* chunk;
+    LWorldP pos;
+    RelP rel;
+    int index;
+};
+
 union NeighborBlocks
 {
     struct
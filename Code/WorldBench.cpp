@@ -0,0 +1,806 @@
+//
+// Gamecraft
+//
+
+// Suites that run against a loaded world, run with GamecraftBench <suite>. Each creates
+// a world with the default seed and biome and waits for the area around the player to
+// be shown before testing. Results are written to the console, and the exit code is
+// nonzero if a suite's check fails.
+
+// Drops a grid of bodies above the player and steps them, first on the main thread only
+// and then across the workers. Islands are stepped independently, so both runs must
+// leave every body in the same place.
+static int RunPhysicsBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	PhysicsWorld* physics = NewPhysicsWorld();
+
+	const int size = 25, layers = 16, steps = 240;
+	const float deltaTime = 1.0f / 60.0f;
+
+	vec3 base = world->player->pos + vec3(-size * 0.5f, 8.0f, -size * 0.5f);
+	double times[2];
+
+	vector<vec3> serialPos;
+	int mismatches = 0;
+
+	for (int run = 0; run < 2; run++)
+	{
+		ClearBodies(*physics);
+
+		for (int y = 0; y < layers; y++)
+		{
+			for (int z = 0; z < size; z++)
+			{
+				for (int x = 0; x < size; x++)
+					AddBody(*physics, base + vec3(x, y * 1.5f, z), vec3(0.5f));
+			}
+		}
+
+		double start = glfwGetTime();
+
+		for (int i = 0; i < steps; i++)
+			StepPhysics(state, world, *physics, deltaTime, run == 1);
+
+		times[run] = (glfwGetTime() - start) * 1000.0 / steps;
+
+		if (run == 0)
+			serialPos.assign(physics->pos, physics->pos + physics->count);
+		else if (physics->count != serialPos.size())
+			mismatches = Max(physics->count, (int)serialPos.size());
+		else
+		{
+			for (int i = 0; i < physics->count; i++)
+			{
+				if (physics->pos[i] != serialPos[i])
+					mismatches++;
+			}
+		}
+	}
+
+	int resting = 0;
+
+	for (int i = 0; i < physics->count; i++)
+	{
+		if (HasFlag(physics->colFlags[i], HIT_DOWN))
+			resting++;
+	}
+
+	printf("Physics: %i bodies, %i steps, %i worker threads\n\n", size * size * layers, steps, state->threadCount);
+	printf("%-10s %12s\n", "run", "ms/step");
+	printf("%-10s %12.3f\n", "serial", times[0]);
+	printf("%-10s %12.3f\n", "parallel", times[1]);
+	printf("\n%i of %i bodies resting, %i differ between the runs.\n", resting, physics->count, mismatches);
+
+	return mismatches > 0 ? 1 : 0;
+}
+
+// The hot block queries as they read the block data before the property table.
+static inline int BlockDataCull(World* world, Block block) { return world->blockData[block].cull; }
+static inline bool BlockDataPassable(World* world, Block block) { return world->blockData[block].passable; }
+static inline bool BlockDataVisible(World* world, Block block) { return !world->blockData[block].invisible; }
+static inline BlockMeshType BlockDataMeshType(World* world, Block block) { return world->blockData[block].meshType; }
+static inline bool BlockDataOpaque(World* world, Block block) { return world->blockData[block].lightStep == INT_MAX; }
+static inline int BlockDataLightEmitted(World* world, Block block) { return world->blockData[block].lightEmitted; }
+static inline bool BlockDataFluid(World* world, Block block) { return world->blockData[block].isFluid; }
+
+// The table caps the light step of opaque blocks, which is infinite in the block data.
+static inline int BlockDataLightStep(World* world, Block block) 
+{ 
+	return Min(world->blockData[block].lightStep, MAX_LIGHT + 1); 
+}
+
+// Runs the query over every block of the chunk the given number of times, adding the
+// results to the sum. Returns the time in milliseconds.
+template <typename F>
+static double TimeBlockQuery(Chunk* chunk, int iterations, int& sum, F query)
+{
+	double start = glfwGetTime();
+
+	for (int it = 0; it < iterations; it++)
+	{
+		for (int i = 0; i < CHUNK_SIZE_3; i++)
+			sum += (int)query(chunk->blocks[i]);
+	}
+
+	return (glfwGetTime() - start) * 1000.0;
+}
+
+// Times a query reading the block data against the same query reading the property
+// table, and prints both. Returns false if they disagree for any block type.
+template <typename Old, typename New>
+static bool CompareBlockQuery(char* name, Chunk* chunk, int iterations, int& sum, Old oldQuery, New newQuery)
+{
+	bool matches = true;
+
+	for (int b = 0; b < BLOCK_COUNT; b++)
+	{
+		if ((int)oldQuery((Block)b) != (int)newQuery((Block)b))
+			matches = false;
+	}
+
+	double oldTime = TimeBlockQuery(chunk, iterations, sum, oldQuery);
+	double newTime = TimeBlockQuery(chunk, iterations, sum, newQuery);
+
+	printf("%-14s %12.3f %12.3f %8.2f %s\n", name, oldTime, newTime, oldTime / newTime, matches ? "" : "DIFFERS");
+	return matches;
+}
+
+// Times each hot block property query over the chunk the player is in, reading the block
+// data as before the property table and then reading the table. Both must return the
+// same value for every block type.
+static int RunBlockBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	LChunkP lcP = LWorldToLChunkP(BlockPos(world->player->pos));
+	Chunk* chunk = GetChunk(world, lcP);
+
+	const int iterations = 64;
+	int sum = 0, mismatches = 0;
+
+	printf("Blocks: chunk %i, %i, %i, %i lookups per query, ms\n\n", lcP.x, lcP.y, lcP.z, CHUNK_SIZE_3 * iterations);
+	printf("%-14s %12s %12s %8s\n", "query", "block data", "table", "ratio");
+
+	mismatches += !CompareBlockQuery("cull", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataCull(world, b); }, [world](Block b) { return GetCull(world, b); });
+	mismatches += !CompareBlockQuery("passable", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataPassable(world, b); }, [world](Block b) { return IsPassable(world, b); });
+	mismatches += !CompareBlockQuery("visible", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataVisible(world, b); }, [world](Block b) { return IsVisible(world, b); });
+	mismatches += !CompareBlockQuery("mesh type", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataMeshType(world, b); }, [world](Block b) { return GetMeshType(world, b); });
+	mismatches += !CompareBlockQuery("opaque", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataOpaque(world, b); }, [world](Block b) { return IsOpaque(world, b); });
+	mismatches += !CompareBlockQuery("light step", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataLightStep(world, b); }, [world](Block b) { return GetLightStep(world, b); });
+	mismatches += !CompareBlockQuery("light emitted", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataLightEmitted(world, b); }, [world](Block b) { return GetLightEmitted(world, b); });
+	mismatches += !CompareBlockQuery("fluid", chunk, iterations, sum, 
+		[world](Block b) { return BlockDataFluid(world, b); }, [world](Block b) { return IsFluid(world, b); });
+
+	printf("\n%i of 8 queries differ.\n", mismatches);
+	g_benchSink = sum;
+
+	return mismatches > 0 ? 1 : 0;
+}
+
+// Canonical chunk contents used by the mesh benchmark.
+enum MeshBenchChunk
+{
+	MESH_BENCH_FLAT,
+	MESH_BENCH_FOREST,
+	MESH_BENCH_CAVES,
+	MESH_BENCH_CHECKERBOARD,
+	MESH_BENCH_COUNT
+};
+
+static void FillMeshBenchChunk(Chunk* chunk, MeshBenchChunk type)
+{
+	memset(chunk->blocks, 0, sizeof(chunk->blocks));
+
+	for (int z = 0; z < CHUNK_SIZE_H; z++)
+	{
+		for (int y = 0; y < CHUNK_SIZE_V; y++)
+		{
+			for (int x = 0; x < CHUNK_SIZE_H; x++)
+			{
+				Block block = BLOCK_AIR;
+
+				switch (type)
+				{
+					case MESH_BENCH_FLAT:
+					case MESH_BENCH_FOREST:
+					{
+						if (y < 28) block = BLOCK_STONE;
+						else if (y < 31) block = BLOCK_DIRT;
+						else if (y == 31) block = BLOCK_GRASS;
+					} break;
+
+					case MESH_BENCH_CAVES:
+					{
+						// Tunnels along x and z joined by vertical shafts.
+						bool tunnel = (y >= 8 && y < 11 && z % 16 >= 4 && z % 16 < 7) 
+							|| (y >= 20 && y < 23 && x % 16 >= 4 && x % 16 < 7)
+							|| (y >= 4 && y < 36 && x % 16 >= 10 && x % 16 < 12 && z % 16 >= 10 && z % 16 < 12);
+
+						if (y < 40 && !tunnel) block = BLOCK_STONE;
+					} break;
+
+					case MESH_BENCH_CHECKERBOARD:
+					{
+						// Every face of every block is visible. The region is limited so the 
+						// chunk stays under the vertex limit.
+						if (x < 16 && z < 16 && y < 12 && ((x + y + z) & 1))
+							block = BLOCK_STONE;
+					} break;
+				}
+
+				chunk->blocks[BlockIndex(x, y, z)] = block;
+			}
+		}
+	}
+
+	if (type != MESH_BENCH_FOREST)
+		return;
+
+	// Trees are placed on a grid with their canopies inside the chunk.
+	for (int tz = 4; tz < CHUNK_SIZE_H - 4; tz += 8)
+	{
+		for (int tx = 4; tx < CHUNK_SIZE_H - 4; tx += 8)
+		{
+			for (int y = 32; y < 38; y++)
+				chunk->blocks[BlockIndex(tx, y, tz)] = BLOCK_WOOD;
+
+			for (int y = 36; y < 41; y++)
+			{
+				for (int z = tz - 2; z <= tz + 2; z++)
+				{
+					for (int x = tx - 2; x <= tx + 2; x++)
+					{
+						int index = BlockIndex(x, y, z);
+
+						if (chunk->blocks[index] == BLOCK_AIR)
+							chunk->blocks[index] = BLOCK_LEAVES;
+					}
+				}
+			}
+		}
+	}
+}
+
+// Replaces the chunk the player is in with each canonical chunk in turn and times
+// meshing it. The chunk's blocks are restored afterward, and light is read from the
+// current world.
+static int RunMeshBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	LChunkP lcP = LWorldToLChunkP(BlockPos(world->player->pos));
+	Chunk* chunk = GetChunk(world, lcP);
+
+	if (chunk->state != CHUNK_BUILT || chunk->meshData != nullptr)
+		Error("The player's chunk must be built before benchmarking.\n");
+
+	static const char* names[MESH_BENCH_COUNT] = { "flat", "forest", "caves", "checkerboard" };
+
+	Renderer& rend = state->renderer;
+	int totalVertices = chunk->totalVertices;
+
+	Block* saved = new Block[CHUNK_SIZE_3];
+	memcpy(saved, chunk->blocks, sizeof(chunk->blocks));
+
+	const int iterations = 32;
+
+	printf("Mesh: %i iterations, ms per chunk\n\n", iterations);
+	printf("%-14s %12s %12s %10s\n", "chunk", "mean", "min", "vertices");
+
+	for (int type = 0; type < MESH_BENCH_COUNT; type++)
+	{
+		FillMeshBenchChunk(chunk, (MeshBenchChunk)type);
+
+		double total = 0.0, best = DBL_MAX;
+		int vertices = 0;
+
+		for (int it = 0; it < iterations; it++)
+		{
+			chunk->meshData = GetMeshData(rend.meshData);
+			chunk->buildSections = ALL_CHUNK_SECTIONS;
+
+			double start = glfwGetTime();
+			BuildChunkAsync(state, world, chunk);
+			double time = glfwGetTime() - start;
+
+			total += time;
+			best = Min(best, time);
+
+			vertices = chunk->meshData->vertCount;
+			ReturnMeshData(rend.meshData, chunk->meshData);
+		}
+
+		printf("%-14s %12.3f %12.3f %10i\n", names[type], total * 1000.0 / iterations, best * 1000.0, vertices);
+	}
+
+	memcpy(chunk->blocks, saved, sizeof(chunk->blocks));
+	delete[] saved;
+
+	chunk->meshData = nullptr;
+	chunk->buildSections = 0;
+	chunk->totalVertices = totalVertices;
+
+	return 0;
+}
+
+// Vertex corners in the order produced by ComputeBlockLight, given as the axis and 
+// offsets passed to VertexLight by the mesher.
+static const int lightTestCorners[24][4] =
+{
+	{ AXIS_Y, 1, 1, -1 }, { AXIS_Y, 1, 1, 1 }, { AXIS_Y, -1, 1, 1 }, { AXIS_Y, -1, 1, -1 },
+	{ AXIS_Y, -1, -1, -1 }, { AXIS_Y, -1, -1, 1 }, { AXIS_Y, 1, -1, 1 }, { AXIS_Y, 1, -1, -1 },
+	{ AXIS_Z, -1, -1, 1 }, { AXIS_Z, -1, 1, 1 }, { AXIS_Z, 1, 1, 1 }, { AXIS_Z, 1, -1, 1 },
+	{ AXIS_Z, 1, -1, -1 }, { AXIS_Z, 1, 1, -1 }, { AXIS_Z, -1, 1, -1 }, { AXIS_Z, -1, -1, -1 },
+	{ AXIS_X, 1, -1, 1 }, { AXIS_X, 1, 1, 1 }, { AXIS_X, 1, 1, -1 }, { AXIS_X, 1, -1, -1 },
+	{ AXIS_X, -1, -1, -1 }, { AXIS_X, -1, 1, -1 }, { AXIS_X, -1, 1, 1 }, { AXIS_X, -1, -1, 1 }
+};
+
+// Checks the smooth light kernel against VertexLight for every face vertex of every 
+// visible block in the player's group, and times both.
+static int RunLightBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	LChunkP lcP = LWorldToLChunkP(BlockPos(world->player->pos));
+	ChunkGroup* group = GetChunk(world, lcP)->group;
+
+	// Chunk index and position of each visible block.
+	vector<ivec4> blocks;
+
+	for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
+	{
+		Chunk* chunk = group->chunks + i;
+
+		if (chunk->state != CHUNK_BUILT)
+			continue;
+
+		for (int z = 0; z < CHUNK_SIZE_H; z++)
+		{
+			for (int y = 0; y < CHUNK_SIZE_V; y++)
+			{
+				for (int x = 0; x < CHUNK_SIZE_H; x++)
+				{
+					if (IsVisible(world, GetBlock(chunk, x, y, z)))
+						blocks.push_back(ivec4(x, y, z, i));
+				}
+			}
+		}
+	}
+
+	int mismatches = 0;
+
+	for (ivec4 p : blocks)
+	{
+		Chunk* chunk = group->chunks + p.w;
+
+		BlockLightSamples samples;
+		Colori light[24];
+
+		GatherBlockLight(world, chunk, p.x, p.y, p.z, samples);
+		ComputeBlockLight(samples, light);
+
+		for (int c = 0; c < 24; c++)
+		{
+			const int* corner = lightTestCorners[c];
+			Colori expected = VertexLight(world, chunk, (Axis)corner[0], ivec3(p.x, p.y, p.z), corner[1], corner[2], corner[3]);
+
+			if (light[c] != expected)
+			{
+				if (mismatches == 0)
+					printf("Light mismatch at %i, %i, %i in chunk %i, vertex %i\n", p.x, p.y, p.z, p.w, c);
+
+				mismatches++;
+			}
+		}
+	}
+
+	int sum = 0;
+	double start = glfwGetTime();
+
+	for (ivec4 p : blocks)
+	{
+		BlockLightSamples samples;
+		Colori light[24];
+
+		GatherBlockLight(world, group->chunks + p.w, p.x, p.y, p.z, samples);
+		ComputeBlockLight(samples, light);
+
+		sum += light[0].a + light[23].a;
+	}
+
+	double kernelTime = (glfwGetTime() - start) * 1000.0;
+	start = glfwGetTime();
+
+	for (ivec4 p : blocks)
+	{
+		for (int c = 0; c < 24; c++)
+		{
+			const int* corner = lightTestCorners[c];
+			Colori light = VertexLight(world, group->chunks + p.w, (Axis)corner[0], ivec3(p.x, p.y, p.z), corner[1], corner[2], corner[3]);
+			sum += light.a;
+		}
+	}
+
+	double vertexTime = (glfwGetTime() - start) * 1000.0;
+
+	printf("Light: %i visible blocks in group %i, %i, ms\n\n", (int)blocks.size(), lcP.x, lcP.z);
+	printf("%-12s %12s\n", "method", "time");
+	printf("%-12s %12.3f\n", "kernel", kernelTime);
+	printf("%-12s %12.3f\n", "VertexLight", vertexTime);
+	printf("\n%i vertices differ from VertexLight.\n", mismatches);
+	g_benchSink = sum;
+
+	return mismatches > 0 ? 1 : 0;
+}
+
+// Compares GetBlock against the block accessor for random positions and for a 
+// coherent scan, both within a box around the player. The scan is read through the 
+// accessor both by position and by stepping along each row.
+static int RunAccessBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	const int range = 48;
+	const int randomCount = 1000000;
+
+	LWorldP center = BlockPos(world->player->pos);
+	LWorldP min = ivec3(center.x - range, 0, center.z - range);
+	LWorldP max = ivec3(center.x + range, WORLD_BLOCK_HEIGHT - 1, center.z + range);
+
+	vector<LWorldP> points;
+	points.reserve(randomCount);
+
+	for (int i = 0; i < randomCount; i++)
+		points.push_back(ivec3(RandRange(min.x, max.x), RandRange(min.y, max.y), RandRange(min.z, max.z)));
+
+	BlockAccessor acc = NewAccessor(world);
+	int mismatches = 0;
+
+	for (LWorldP p : points)
+	{
+		if (GetBlock(acc, p) != GetBlock(world, p))
+			mismatches++;
+	}
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				if (GetBlock(acc, x, y, z) != GetBlock(world, x, y, z))
+					mismatches++;
+			}
+
+			MoveAccessorTo(acc, min.x - 1, y, z);
+
+			for (int x = min.x; x <= max.x; x++)
+			{
+				MoveAccessor(acc, 1, 0, 0);
+
+				if (GetBlock(acc) != GetBlock(world, x, y, z))
+					mismatches++;
+			}
+		}
+	}
+
+	int sum = 0;
+	double start = glfwGetTime();
+
+	for (LWorldP p : points)
+		sum += GetBlock(world, p);
+
+	double randomWorld = (glfwGetTime() - start) * 1000.0;
+	start = glfwGetTime();
+
+	for (LWorldP p : points)
+		sum += GetBlock(acc, p);
+
+	double randomAcc = (glfwGetTime() - start) * 1000.0;
+	start = glfwGetTime();
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+				sum += GetBlock(world, x, y, z);
+		}
+	}
+
+	double scanWorld = (glfwGetTime() - start) * 1000.0;
+	start = glfwGetTime();
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+				sum += GetBlock(acc, x, y, z);
+		}
+	}
+
+	double scanAcc = (glfwGetTime() - start) * 1000.0;
+	start = glfwGetTime();
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			MoveAccessorTo(acc, min.x - 1, y, z);
+
+			for (int x = min.x; x <= max.x; x++)
+			{
+				MoveAccessor(acc, 1, 0, 0);
+				sum += GetBlock(acc);
+			}
+		}
+	}
+
+	double stepAcc = (glfwGetTime() - start) * 1000.0;
+
+	printf("Access: %i random reads, a scan of %i blocks, ms\n\n", randomCount, (2 * range + 1) * (2 * range + 1) * WORLD_BLOCK_HEIGHT);
+	printf("%-10s %12s %12s %8s\n", "read", "GetBlock", "accessor", "ratio");
+	printf("%-10s %12.3f %12.3f %8.2f\n", "random", randomWorld, randomAcc, randomWorld / randomAcc);
+	printf("%-10s %12.3f %12.3f %8.2f\n", "scan", scanWorld, scanAcc, scanWorld / scanAcc);
+	printf("%-10s %12.3f %12.3f %8.2f\n", "step", scanWorld, stepAcc, scanWorld / stepAcc);
+	printf("\n%i reads differ between GetBlock and the accessor.\n", mismatches);
+	g_benchSink = sum;
+
+	return mismatches > 0 ? 1 : 0;
+}
+
+// Tests every solid block in the box spanned by the ray, as the raycast did before it 
+// walked the ray. Used as the reference for the ray suite.
+static HitInfo VoxelRaycastBox(World* world, Ray ray, float dist)
+{
+	ivec3 start = BlockPos(ray.origin);
+	ivec3 end = BlockPos(ray.origin + ray.dir * dist);
+
+	ivec3 min = ivec3(Min(start.x, end.x), Min(start.y, end.y), Min(start.z, end.z));
+	ivec3 max = ivec3(Max(start.x, end.x), Max(start.y, end.y), Max(start.z, end.z));
+
+	HitInfo info = {};
+	info.dist = dist;
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				if (IsPassable(world, GetBlock(world, x, y, z)))
+					continue;
+
+				float newDist = BlockRayIntersection(vec3((float)x, (float)y, (float)z), ray);
+
+				if (newDist < info.dist)
+				{
+					info.hit = true;
+					info.hitPos = ivec3(x, y, z);
+					info.dist = newDist;
+				}
+			}
+		}
+	}
+
+	return info;
+}
+
+// Times single and batched raycasts from the camera in random directions for ray 
+// lengths of 8 to 256 blocks. Shorter rays are also checked against the box raycast.
+static int RunRayBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+
+	const int rayCount = 1000;
+	vec3 origin = state->camera->pos;
+
+	vector<Ray> rays;
+	vector<HitInfo> hits(rayCount);
+
+	while (rays.size() < rayCount)
+	{
+		vec3 dir = vec3(RandNormal(), RandNormal(), RandNormal());
+
+		if (length2(dir) > EPSILON)
+			rays.push_back({ origin, normalize(dir) });
+	}
+
+	int mismatches = 0, sum = 0;
+
+	printf("Rays: %i per length, ms\n\n", rayCount);
+	printf("%-8s %12s %12s %12s\n", "length", "single", "batched", "box");
+
+	for (int length = 8; length <= 256; length *= 2)
+	{
+		float dist = (float)length;
+		double start = glfwGetTime();
+
+		for (int i = 0; i < rayCount; i++)
+			sum += VoxelRaycast(world, rays[i], dist).hit;
+
+		double singleTime = (glfwGetTime() - start) * 1000.0;
+		start = glfwGetTime();
+
+		VoxelRaycast(world, rays.data(), rayCount, dist, hits.data());
+
+		double batchTime = (glfwGetTime() - start) * 1000.0;
+
+		// The box raycast reads every block in the ray's bounds, which is too slow to 
+		// run for the longest rays.
+		if (length > 32)
+		{
+			printf("%-8i %12.3f %12.3f %12s\n", length, singleTime, batchTime, "-");
+			continue;
+		}
+
+		start = glfwGetTime();
+
+		for (int i = 0; i < rayCount; i++)
+		{
+			HitInfo expected = VoxelRaycastBox(world, rays[i], dist);
+
+			if (expected.hit != hits[i].hit || (expected.hit && abs(expected.dist - hits[i].dist) > 0.01f))
+				mismatches++;
+		}
+
+		double boxTime = (glfwGetTime() - start) * 1000.0;
+
+		printf("%-8i %12.3f %12.3f %12.3f\n", length, singleTime, batchTime, boxTime);
+	}
+
+	printf("\n%i rays differ from the box raycast.\n", mismatches);
+	g_benchSink = sum;
+	return mismatches > 0 ? 1 : 0;
+}
+
+// The load area grows with the square of the range, so larger ranges are given longer to load.
+#define RANGE_BENCH_TIMEOUT 600.0
+#define RANGE_BENCH_STEADY_FRAMES 600
+
+static void PrintUpdateTimes(char* phase, vector<float>& times)
+{
+	sort(times.begin(), times.end());
+
+	float mean = 0.0f;
+
+	for (float time : times)
+		mean += time;
+
+	mean /= Max((int)times.size(), 1);
+
+	printf("%-8s %8i %10.3f %10.3f %10.3f %10.3f\n", phase, (int)times.size(), mean, FramePercentile(times, 0.5f), 
+		FramePercentile(times, 0.99f), times.empty() ? 0.0f : times.back());
+}
+
+// Times UpdateWorld, which holds the main thread's world and render updates, at the given 
+// load range while the default world loads and then while it's shown without changes.
+// Worlds can't be destroyed, so each range is run on its own.
+static int RunRangeBench(GameState* state, vector<char*>& args)
+{
+	int loadRange = args.size() > 0 ? atoi(args[0]) : LOAD_RANGE;
+
+	if (loadRange < 1)
+		Error("Invalid load range %s.\n", args[0]);
+
+	srand(BENCH_DEFAULT_SEED);
+
+	char savePath[MAX_PATH];
+	InitHeadless(state, "BenchSaves", savePath);
+
+	World* world = CreateSeededWorld(state, BENCH_DEFAULT_SEED, BIOME_FOREST, loadRange);
+	Player* player = world->player;
+
+	vector<float> loadTimes, steadyTimes;
+	double start = glfwGetTime();
+	bool settled = false;
+
+	while (!(settled = WorldFullyVisible(world, player)) && glfwGetTime() - start < RANGE_BENCH_TIMEOUT)
+	{
+		float updateTime;
+		BenchFrame(state, world, player, &updateTime);
+		loadTimes.push_back(updateTime);
+	}
+
+	double loadTime = glfwGetTime() - start;
+
+	for (int i = 0; i < RANGE_BENCH_STEADY_FRAMES; i++)
+	{
+		float updateTime;
+		BenchFrame(state, world, player, &updateTime);
+		steadyTimes.push_back(updateTime);
+	}
+
+	printf("Ranges: load range %i, %i groups, UpdateWorld ms per frame\n\n", loadRange, world->totalGroups);
+	printf("%-8s %8s %10s %10s %10s %10s\n", "phase", "frames", "mean", "median", "99th", "max");
+
+	PrintUpdateTimes("load", loadTimes);
+	PrintUpdateTimes("steady", steadyTimes);
+
+	if (!settled)
+	{
+		printf("\nThe world wasn't fully shown within %.0f seconds.\n", RANGE_BENCH_TIMEOUT);
+		return 1;
+	}
+
+	printf("\nThe world was fully shown after %.1f seconds.\n", loadTime);
+	return 0;
+}
+
+// Fills the emitter with the given number of particles spread between its spawn height and
+// just below the player, so that some are killed against the ground on each update.
+static void FillBenchEmitter(ParticleEmitter& emitter, Player* player, int count)
+{
+	emitter.count = count;
+
+	for (int i = 0; i < count; i++)
+	{
+		emitter.posX[i] = RandRange(-emitter.radius, emitter.radius);
+		emitter.posY[i] = RandRange(player->pos.y - 4.0f, emitter.pos.y);
+		emitter.posZ[i] = RandRange(-emitter.radius, emitter.radius);
+		emitter.velX[i] = RandNormal() * 5.0f;
+		emitter.velY[i] = -15.0f;
+		emitter.velZ[i] = RandNormal() * 5.0f;
+		emitter.timeLeft[i] = RandRange(0.0f, emitter.lifetime);
+	}
+}
+
+// Times UpdateParticles for each weather emitter filled to its particle cap, and the
+// per-particle matrix build DrawParticles does before drawing. The matrices are built
+// into memory here rather than a mapped buffer. Each update starts from the same particles.
+static int RunParticleBench(GameState* state, vector<char*>&)
+{
+	char savePath[MAX_PATH];
+	World* world = LoadBenchWorld(state, savePath);
+	Player* player = world->player;
+
+	ParticleEmitter* emitters[] = { &state->rain, &state->snow, &state->ash };
+	static const char* names[] = { "rain", "snow", "ash" };
+
+	const int iterations = 200;
+
+	printf("Particles: %i iterations, ms per frame\n\n", iterations);
+	printf("%-6s %10s %10s %10s\n", "type", "particles", "update", "matrices");
+
+	for (int e = 0; e < ArrayCount(emitters); e++)
+	{
+		ParticleEmitter& emitter = *emitters[e];
+		emitter.pos = vec3(player->pos.x, Max(265.0f, player->pos.y + 10.0f), player->pos.z);
+
+		int count = emitter.maxParticles;
+		int capacity = (count + 7) & ~7;
+
+		float* saved = new float[capacity * 7];
+		float* arrays[] = { emitter.posX, emitter.posY, emitter.posZ, emitter.velX, emitter.velY, emitter.velZ, emitter.timeLeft };
+
+		FillBenchEmitter(emitter, player, count);
+
+		for (int i = 0; i < 7; i++)
+			memcpy(saved + capacity * i, arrays[i], sizeof(float) * count);
+
+		double updateTime = 0.0, drawTime = 0.0;
+		vector<mat4> matrices(count);
+
+		for (int it = 0; it < iterations; it++)
+		{
+			emitter.count = count;
+
+			for (int i = 0; i < 7; i++)
+				memcpy(arrays[i], saved + capacity * i, sizeof(float) * count);
+
+			double start = glfwGetTime();
+			UpdateParticles(emitter, world, BENCH_FRAME_TIME);
+			updateTime += glfwGetTime() - start;
+
+			start = glfwGetTime();
+			BuildParticleMatrices(emitter, matrices.data());
+			drawTime += glfwGetTime() - start;
+		}
+
+		delete[] saved;
+		DestroyAllParticles(emitter);
+
+		updateTime *= 1000.0 / iterations;
+		drawTime *= 1000.0 / iterations;
+
+		printf("%-6s %10i %10.3f %10.3f\n", names[e], count, updateTime, drawTime);
+	}
+
+	return 0;
+}
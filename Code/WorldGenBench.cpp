@@ -0,0 +1,452 @@
+//
+// Gamecraft
+//
+
+// World generation test, run with GamecraftBench worldgen [-update]. A fixed grid of groups is
+// generated and lit for every biome with each of a few fixed seeds. The grid's blocks, light
+// and surface are hashed and compared against Misc/WorldGenGolden.txt, and the throughput of
+// each stage is written to the console and to WorldGenBench.csv. The exit code is nonzero if a
+// hash differs from its golden value or between iterations, or if a case has no golden value
+// for this SIMD level. The golden check is skipped if none have been recorded. -update records the current hashes as the golden values for this SIMD
+// level, keeping those recorded with other levels.
+
+// Groups are hashed and lit within this many groups of the center. The ring of groups
+// around them is generated as well, since lighting reads and scatters into the neighbors.
+#define WORLDGEN_TEST_RANGE 1
+
+// Island radius in blocks, small enough that the falloff at the edge crosses the grid.
+#define WORLDGEN_TEST_RADIUS 128
+
+#define WORLDGEN_TEST_ITERATIONS 4
+#define WORLDGEN_SEED_COUNT 3
+
+static int g_worldGenSeeds[WORLDGEN_SEED_COUNT] = { 1337, 90210, 7 };
+static char* g_worldGenStageNames[WORLDGEN_STAGE_COUNT] = { "noise", "fill", "decoration", "surface", "lighting" };
+
+enum WorldGenStatus
+{
+	WORLDGEN_MATCH,
+	WORLDGEN_MISMATCH,
+	WORLDGEN_RECORDED,
+	WORLDGEN_MISSING,
+
+	// The only golden values were recorded with a different SIMD level, which changes the noise.
+	WORLDGEN_SKIPPED
+};
+
+struct WorldGenHashes
+{
+	uint64_t blocks, light, surface;
+};
+
+struct WorldGenGolden
+{
+	int biome, seed, simdLevel;
+	WorldGenHashes hashes;
+};
+
+struct WorldGenResult
+{
+	BiomeType biome;
+	int seed;
+	WorldGenHashes hashes;
+
+	// Time spent in each stage over all iterations, and the groups generated and lit.
+	WorldGenTimer timer;
+	int generated, lit;
+
+	// Cleared if an iteration produced different hashes than the first.
+	bool deterministic;
+	WorldGenStatus status;
+};
+
+// Fowler–Noll–Vo hash, continued from the given hash.
+static inline uint64_t HashBytes(uint64_t hash, void* data, size_t size)
+{
+	uint8_t* bytes = (uint8_t*)data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211;
+	}
+
+	return hash;
+}
+
+// Clears the group so that it's generated as if it were new, at the given position
+// in world chunk coordinates.
+static void ResetWorldGenGroup(ChunkGroup* group, int cX, int cZ)
+{
+	group->pos = ivec3(cX, 0, cZ);
+	group->state = GROUP_DEFAULT;
+	group->maxSurface = 0;
+	memset(group->surface, 0, sizeof(group->surface));
+
+	for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
+	{
+		Chunk* chunk = group->chunks + i;
+		chunk->state = CHUNK_DEFAULT;
+
+		memset(chunk->blocks, 0, sizeof(chunk->blocks));
+		memset(chunk->sunlight, 0, sizeof(chunk->sunlight));
+		memset(chunk->blockLight, 0, sizeof(chunk->blockLight));
+	}
+}
+
+static WorldGenHashes HashWorldGenGrid(World* world)
+{
+	uint64_t basis = 14695981039346656037ULL;
+	WorldGenHashes hashes = { basis, basis, basis };
+
+	int center = world->loadRange;
+
+	for (int z = -WORLDGEN_TEST_RANGE; z <= WORLDGEN_TEST_RANGE; z++)
+	{
+		for (int x = -WORLDGEN_TEST_RANGE; x <= WORLDGEN_TEST_RANGE; x++)
+		{
+			ChunkGroup* group = GetGroup(world, center + x, center + z);
+
+			for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
+			{
+				Chunk* chunk = group->chunks + i;
+				hashes.blocks = HashBytes(hashes.blocks, chunk->blocks, sizeof(chunk->blocks));
+				hashes.light = HashBytes(hashes.light, chunk->sunlight, sizeof(chunk->sunlight));
+				hashes.light = HashBytes(hashes.light, chunk->blockLight, sizeof(chunk->blockLight));
+			}
+
+			hashes.surface = HashBytes(hashes.surface, group->surface, sizeof(group->surface));
+		}
+	}
+
+	return hashes;
+}
+
+// Generates and lights the grid the same way groups are loaded and preprocessed while
+// streaming, but on the main thread so that each stage can be timed.
+static void RunWorldGenCase(World* world, WorldGenResult& result, Queue<ivec3>& sunNodes, Queue<ivec3>& lightNodes)
+{
+	world->properties.seed = result.seed;
+	world->properties.biome = result.biome;
+
+	Biome& biome = world->biomes[result.biome];
+	WorldGenTimer& timer = result.timer;
+
+	int center = world->loadRange;
+	int range = WORLDGEN_TEST_RANGE + 1;
+
+	result.deterministic = true;
+
+	for (int it = 0; it < WORLDGEN_TEST_ITERATIONS; it++)
+	{
+		g_worldGenTimer = &timer;
+
+		for (int z = -range; z <= range; z++)
+		{
+			for (int x = -range; x <= range; x++)
+			{
+				ChunkGroup* group = GetGroup(world, center + x, center + z);
+				ResetWorldGenGroup(group, x, z);
+
+				timer.last = glfwGetTime();
+				biome.func(world, group);
+
+				double start = glfwGetTime();
+				timer.stages[WORLDGEN_DECORATION] += start - timer.last;
+
+				ComputeSurface(group);
+				ComputeMaxSurface(group);
+				timer.stages[WORLDGEN_SURFACE] += glfwGetTime() - start;
+
+				// Lighting only reaches into groups that are loaded.
+				group->state = GROUP_LOADED;
+
+				result.generated++;
+			}
+		}
+
+		g_worldGenTimer = nullptr;
+
+		// Groups are always lit in the same order, since light scattered into a group
+		// depends on which of its neighbors were lit before it.
+		for (int z = -WORLDGEN_TEST_RANGE; z <= WORLDGEN_TEST_RANGE; z++)
+		{
+			for (int x = -WORLDGEN_TEST_RANGE; x <= WORLDGEN_TEST_RANGE; x++)
+			{
+				ChunkGroup* group = GetGroup(world, center + x, center + z);
+
+				double start = glfwGetTime();
+				SetLightNodes(world, group, sunNodes, lightNodes);
+				timer.stages[WORLDGEN_LIGHTING] += glfwGetTime() - start;
+
+				result.lit++;
+			}
+		}
+
+		WorldGenHashes hashes = HashWorldGenGrid(world);
+
+		if (it == 0)
+			result.hashes = hashes;
+		else if (memcmp(&hashes, &result.hashes, sizeof(WorldGenHashes)) != 0)
+			result.deterministic = false;
+	}
+}
+
+static vector<WorldGenGolden> LoadWorldGenGolden(char* path)
+{
+	vector<WorldGenGolden> golden;
+	FILE* file = fopen(path, "r");
+
+	if (file == nullptr)
+		return golden;
+
+	char line[256];
+
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		if (line[0] == '#')
+			continue;
+
+		WorldGenGolden entry;
+
+		if (sscanf(line, "%i %i %i %" SCNx64 " %" SCNx64 " %" SCNx64, &entry.biome, &entry.seed, &entry.simdLevel,
+			&entry.hashes.blocks, &entry.hashes.light, &entry.hashes.surface) == 6)
+		{
+			golden.push_back(entry);
+		}
+	}
+
+	fclose(file);
+	return golden;
+}
+
+// Entries recorded with other SIMD levels are kept.
+static void SaveWorldGenGolden(char* path, vector<WorldGenGolden>& golden, vector<WorldGenResult>& results, int simdLevel)
+{
+	FILE* file = fopen(path, "w");
+
+	if (file == nullptr)
+		Error("Failed to write %s.\n", path);
+
+	fprintf(file, "# World generation golden hashes, recorded with GamecraftBench worldgen -update.\n");
+	fprintf(file, "# biome seed simdLevel blocks light surface\n");
+
+	for (WorldGenGolden& entry : golden)
+	{
+		if (entry.simdLevel == simdLevel)
+			continue;
+
+		WorldGenHashes& h = entry.hashes;
+		fprintf(file, "%i %i %i %016" PRIx64 " %016" PRIx64 " %016" PRIx64 "\n", entry.biome, entry.seed, entry.simdLevel, h.blocks, h.light, h.surface);
+	}
+
+	for (WorldGenResult& result : results)
+	{
+		WorldGenHashes& h = result.hashes;
+		fprintf(file, "%i %i %i %016" PRIx64 " %016" PRIx64 " %016" PRIx64 "\n", result.biome, result.seed, simdLevel, h.blocks, h.light, h.surface);
+	}
+
+	fclose(file);
+}
+
+static void CompareWorldGenGolden(vector<WorldGenResult>& results, vector<WorldGenGolden>& golden, int simdLevel)
+{
+	for (WorldGenResult& result : results)
+	{
+		result.status = WORLDGEN_MISSING;
+
+		for (WorldGenGolden& entry : golden)
+		{
+			if (entry.biome != result.biome || entry.seed != result.seed)
+				continue;
+
+			if (entry.simdLevel != simdLevel)
+			{
+				result.status = WORLDGEN_SKIPPED;
+				continue;
+			}
+
+			if (memcmp(&entry.hashes, &result.hashes, sizeof(WorldGenHashes)) == 0)
+				result.status = WORLDGEN_MATCH;
+			else result.status = WORLDGEN_MISMATCH;
+
+			break;
+		}
+	}
+}
+
+static inline double StageGroupsPerSecond(WorldGenResult& result, int stage)
+{
+	int count = stage == WORLDGEN_LIGHTING ? result.lit : result.generated;
+	double seconds = result.timer.stages[stage];
+	return seconds > 0.0 ? count / seconds : 0.0;
+}
+
+// Throughput of the whole pipeline, from the time each stage takes per group.
+static inline double GroupsPerSecond(WorldGenResult& result)
+{
+	double perGroup = 0.0;
+
+	for (int i = 0; i < WORLDGEN_STAGE_COUNT; i++)
+	{
+		int count = i == WORLDGEN_LIGHTING ? result.lit : result.generated;
+		perGroup += result.timer.stages[i] / Max(count, 1);
+	}
+
+	return perGroup > 0.0 ? 1.0 / perGroup : 0.0;
+}
+
+static void ReportWorldGenResults(World* world, vector<WorldGenResult>& results, int simdLevel)
+{
+	static char* statusNames[] = { "match", "MISMATCH", "recorded", "missing", "skipped" };
+
+	char path[MAX_PATH];
+	FILE* file = fopen(PathToExe("WorldGenBench.csv", path, MAX_PATH), "w");
+
+	if (file != nullptr)
+	{
+		fprintf(file, "biome,seed,groupsPerSecond");
+
+		for (int i = 0; i < WORLDGEN_STAGE_COUNT; i++)
+			fprintf(file, ",%s", g_worldGenStageNames[i]);
+
+		fprintf(file, ",blockHash,lightHash,surfaceHash,deterministic,status\n");
+	}
+
+	printf("World generation: build %i, SIMD level %i, groups/s per stage\n\n", g_buildID, simdLevel);
+	printf("%-10s %6s %10s", "biome", "seed", "total");
+
+	for (int i = 0; i < WORLDGEN_STAGE_COUNT; i++)
+		printf(" %10s", g_worldGenStageNames[i]);
+
+	printf("  %s\n", "hashes");
+
+	for (WorldGenResult& result : results)
+	{
+		char* name = world->biomes[result.biome].name;
+		char* status = statusNames[result.status];
+
+		if (!result.deterministic)
+			status = "NONDETERMINISTIC";
+
+		double total = GroupsPerSecond(result);
+
+		printf("%-10s %6i %10.1f", name, result.seed, total);
+
+		for (int i = 0; i < WORLDGEN_STAGE_COUNT; i++)
+		{
+			double value = StageGroupsPerSecond(result, i);
+
+			if (value > 0.0)
+				printf(" %10.1f", value);
+			else printf(" %10s", "-");
+		}
+
+		printf("  %s\n", status);
+
+		if (file != nullptr)
+		{
+			fprintf(file, "%s,%i,%.2f", name, result.seed, total);
+
+			for (int i = 0; i < WORLDGEN_STAGE_COUNT; i++)
+				fprintf(file, ",%.2f", StageGroupsPerSecond(result, i));
+
+			WorldGenHashes& h = result.hashes;
+			fprintf(file, ",%016" PRIx64 ",%016" PRIx64 ",%016" PRIx64 ",%i,%s\n", h.blocks, h.light, h.surface, result.deterministic, status);
+		}
+	}
+
+	if (file != nullptr)
+		fclose(file);
+}
+
+static int RunWorldGenTest(GameState* state, bool update)
+{
+	char savePath[MAX_PATH];
+	InitHeadless(state, "WorldGenSaves", savePath);
+
+	WorldConfig worldConfig = {};
+	worldConfig.radius = WORLDGEN_TEST_RADIUS;
+
+	// The world's groups are created but never scheduled for loading, since the world
+	// isn't updated. The test generates them itself.
+	World* world = CreateHeadlessWorld(state, worldConfig, BENCH_SCREEN_WIDTH, BENCH_SCREEN_HEIGHT);
+
+	assert(world->loadRange > WORLDGEN_TEST_RANGE);
+
+	world->properties.radius = WORLDGEN_TEST_RADIUS;
+	world->falloffRadius = WORLDGEN_TEST_RADIUS - (CHUNK_SIZE_H * 2);
+
+	Queue<ivec3> sunNodes(MAX_LIGHT_NODES, MEMORY_LIGHT_NODES);
+	Queue<ivec3> lightNodes(MAX_LIGHT_NODES, MEMORY_LIGHT_NODES);
+
+	vector<WorldGenResult> results;
+
+	for (int biome = 0; biome < BIOME_COUNT; biome++)
+	{
+		for (int i = 0; i < WORLDGEN_SEED_COUNT; i++)
+		{
+			WorldGenResult result = {};
+			result.biome = (BiomeType)biome;
+			result.seed = g_worldGenSeeds[i];
+
+			RunWorldGenCase(world, result, sunNodes, lightNodes);
+			results.push_back(result);
+		}
+	}
+
+	int simdLevel = Noise::GetSIMDLevel();
+
+	char goldenPath[MAX_PATH];
+	PathToExe("Misc/WorldGenGolden.txt", goldenPath, MAX_PATH);
+
+	vector<WorldGenGolden> golden = LoadWorldGenGolden(goldenPath);
+
+	if (update)
+	{
+		SaveWorldGenGolden(goldenPath, golden, results, simdLevel);
+		printf("Recorded the golden hashes for SIMD level %i in %s.\n\n", simdLevel, goldenPath);
+
+		for (WorldGenResult& result : results)
+			result.status = WORLDGEN_RECORDED;
+	}
+	else CompareWorldGenGolden(results, golden, simdLevel);
+
+	ReportWorldGenResults(world, results, simdLevel);
+
+	bool failed = false, missing = false;
+
+	for (WorldGenResult& result : results)
+	{
+		if (!result.deterministic || result.status == WORLDGEN_MISMATCH)
+			failed = true;
+
+		// Once golden hashes are recorded, a case that isn't checked fails as well, so that
+		// a change of SIMD level or a new case can't pass unnoticed.
+		if (result.status == WORLDGEN_MISSING || result.status == WORLDGEN_SKIPPED)
+			missing = true;
+	}
+
+	if (!update && golden.empty())
+	{
+		printf("\nSkipped the golden check, since %s has no golden hashes. Run with -update to record them.\n", goldenPath);
+		missing = false;
+	}
+	else if (missing)
+		printf("\nThere are no golden hashes for SIMD level %i. Run with -update to record them.\n", simdLevel);
+
+	return failed || missing ? 1 : 0;
+}
+
+static int RunWorldGenBench(GameState* state, vector<char*>& args)
+{
+	bool update = false;
+
+	for (char* arg : args)
+	{
+		if (strcmp(arg, "-update") == 0)
+			update = true;
+	}
+
+	return RunWorldGenTest(state, update);
+}
@@ -12,13 +12,45 @@ static inline int RegionIndex(ivec3 p)
     return RegionIndex(p.x, p.y, p.z);
 }
 
+static inline int GroupRecordIndex(ChunkP p)
+{
+    return (p.x & REGION_MASK) + REGION_SIZE * (p.z & REGION_MASK);
+}
+
+// Returns the record list a position read from a region file refers to.
+static inline List<uint16_t>* GetRegionRecord(Region* region, int position)
+{
+    if (position < REGION_LIGHT_OFFSET)
+        return region->chunks + position;
+
+    if (position < REGION_GROUP_OFFSET)
+        return region->light + (position - REGION_LIGHT_OFFSET);
+
+    return region->groups + (position - REGION_GROUP_OFFSET);
+}
+
+// Regions are cleared when they're returned to the pool, so their records are
+// tagged each time one is taken.
+static void InitRegionRecords(Region* region)
+{
+    for (int i = 0; i < REGION_SIZE_3; i++)
+    {
+        region->chunks[i].tag = MEMORY_RECORDS;
+        region->light[i].tag = MEMORY_RECORDS;
+    }
+
+    for (int i = 0; i < REGION_SIZE_2; i++)
+        region->groups[i].tag = MEMORY_RECORDS;
+}
+
 static Region* LoadRegionFile(World* world, RegionP p)
 {
     Region* region = world->regionPool.Get();
     region->pos = p;
+    InitRegionRecords(region);
 
     char path[MAX_PATH];
-    sprintf(path, "%s\\%i%i.txt", world->savePath, p.x, p.z);
+    sprintf(path, "%s/%i%i.txt", world->savePath, p.x, p.z);
 
     if (!PathFileExists(path))
         return region;
@@ -28,7 +60,7 @@ static Region* LoadRegionFile(World* world, RegionP p)
     if (file == INVALID_HANDLE_VALUE)
     {
         Print("An error occurred while loading region %i, %i, %i: %s\n", p.x, p.y, p.z, GetLastErrorText().c_str());
-        return false;
+        return nullptr;
     }
 
     region->hasData = true;
@@ -41,23 +73,23 @@ static Region* LoadRegionFile(World* world, RegionP p)
         if (!ReadFile(file, &position, sizeof(uint16_t), &bytesRead, NULL))
         {
             Print("Failed to read chunk position. Error: %s\n", GetLastErrorText().c_str());
-            return false;
+            return nullptr;
         }
 
         if (bytesRead == 0) break;
-        assert(position >= 0 && position < REGION_SIZE_3);
+        assert(position >= 0 && position < REGION_RECORD_LIMIT);
 
         uint16_t items;
 
         if (!ReadFile(file, &items, sizeof(uint16_t), &bytesRead, NULL))
         {
             Print("Failed to read chunk items count. Error: %s\n", GetLastErrorText().c_str());
-            return false;
+            return nullptr;
         }
 
         if (bytesRead == 0) break;
 
-        List<uint16_t>* chunk = region->chunks + position;
+        List<uint16_t>* chunk = GetRegionRecord(region, position);
         chunk->Reserve(items + 2);
         chunk->Add(position);
         chunk->Add(items);
@@ -67,7 +99,7 @@ static Region* LoadRegionFile(World* world, RegionP p)
         {
             Print("Failed to load serialized chunk data. Error: %s", GetLastErrorText().c_str());
             Print("Tried to read %i items\n", items);
-            return false;
+            return nullptr;
         }
 
         if (bytesRead == 0) break;
@@ -77,6 +109,28 @@ static Region* LoadRegionFile(World* world, RegionP p)
     return region;
 }
 
+static void WriteRegionRecord(HANDLE file, List<uint16_t>& record)
+{
+    DWORD size = record.size;
+
+    if (size == 0)
+        return;
+
+    DWORD bytesToWrite = sizeof(uint16_t) * size;
+    DWORD bytesWritten;
+
+    if (!WriteFile(file, record.items, bytesToWrite, &bytesWritten, NULL))
+    {
+        Print("Failed to save chunk. Error: %s\n", GetLastErrorText().c_str());
+        return;
+    }
+
+    assert(bytesWritten == bytesToWrite);
+
+    if (SetFilePointer(file, 0l, nullptr, FILE_END) == INVALID_SET_FILE_POINTER)
+        Print("Failed to set the file pointer to the end of file.\n");
+}
+
 static void SaveRegion(World* world, Region* region)
 {
     if (!region->modified)
@@ -86,7 +140,7 @@ static void SaveRegion(World* world, Region* region)
     RegionP p = region->pos;
 
     char path[MAX_PATH];
-    sprintf(path, "%s\\%i%i.txt", world->savePath, p.x, p.z);
+    sprintf(path, "%s/%i%i.txt", world->savePath, p.x, p.z);
 
     HANDLE file = CreateFile(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
 
@@ -105,39 +159,19 @@ static void SaveRegion(World* world, Region* region)
                 int index = RegionIndex(x, y, z);
                 assert(index >= 0 && index < REGION_SIZE_3);
 
-                List<uint16_t>& chunk = region->chunks[index];
-                DWORD size = chunk.size;
-
-                if (size > 0)
-                {
-                    DWORD bytesToWrite = sizeof(uint16_t) * size;
-                    DWORD bytesWritten;
-
-                    if (!WriteFile(file, chunk.items, bytesToWrite, &bytesWritten, NULL))
-                    {
-                        Print("Failed to save chunk. Error: %s\n", GetLastErrorText().c_str());
-                        continue;
-                    }
-
-                    assert(bytesWritten == bytesToWrite);
-
-                    if (SetFilePointer(file, 0l, nullptr, FILE_END) == INVALID_SET_FILE_POINTER)
-                        Print("Failed to set the file pointer to the end of file.\n");
-                }
+                WriteRegionRecord(file, region->chunks[index]);
+                WriteRegionRecord(file, region->light[index]);
             }
         }
     }
 
+    for (int i = 0; i < REGION_SIZE_2; i++)
+        WriteRegionRecord(file, region->groups[i]);
+
     region->modified = false;
     CloseHandle(file);
 }
 
-static void SaveAllRegions(World* world)
-{
-    for (Region* region : world->regions)
-        SaveRegion(world, region);
-}
-
 static RegionEntry GetRegion(World* world, RegionP pos)
 {
     for (auto it = world->regions.begin(); it != world->regions.end(); it++)
@@ -164,28 +198,104 @@ static Region* GetOrLoadRegion(World* world, RegionP pos)
     return region;
 }
 
-static bool LoadGroupFromDisk(World* world, ChunkGroup* group)
+// Light is stored as run-length encoded (count, value) pairs where each value 
+// packs the sunlight into the upper four bits and the block light into the lower four.
+static inline uint16_t PackLight(Chunk* chunk, int i)
 {
-    ChunkP p = group->pos;
-    RegionP regionP = ChunkToRegionP(p);
+    return (uint16_t)((chunk->sunlight[i] << 4) | chunk->blockLight[i]);
+}
 
-    EnterCriticalSection(&world->regionCS);
+static void LoadChunkLight(Chunk* chunk, List<uint16_t>& lightData)
+{
+    int i = 0;
+    int loc = 2;
 
-    Region* region = GetOrLoadRegion(world, regionP);
-    region->activeCount++;
+    // As with block data, a count of 0 means the entire chunk shares one value.
+    if (lightData[loc] == 0)
+    {
+        uint8_t value = (uint8_t)lightData[loc + 1];
+        memset(chunk->sunlight, value >> 4, CHUNK_SIZE_3);
+        memset(chunk->blockLight, value & 15, CHUNK_SIZE_3);
+        return;
+    }
 
-    LeaveCriticalSection(&world->regionCS);
+    while (i < CHUNK_SIZE_3)
+    {
+        int count = lightData[loc++];
+        uint8_t value = (uint8_t)lightData[loc++];
 
-    bool complete = true;
+        for (int j = 0; j < count; j++, i++)
+        {
+            chunk->sunlight[i] = value >> 4;
+            chunk->blockLight[i] = value & 15;
+        }
+    }
+}
+
+// Restores the group's surface and, if valid, its light from the group record.
+// Returns false if there is no record for this group.
+static bool LoadGroupRecord(ChunkGroup* group, List<uint16_t>& record, List<uint16_t>** light)
+{
+    if (record.size == 0)
+        return false;
+
+    for (int i = 0; i < CHUNK_SIZE_2 / 2; i++)
+    {
+        uint16_t value = record[i + 3];
+        group->surface[i * 2] = (uint8_t)(value & 255);
+        group->surface[i * 2 + 1] = (uint8_t)(value >> 8);
+    }
+
+    if (!HasFlag(record[2], GROUP_RECORD_LIGHT_VALID))
+        return true;
 
     for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
     {
-        ivec3 local = ivec3(p.x & REGION_MASK, y, p.z & REGION_MASK);
-        int offset = RegionIndex(local);
+        if (light[y]->size == 0)
+            return true;
+    }
 
-        assert(offset >= 0 && offset < REGION_SIZE_3);
-        
-        List<uint16_t>& chunkData = region->chunks[offset];
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+        LoadChunkLight(group->chunks + y, *light[y]);
+
+    group->hasSavedLight = true;
+    group->lightRestored = true;
+
+    return true;
+}
+
+static void LoadChunkBlocks(Chunk* chunk, List<uint16_t>& chunkData)
+{
+    int i = 0; 
+    int loc = 2;
+
+    // If every block in the chunk is the same, the saved count will be 65536 
+    // but wrap to 0 as uint16_t's max is 65535. If we read in a 0, 
+    // interpret it to be that every block in this chunk is the same.
+    if (chunkData[loc] == 0)
+        FillChunk(chunk, chunkData[loc + 1]);
+    else
+    {
+        while (i < CHUNK_SIZE_3)
+        {
+            int count = chunkData[loc++];
+            Block block = chunkData[loc++];
+
+            for (int j = 0; j < count; j++)
+                chunk->blocks[i++] = block;
+        }
+    }
+}
+
+// Restores the group from its encoded records. Returns false if any chunk 
+// has no block data, in which case the group must be generated.
+static bool LoadGroupRecords(ChunkGroup* group, List<uint16_t>** blocks, List<uint16_t>** light, List<uint16_t>& record)
+{
+    bool complete = true;
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        List<uint16_t>& chunkData = *blocks[y];
 
         if (chunkData.size == 0)
         {
@@ -196,32 +306,74 @@ static bool LoadGroupFromDisk(World* world, ChunkGroup* group)
         Chunk* chunk = group->chunks + y;
         chunk->state = CHUNK_LOADED_DATA;
 
-        int i = 0; 
-        int loc = 2;
+        LoadChunkBlocks(chunk, chunkData);
+    }
 
-        // If every block in the chunk is the same, the saved count will be 65536 
-        // but wrap to 0 as uint16_t's max is 65535. If we read in a 0, 
-        // interpret it to be that every block in this chunk is the same.
-        if (chunkData[loc] == 0)
-            FillChunk(chunk, chunkData[loc + 1]);
-        else
-        {
-            while (i < CHUNK_SIZE_3)
-            {
-                int count = chunkData[loc++];
-                Block block = chunkData[loc++];
+    group->fromDisk = complete;
 
-                for (int j = 0; j < count; j++)
-                    chunk->blocks[i++] = block;
-            }
-        }
-    }
+    if (complete && !LoadGroupRecord(group, record, light))
+        ComputeSurface(group);
 
     return complete;
 }
 
+// Returns the group's region, loading it if necessary. The group holds a 
+// reference to the region from then on until it is removed from it.
+static Region* GetGroupRegion(World* world, ChunkGroup* group)
+{
+    EnterCriticalSection(&world->regionCS);
+
+    Region* region = GetOrLoadRegion(world, ChunkToRegionP(group->pos));
+
+    if (!group->inRegion)
+    {
+        region->activeCount++;
+        group->inRegion = true;
+    }
+
+    LeaveCriticalSection(&world->regionCS);
+    return region;
+}
+
+static bool LoadGroupFromDisk(World* world, ChunkGroup* group)
+{
+    ChunkP p = group->pos;
+    Region* region = GetGroupRegion(world, group);
+
+    List<uint16_t>* blocks[WORLD_CHUNK_HEIGHT];
+    List<uint16_t>* light[WORLD_CHUNK_HEIGHT];
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        ivec3 local = ivec3(p.x & REGION_MASK, y, p.z & REGION_MASK);
+        int offset = RegionIndex(local);
+
+        assert(offset >= 0 && offset < REGION_SIZE_3);
+        
+        blocks[y] = region->chunks + offset;
+        light[y] = region->light + offset;
+    }
+
+    return LoadGroupRecords(group, blocks, light, region->groups[GroupRecordIndex(p)]);
+}
+
+static void FreeRegionRecords(Region* region)
+{
+    for (int i = 0; i < REGION_SIZE_3; i++)
+    {
+        region->chunks[i].Free();
+        region->light[i].Free();
+    }
+
+    for (int i = 0; i < REGION_SIZE_2; i++)
+        region->groups[i].Free();
+}
+
 static void RemoveFromRegion(World* world, ChunkGroup* group)
 {
+    if (!group->inRegion)
+        return;
+
     RegionP regionP = ChunkToRegionP(group->pos);
 
     EnterCriticalSection(&world->regionCS);
@@ -234,6 +386,7 @@ static void RemoveFromRegion(World* world, ChunkGroup* group)
     if (region->activeCount == 0)
     {
         SaveRegion(world, region);
+        FreeRegionRecords(region);
         memset(region, 0, sizeof(Region));
         world->regionPool.Return(region);
         world->regions.erase(it);
@@ -242,92 +395,408 @@ static void RemoveFromRegion(World* world, ChunkGroup* group)
     LeaveCriticalSection(&world->regionCS);
 }
 
+static void SaveChunkBlocks(List<uint16_t>& store, Chunk* chunk, int offset)
+{
+    store.Clear();
+    store.Reserve(4096);
+
+    store.Add((uint16_t)offset);
+
+    // Holds the number of elements we will write. We won't know this value until 
+    // after the RLE compression, but we should reserve its position in the data.
+    store.Add(0);
+
+    Block currentBlock = chunk->blocks[0];
+    uint16_t count = 1;
+
+    for (int i = 1; i < CHUNK_SIZE_3; i++)
+    {
+        Block block = chunk->blocks[i];
+
+        if (block != currentBlock)
+        {
+            store.Add(count);
+            store.Add(currentBlock);
+            count = 1;
+            currentBlock = block;
+        }
+        else count++;
+
+        if (i == CHUNK_SIZE_3 - 1)
+        {
+            store.Add(count);
+            store.Add(currentBlock);
+        }
+    }
+
+    store[1] = (uint16_t)(store.size - 2);
+}
+
+// Returns false if the encoded light is too large to be described by the
+// record's 16-bit item count. The record is cleared in that case.
+static bool SaveChunkLight(List<uint16_t>& store, Chunk* chunk, int offset)
+{
+    store.Clear();
+    store.Reserve(4096);
+
+    store.Add((uint16_t)(offset + REGION_LIGHT_OFFSET));
+    store.Add(0);
+
+    uint16_t currentValue = PackLight(chunk, 0);
+    uint16_t count = 1;
+
+    for (int i = 1; i < CHUNK_SIZE_3; i++)
+    {
+        uint16_t value = PackLight(chunk, i);
+
+        if (value != currentValue)
+        {
+            store.Add(count);
+            store.Add(currentValue);
+            count = 1;
+            currentValue = value;
+        }
+        else count++;
+
+        if (i == CHUNK_SIZE_3 - 1)
+        {
+            store.Add(count);
+            store.Add(currentValue);
+        }
+    }
+
+    if (store.size - 2 > UINT16_MAX)
+    {
+        store.Clear();
+        return false;
+    }
+
+    store[1] = (uint16_t)(store.size - 2);
+    return true;
+}
+
+static void SaveGroupRecord(List<uint16_t>& store, ChunkGroup* group, bool lightValid)
+{
+    int items = 1 + (CHUNK_SIZE_2 / 2);
+
+    store.Clear();
+    store.Reserve(items + 2);
+
+    store.Add((uint16_t)(REGION_GROUP_OFFSET + GroupRecordIndex(group->pos)));
+    store.Add((uint16_t)items);
+    store.Add((uint16_t)(lightValid ? GROUP_RECORD_LIGHT_VALID : 0));
+
+    for (int i = 0; i < CHUNK_SIZE_2; i += 2)
+        store.Add((uint16_t)(group->surface[i] | (group->surface[i + 1] << 8)));
+}
+
+// Groups are written in full the first time they're saved so that revisiting them 
+// doesn't require generation. Once the group's lighting is complete, it is saved 
+// alongside the blocks so that the group can skip preprocessing when loaded again.
 static void SaveGroup(GameState*, World* world, void* groupPtr)
 {
+    TIMED_FUNCTION;
+
     ChunkGroup* group = (ChunkGroup*)groupPtr;
     ChunkP p = group->pos;
 
+    // Groups that never finished loading have nothing meaningful to save.
+    if (group->state == GROUP_DEFAULT)
+        return;
+
+    bool anyModified = false;
+
     for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
-    {
-        Chunk* chunk = group->chunks + y;
+        anyModified |= group->chunks[y].modified;
 
-        if (!chunk->modified)
-            continue;
+    bool writeBlocks = anyModified || !group->fromDisk;
+    bool writeLight = group->lightComplete && (writeBlocks || group->lightDirty || !group->hasSavedLight);
+    bool lightValid = writeLight || (group->hasSavedLight && !writeBlocks && !group->lightDirty);
 
-        RegionP regionP = ChunkToRegionP(p);
-        
-        RegionEntry entry = GetRegion(world, regionP);
-        assert(entry != world->regions.end());
-        Region* region = *entry;
+    if (!writeBlocks && !writeLight && lightValid == group->hasSavedLight)
+        return;
 
-        region->modified = true;
+    Region* region = GetGroupRegion(world, group);
+
+    region->modified = true;
+    region->hasData = true;
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        Chunk* chunk = group->chunks + y;
 
         ivec3 local = ivec3(p.x & REGION_MASK, y, p.z & REGION_MASK);
         int offset = RegionIndex(local);
 
         assert(offset >= 0 && offset < REGION_SIZE_3);
 
-        List<uint16_t>& store = region->chunks[offset];
-        region->hasData = true;
-        store.Clear();
-        store.Reserve(4096);
+        if (chunk->modified || !group->fromDisk)
+            SaveChunkBlocks(region->chunks[offset], chunk, offset);
+
+        if (writeLight && !SaveChunkLight(region->light[offset], chunk, offset))
+            lightValid = false;
+
+        chunk->modified = false;
+    }
 
-        store.Add((uint16_t)offset);
+    SaveGroupRecord(region->groups[GroupRecordIndex(p)], group, lightValid);
 
-        // Holds the number of elements we will write. We won't know this value until 
-        // after the RLE compression, but we should reserve its position in the data.
-        store.Add(0);
+    group->fromDisk = true;
+    group->hasSavedLight = lightValid;
+    group->lightDirty = false;
+}
 
-        Block currentBlock = chunk->blocks[0];
-        uint16_t count = 1;
+static inline void CopyRecord(List<uint16_t>& dest, List<uint16_t>& src)
+{
+    if (src.size == 0)
+        return;
 
-        for (int i = 1; i < CHUNK_SIZE_3; i++)
-        {
-            Block block = chunk->blocks[i];
+    dest.Reserve(src.size);
+    memcpy(dest.items, src.items, src.size * sizeof(uint16_t));
+    dest.size = src.size;
+}
 
-            if (block != currentBlock)
-            {
-                store.Add(count);
-                store.Add(currentBlock);
-                count = 1;
-                currentBlock = block;
-            }
-            else count++;
+static void FreeCachedGroup(CachedGroup* entry)
+{
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        entry->blocks[y].Free();
+        entry->light[y].Free();
+    }
 
-            if (i == CHUNK_SIZE_3 - 1)
-            {
-                store.Add(count);
-                store.Add(currentBlock);
-            }
-        }
+    entry->record.Free();
 
-        store[1] = (uint16_t)(store.size - 2);
-        chunk->modified = false;
+    TRACK_FREE(MEMORY_GROUP_CACHE, sizeof(CachedGroup));
+    delete entry;
+}
+
+static void UnlinkCachedGroup(GroupCache* cache, CachedGroup* entry)
+{
+    if (entry->prev != nullptr)
+        entry->prev->next = entry->next;
+    else cache->head = entry->next;
+
+    if (entry->next != nullptr)
+        entry->next->prev = entry->prev;
+    else cache->tail = entry->prev;
+
+    cache->entries.erase(entry->pos);
+    cache->bytes -= entry->bytes;
+    cache->count--;
+}
+
+// Evicts the least recently cached groups until the cache fits its budget.
+// Must be called with the cache locked.
+static void TrimGroupCache(GroupCache* cache)
+{
+    while (cache->bytes > cache->budget && cache->tail != nullptr)
+    {
+        CachedGroup* entry = cache->tail;
+        UnlinkCachedGroup(cache, entry);
+        FreeCachedGroup(entry);
     }
 }
 
+// Encodes the group into the cache. The group must have just been saved, so that 
+// the entry matches what the group's region holds for it.
+static void CacheGroup(World* world, ChunkGroup* group)
+{
+    GroupCache* cache = world->groupCache;
+
+    if (cache->budget == 0 || !group->fromDisk)
+        return;
+
+    CachedGroup* entry = new CachedGroup();
+    entry->pos = group->pos;
+    TRACK_ALLOC(MEMORY_GROUP_CACHE, sizeof(CachedGroup));
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        entry->blocks[y].tag = MEMORY_GROUP_CACHE;
+        entry->light[y].tag = MEMORY_GROUP_CACHE;
+    }
+
+    entry->record.tag = MEMORY_GROUP_CACHE;
+
+    List<uint16_t> scratch = {};
+    scratch.tag = MEMORY_GROUP_CACHE;
+    ChunkP p = group->pos;
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        Chunk* chunk = group->chunks + y;
+        int offset = RegionIndex(p.x & REGION_MASK, y, p.z & REGION_MASK);
+
+        SaveChunkBlocks(scratch, chunk, offset);
+        CopyRecord(entry->blocks[y], scratch);
+
+        if (group->hasSavedLight && SaveChunkLight(scratch, chunk, offset))
+            CopyRecord(entry->light[y], scratch);
+    }
+
+    SaveGroupRecord(scratch, group, group->hasSavedLight);
+    CopyRecord(entry->record, scratch);
+    scratch.Free();
+
+    int bytes = sizeof(CachedGroup) + entry->record.size * sizeof(uint16_t);
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+        bytes += (entry->blocks[y].size + entry->light[y].size) * sizeof(uint16_t);
+
+    entry->bytes = bytes;
+
+    EnterCriticalSection(&cache->cs);
+
+    // A newer copy of the group replaces an older one.
+    auto it = cache->entries.find(entry->pos);
+
+    if (it != cache->entries.end())
+    {
+        CachedGroup* old = it->second;
+        UnlinkCachedGroup(cache, old);
+        FreeCachedGroup(old);
+    }
+
+    entry->next = cache->head;
+
+    if (cache->head != nullptr)
+        cache->head->prev = entry;
+    else cache->tail = entry;
+
+    cache->head = entry;
+    cache->entries.insert(make_pair(entry->pos, entry));
+    cache->bytes += bytes;
+    cache->count++;
+
+    TrimGroupCache(cache);
+
+    LeaveCriticalSection(&cache->cs);
+}
+
+// Removes and returns the cache entry for the group at the given position, if one exists.
+static CachedGroup* TakeCachedGroup(World* world, ChunkP pos)
+{
+    GroupCache* cache = world->groupCache;
+    CachedGroup* entry = nullptr;
+
+    EnterCriticalSection(&cache->cs);
+
+    auto it = cache->entries.find(pos);
+
+    if (it != cache->entries.end())
+    {
+        entry = it->second;
+        UnlinkCachedGroup(cache, entry);
+        cache->hits++;
+    }
+    else cache->misses++;
+
+    LeaveCriticalSection(&cache->cs);
+    return entry;
+}
+
+static bool IsGroupCached(World* world, ChunkP pos)
+{
+    GroupCache* cache = world->groupCache;
+
+    EnterCriticalSection(&cache->cs);
+    bool cached = cache->entries.find(pos) != cache->entries.end();
+    LeaveCriticalSection(&cache->cs);
+
+    return cached;
+}
+
+// Restores a group taken from the group cache. The group doesn't acquire its region 
+// here, as the entry already holds everything the region would provide.
+static void LoadGroupFromCache(ChunkGroup* group)
+{
+    CachedGroup* entry = group->cached;
+
+    List<uint16_t>* blocks[WORLD_CHUNK_HEIGHT];
+    List<uint16_t>* light[WORLD_CHUNK_HEIGHT];
+
+    for (int y = 0; y < WORLD_CHUNK_HEIGHT; y++)
+    {
+        blocks[y] = entry->blocks + y;
+        light[y] = entry->light + y;
+    }
+
+    bool complete = LoadGroupRecords(group, blocks, light, entry->record);
+    assert(complete);
+    Unused(complete);
+
+    FreeCachedGroup(entry);
+    group->cached = nullptr;
+}
+
+static void SaveAndCacheGroup(GameState* state, World* world, void* groupPtr)
+{
+    SaveGroup(state, world, groupPtr);
+    CacheGroup(world, (ChunkGroup*)groupPtr);
+}
+
+static void ClearGroupCache(World* world)
+{
+    GroupCache* cache = world->groupCache;
+
+    EnterCriticalSection(&cache->cs);
+
+    while (cache->head != nullptr)
+    {
+        CachedGroup* entry = cache->head;
+        UnlinkCachedGroup(cache, entry);
+        FreeCachedGroup(entry);
+    }
+
+    LeaveCriticalSection(&cache->cs);
+}
+
+static void SetGroupCacheBudget(World* world, int64_t budget)
+{
+    GroupCache* cache = world->groupCache;
+
+    EnterCriticalSection(&cache->cs);
+    cache->budget = budget;
+    TrimGroupCache(cache);
+    LeaveCriticalSection(&cache->cs);
+}
+
+#if !HEADLESS
+
+static void SaveAllRegions(World* world)
+{
+    for (Region* region : world->regions)
+        SaveRegion(world, region);
+}
+
+// Saves the world on exit. The headless suites never save their worlds.
 static void SaveWorld(GameState* state, World* world)
 {
     char path[MAX_PATH];
-    sprintf(path, "%s\\WorldData.txt", world->savePath);
+    sprintf(path, "%s/WorldData.txt", world->savePath);
 
     WriteBinary(path, (char*)&world->properties, sizeof(WorldProperties));
 
     for (int i = 0; i < world->totalGroups; i++)
-        SaveGroup(state, world, world->groups[i]);
+    {
+        if (world->groups[i] != nullptr)
+            SaveGroup(state, world, world->groups[i]);
+    }
 
     SaveAllRegions(world);
 }
 
+#endif
+
 static bool LoadWorldFileData(GameState* state, World* world)
 {
     world->savePath = new char[MAX_PATH]();
-    world->savePath = strcat(strcat(world->savePath, state->savePath), "\\World");
+    world->savePath = strcat(strcat(world->savePath, state->savePath), "/World");
 
     CreateDirectory(world->savePath, NULL);
 
     char path[MAX_PATH];
-    sprintf(path, "%s\\WorldData.txt", world->savePath);
+    sprintf(path, "%s/WorldData.txt", world->savePath);
 
     if (PathFileExists(path))
     {
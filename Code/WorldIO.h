@@ -4,23 +4,72 @@
 
 // Number of chunks on each dimensions in a region file.
 #define REGION_SIZE 8
+#define REGION_SIZE_2 64
 #define REGION_SIZE_3 256
 #define REGION_MASK 7
 
+// Records in a region file are keyed by a position. Block data for a chunk uses 
+// positions below REGION_SIZE_3. Light data for a chunk is offset by REGION_LIGHT_OFFSET 
+// and group data (surface and light validity) by REGION_GROUP_OFFSET.
+#define REGION_LIGHT_OFFSET 256
+#define REGION_GROUP_OFFSET 512
+#define REGION_RECORD_LIMIT 576
+
+// Set in a group record if the stored light data for the group's chunks is valid.
+#define GROUP_RECORD_LIGHT_VALID 1
+
+// Default memory budget for the group cache, in bytes.
+#define GROUP_CACHE_DEFAULT_BUDGET (64 * 1024 * 1024)
+
 typedef list<Region*>::iterator RegionEntry;
 
 struct Region
 {
     RegionP pos;
     List<uint16_t> chunks[REGION_SIZE_3];
+    List<uint16_t> light[REGION_SIZE_3];
+    List<uint16_t> groups[REGION_SIZE_2];
     bool hasData, modified;
     Region* next;
     Region* prev;
     int activeCount;
 };
 
+// A group that left the loaded area, kept in the same encoding used by region files.
+// Entries form a doubly-linked list ordered from most to least recently cached.
+struct CachedGroup
+{
+    ChunkP pos;
+    List<uint16_t> blocks[WORLD_CHUNK_HEIGHT];
+    List<uint16_t> light[WORLD_CHUNK_HEIGHT];
+    List<uint16_t> record;
+    int bytes;
+    CachedGroup* next;
+    CachedGroup* prev;
+};
+
+// Recently unloaded groups, so that moving back and forth across the edge of the 
+// loaded area doesn't repeatedly load regions from disk. Entries are added by 
+// worker threads and taken on the main thread, so access is guarded by cs.
+struct GroupCache
+{
+    unordered_map<ivec3, CachedGroup*, ivec3Key, ivec3Key> entries;
+    CachedGroup* head;
+    CachedGroup* tail;
+
+    int64_t bytes, budget;
+    int count, hits, misses;
+
+    CRITICAL_SECTION cs;
+};
+
 static bool LoadGroupFromDisk(World* world, ChunkGroup* group);
 static void SaveGroup(GameState*, World* world, void* groupPtr);
-static void DeleteRegions(World* world);
 static bool LoadWorldFileData(GameState* state, World* world);
 static void RemoveFromRegion(World* world, ChunkGroup* group);
+static void LoadGroupFromCache(ChunkGroup* group);
+static CachedGroup* TakeCachedGroup(World* world, ChunkP pos);
+static bool IsGroupCached(World* world, ChunkP pos);
+static void SaveAndCacheGroup(GameState* state, World* world, void* groupPtr);
+static void ClearGroupCache(World* world);
+static void SetGroupCacheBudget(World* world, int64_t budget);
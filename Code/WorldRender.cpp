@@ -2,60 +2,97 @@
 // Gamecraft
 //
 
-// Builds mesh data for the chunk.
+// Builds mesh data for the chunk's sections that are flagged for building.
 static void BuildChunkAsync(GameState*, World* world, void* chunkPtr)
 {
     Chunk* chunk = (Chunk*)chunkPtr;
+    MeshData* data = chunk->meshData;
+    int sections = chunk->buildSections;
+
+    // Sections that aren't rebuilt keep their vertices.
     chunk->totalVertices = 0;
-    
-    for (int y = 0; y < CHUNK_SIZE_V; y++)
+
+    for (int s = 0; s < CHUNK_SECTIONS; s++)
     {
-        for (int z = 0; z < CHUNK_SIZE_H; z++)
+        if (!HasFlag(sections, 1 << s))
+            chunk->totalVertices += SectionVertCount(chunk->mesh.sections[s]);
+    }
+
+    for (int s = 0; s < CHUNK_SECTIONS; s++)
+    {
+        if (!HasFlag(sections, 1 << s))
+            continue;
+
+        BeginMeshSection(data, s);
+
+        int startY = s << CHUNK_SECTION_BITS;
+        int endY = startY + (1 << CHUNK_SECTION_BITS);
+    
+        for (int y = startY; y < endY; y++)
         {
-            for (int x = 0; x < CHUNK_SIZE_H; x++)
+            for (int z = 0; z < CHUNK_SIZE_H; z++)
             {
-                Block block = GetBlock(chunk, x, y, z);
-
-                if (block != BLOCK_AIR)
+                for (int x = 0; x < CHUNK_SIZE_H; x++)
                 {
-                    if (IsVisible(world, block))
-                        BuildFunc(world, block)(world, chunk, chunk->meshData, x, y, z, block);
+                    Block block = GetBlock(chunk, x, y, z);
+
+                    if (block != BLOCK_AIR)
+                    {
+                        if (IsVisible(world, block))
+                            BuildFunc(world, block)(world, chunk, data, x, y, z, block);
+                    }
                 }
             }
         }
+
+        EndMeshSection(data, s);
     }
 }
 
-static void RebuildChunksAsync(GameState* state, World* world, void* chunksPtr)
+// Rebuilds a chunk that was already built. The chunk may be edited on the main thread 
+// while it's meshed. Results built from data that changed are discarded when the chunk 
+// is filled, by comparing the chunk's version.
+static void RebuildChunkAsync(GameState* state, World* world, void* chunkPtr)
 {
     TIMED_FUNCTION;
-
-    auto& chunks = *(vector<Chunk*>*)chunksPtr;
-
-    for (int i = 0; i < chunks.size(); i++)
-        BuildChunkAsync(state, world, chunks[i]);
+    BuildChunkAsync(state, world, chunkPtr);
 }
 
 static void OnChunkBuilt(GameState*, World* world, void* chunkPtr)
 {
     Chunk* chunk = (Chunk*)chunkPtr;
+    PIPELINE_STAGE(PIPELINE_BUILD, chunk->stageTime);
+
     world->workCount--;
     assert(world->workCount >= 0);
     chunk->state = CHUNK_NEEDS_FILL;
+    world->chunksToFill.push_back(chunk);
 }
 
-static void OnChunksRebuilt(GameState*, World* world, void* chunksPtr)
+// Chunks in a batch only become ready to fill once the whole batch is rebuilt, so an edit 
+// that affects several chunks shows up in all of them in the same frame.
+static void OnChunkRebuilt(GameState*, World* world, void* chunkPtr)
 {
-    auto& chunks = *(vector<Chunk*>*)chunksPtr;
-
-    for (int i = 0; i < chunks.size(); i++)
-        chunks[i]->state = CHUNK_NEEDS_FILL;
-
-    chunks.clear();
+    Chunk* chunk = (Chunk*)chunkPtr;
+    RebuildBatch* batch = chunk->rebuildBatch;
 
-    world->chunksRebuilding = false;
     world->workCount--;
     assert(world->workCount >= 0);
+
+    if (--batch->remaining > 0)
+        return;
+
+    for (int i = 0; i < batch->chunks.size(); i++)
+    {
+        Chunk* next = batch->chunks[i];
+        next->state = CHUNK_NEEDS_FILL;
+        next->rebuilding = false;
+        next->rebuildBatch = nullptr;
+        world->chunksToFill.push_back(next);
+    }
+
+    delete batch;
+    world->rebuildBatches--;
 }
 
 static inline void SetChunkMeshData(Renderer& rend, Chunk* chunk)
@@ -64,30 +101,54 @@ static inline void SetChunkMeshData(Renderer& rend, Chunk* chunk)
     assert(chunk->meshData == nullptr);
     chunk->meshData = GetMeshData(rend.meshData);
     assert(chunk->meshData != nullptr);
+
+    chunk->meshVersion = chunk->version;
+    chunk->meshEditTime = chunk->editTime;
+    chunk->editTime = 0.0;
+
+    chunk->buildSections = chunk->dirtySections;
+    chunk->dirtySections = 0;
 }
 
 static void BuildChunk(GameState* state, World* world, Chunk* chunk)
 {
     Renderer& rend = state->renderer;
     SetChunkMeshData(rend, chunk);
+    chunk->buildSections = ALL_CHUNK_SECTIONS;
 
     world->workCount++;
     chunk->state = CHUNK_BUILDING;
+    PIPELINE_BEGIN(chunk->stageTime);
 
     QueueAsync(state, BuildChunkAsync, world, chunk, OnChunkBuilt);
 }
 
+// Each chunk is rebuilt as its own job. Chunks containing an edited block are 
+// queued ahead of the neighbors that were flagged because of the edit.
 static void RebuildChunks(GameState* state, World* world)
 {
     Renderer& rend = state->renderer;
-    auto& chunks = world->chunksToRebuild;
+
+    RebuildBatch* batch = new RebuildBatch();
+    batch->chunks.swap(world->chunksToRebuild);
+
+    auto& chunks = batch->chunks;
+    batch->remaining = (int)chunks.size();
 
     for (int i = 0; i < chunks.size(); i++)
-        SetChunkMeshData(rend, chunks[i]);
+    {
+        Chunk* chunk = chunks[i];
+        SetChunkMeshData(rend, chunk);
+        chunk->rebuildBatch = batch;
 
-    world->chunksRebuilding = true;
-    world->workCount++;
-    QueueAsync(state, RebuildChunksAsync, world, &world->chunksToRebuild, OnChunksRebuilt);
+        AsyncPriority priority = chunk->edited ? ASYNC_PRIORITY_HIGH : ASYNC_PRIORITY_MEDIUM;
+        chunk->edited = false;
+
+        world->workCount++;
+        QueueAsync(state, RebuildChunkAsync, world, chunk, OnChunkRebuilt, priority);
+    }
+
+    world->rebuildBatches++;
 }
 
 static void ReturnChunkMesh(Renderer& rend, Chunk* chunk)
@@ -101,25 +162,15 @@ static void ReturnChunkMesh(Renderer& rend, Chunk* chunk)
     }
 }
 
+// Replaces the sections of the chunk's mesh that were built. Other sections keep their data.
 static void FillChunkMesh(Renderer& rend, Chunk* chunk)
 {
-    if (chunk->hasMeshes)
-    {
-        DestroyMesh(chunk->mesh);
-        chunk->hasMeshes = false;
-    }
-
     MeshData* data = chunk->meshData;
     assert(data != nullptr);
 
-    // The vertex count would be 0 if the only blocks belonging to the mesh type were culled away. 
-    if (data->vertCount > 0)
-    {
-        FillMeshData(rend.meshData, chunk->mesh, data, GL_DYNAMIC_DRAW);
-        chunk->hasMeshes = true;
-    }
-    else ReturnMeshData(rend.meshData, data);
+    FillMeshSections(chunk->mesh, data, chunk->buildSections, GL_DYNAMIC_DRAW);
 
+    ReturnMeshData(rend.meshData, data);
     chunk->meshData = nullptr;
 }
 
@@ -147,16 +198,67 @@ static void PreprocessGroup(GameState*, World* world, void* groupPtr)
 
     ChunkGroup* group = (ChunkGroup*)groupPtr;
 
-    Queue<ivec3> sunNodes(MAX_LIGHT_NODES);
-    Queue<ivec3> lightNodes(MAX_LIGHT_NODES);
+    ScratchScope scratch;
+    Queue<ivec3> sunNodes(scratch.arena, MAX_LIGHT_NODES);
+    Queue<ivec3> lightNodes(scratch.arena, MAX_LIGHT_NODES);
+
+    // A neighbor was regenerated since this group's light was saved, so the restored
+    // light may be wrong. Relight from scratch, keeping what the neighbors contributed.
+    if (group->lightRestored)
+    {
+        ClearGroupLight(group);
+        QueueNeighborBorderLight(world, group, sunNodes, lightNodes);
+        group->lightRestored = false;
+        group->lightDirty = true;
+    }
+
     SetLightNodes(world, group, sunNodes, lightNodes);
 
     group->state = GROUP_PREPROCESSED;
 }
 
-static void OnGroupPreprocessed(GameState*, World* world, void*)
+// Restored light can be used as-is only if every neighbor has the same blocks it had 
+// when the light was saved, which is guaranteed when they were all loaded from disk.
+static bool CanRestoreLight(World* world, ChunkGroup* group)
+{
+    if (!group->lightRestored)
+        return false;
+
+    LChunkP p = group->chunks->lcPos;
+
+    for (int i = 0; i < 8; i++)
+    {
+        LChunkP next = p + DIRS_2[i];
+
+        if (!GetGroup(world, next.x, next.z)->fromDisk)
+            return false;
+    }
+
+    return true;
+}
+
+static void RestoreGroupLight(GameState*, World* world, void* groupPtr)
+{
+    TIMED_FUNCTION;
+
+    ChunkGroup* group = (ChunkGroup*)groupPtr;
+
+    ScratchScope scratch;
+    Queue<ivec3> sunNodes(scratch.arena, MAX_LIGHT_NODES);
+    Queue<ivec3> lightNodes(scratch.arena, MAX_LIGHT_NODES);
+    SetBorderLightNodes(world, group, sunNodes, lightNodes);
+
+    group->lightRestored = false;
+    group->state = GROUP_PREPROCESSED;
+}
+
+static void OnGroupPreprocessed(GameState*, World* world, void* groupPtr)
 {
+    ChunkGroup* group = (ChunkGroup*)groupPtr;
+    PIPELINE_END(PIPELINE_PREPROCESS, group->stageTime);
+
     world->workCount--;
+    FlagGroupChanged(world, group);
 }
 
 static void PrepareWorldRender(GameState* state, World* world, Renderer& rend)
@@ -164,9 +266,11 @@ static void PrepareWorldRender(GameState* state, World* world, Renderer& rend)
     TIMED_FUNCTION;
 
     for (int i = 0; i < MESH_TYPE_COUNT; i++)
-        rend.meshLists[i].clear();
+        rend.meshLists[i] = NewFrameVector<ChunkMesh>();
+
+    rend.emitters = NewFrameVector<ParticleEmitter*>();
 
-    auto& visible = world->visibleChunks;
+    auto& visible = *world->visibleChunks;
 
     for (int i = 0; i < visible.size(); i++)
     {
@@ -181,19 +285,34 @@ static void PrepareWorldRender(GameState* state, World* world, Renderer& rend)
 
             case CHUNK_NEEDS_FILL:
             {
-                if (chunk->pendingUpdate)
+                // The chunk changed while being meshed, so the result is stale. The 
+                // existing mesh is kept until the rebuild queued below completes.
+                if (chunk->meshVersion != chunk->version)
+                {
                     ReturnChunkMesh(rend, chunk);
-                else FillChunkMesh(rend, chunk);
+                    chunk->pendingUpdate = true;
+                    chunk->dirtySections |= chunk->buildSections;
+
+                    if (chunk->meshEditTime > 0.0)
+                        chunk->editTime = chunk->meshEditTime;
+                }
+                else 
+                {
+                    FillChunkMesh(rend, chunk);
+                    RECORD_EDIT_SHOWN(chunk->meshEditTime);
+                    PIPELINE_END(PIPELINE_FILL_WAIT, chunk->stageTime);
+                }
 
                 chunk->state = CHUNK_BUILT;
             }
 
             case CHUNK_BUILT:
             {
-                if (!world->chunksRebuilding && chunk->pendingUpdate)
+                if (chunk->pendingUpdate && !chunk->rebuilding && world->rebuildBatches < MAX_REBUILD_BATCHES)
                 {
                     world->chunksToRebuild.push_back(chunk);
                     chunk->pendingUpdate = false;
+                    chunk->rebuilding = true;
                 }
 
                 Mesh& mesh = chunk->mesh;
@@ -205,8 +324,7 @@ static void PrepareWorldRender(GameState* state, World* world, Renderer& rend)
 
                     if (indices.count > 0)
                     {
-                        vector<ChunkMesh>& list = rend.meshLists[m];
-                        list.push_back(cM);
+                        rend.meshLists[m]->push_back(cM);
                         DRAW_CHUNK_OUTLINE(chunk);
                     }
                 }
@@ -214,89 +332,144 @@ static void PrepareWorldRender(GameState* state, World* world, Renderer& rend)
         }
     }
 
-    if (!world->chunksRebuilding && world->chunksToRebuild.size() > 0)
+    if (world->rebuildBatches < MAX_REBUILD_BATCHES && world->chunksToRebuild.size() > 0)
         RebuildChunks(state, world);
 
     Biome& biome = GetCurrentBiome(world);
-    rend.emitters.push_back(biome.weather.emitter);
+    rend.emitters->push_back(biome.weather.emitter);
 }
 
-static void WorldRenderUpdate(GameState* state, World* world, Camera* cam)
-{    
-    TIMED_FUNCTION;
-    
-    world->visibleChunks.clear();
-    world->groupsToProcess.clear();
+static bool NeighborsPreprocessed(World* world, ChunkGroup* group)
+{
+    LChunkP p = group->chunks->lcPos;
 
-    for (int g = 0; g < world->totalGroups; g++)
+    for (int i = 0; i < 9; i++)
     {
-        ChunkGroup* group = world->groups[g];
+        LChunkP next = p + DIRS_2[i];
 
-        if (group->pendingDestroy || IsEdgeGroup(world, group)) 
-            continue;
+        ChunkGroup* adj = GetGroup(world, next.x, next.z);
+        assert(adj != nullptr);
 
-        world->groupsToProcess.push_back(group);
+        if (adj->state != GROUP_PREPROCESSED)
+            return false;
     }
 
-    vec2 playerChunk = vec2(world->loadRange, world->loadRange);
+    return true;
+}
 
-    auto& groups = world->groupsToProcess;
-    sort(groups.begin(), groups.end(), [playerChunk](auto a, auto b)
-    {
-        float distA = distance2(vec2(a->chunks->lcPos.x, a->chunks->lcPos.z), playerChunk);
-        float distB = distance2(vec2(b->chunks->lcPos.x, b->chunks->lcPos.z), playerChunk);
-        return distA < distB;
-    });
-        
-    for (int g = 0; g < world->groupsToProcess.size(); g++)
+// Checks the groups whose state or neighbors changed. Loaded groups are preprocessed 
+// in streaming priority order once their neighbors allow it. Preprocessed groups become 
+// renderable once all of their neighbors are preprocessed too. Group states only move 
+// forward until the world shifts, so a group that isn't ready yet is checked again 
+// when one of its neighbors changes.
+static void CheckChangedGroups(GameState* state, World* world, Camera* cam)
+{
+    auto& groups = world->groupsToCheck;
+
+    if (groups.empty())
+        return;
+
+    for (int g = 0; g < groups.size(); g++)
+        groups[g]->priority = StreamPriority(world, cam, world->player, groups[g]);
+
+    sort(groups.begin(), groups.end(), [](auto a, auto b) { return a->priority < b->priority; });
+
+    for (int g = 0; g < groups.size(); g++)
     {
-        ChunkGroup* group = world->groupsToProcess[g];
+        ChunkGroup* group = groups[g];
+        group->pendingCheck = false;
+
+        if (group->pendingDestroy || IsEdgeGroup(world, group)) 
+            continue;
 
         if (group->state == GROUP_LOADED && AllowPreprocess(world, group))
         {
             group->state = GROUP_PREPROCESSING;
             world->workCount++;
-            QueueAsync(state, PreprocessGroup, world, group, OnGroupPreprocessed);
+            PIPELINE_STAGE(PIPELINE_PREPROCESS_WAIT, group->stageTime);
+
+            if (CanRestoreLight(world, group))
+                QueueAsync(state, RestoreGroupLight, world, group, OnGroupPreprocessed);
+            else QueueAsync(state, PreprocessGroup, world, group, OnGroupPreprocessed);
         }
+        else if (group->state == GROUP_PREPROCESSED && !group->renderable && NeighborsPreprocessed(world, group))
+        {
+            group->renderable = true;
+            group->lightComplete = true;
+            world->renderListChanged = true;
+            PIPELINE_END(PIPELINE_GROUP_TOTAL, group->createTime);
+        }
+    }
 
-        LChunkP lcP = group->chunks->lcPos;
-        bool allowVisible = true;
+    groups.clear();
+}
 
-        for (int i = 0; i < 9; i++)
-        {
-            LChunkP next = lcP + DIRS_2[i];
+// Per-frame work is limited to the groups that changed, the renderable groups and 
+// their chunks. Chunks with mesh data ready are filled whether or not they're in view.
+static void WorldRenderUpdate(GameState* state, World* world, Camera* cam)
+{    
+    TIMED_FUNCTION;
 
-            ChunkGroup* adj = GetGroup(world, next.x, next.z);
-            assert(adj != nullptr);
+    CheckChangedGroups(state, world, cam);
 
-            if (adj->state != GROUP_PREPROCESSED)
-            {
-                allowVisible = false;
-                break;
-            }
+    if (world->renderListChanged)
+    {
+        world->groupsToRender.clear();
+
+        for (int i = 0; i < world->spiral.size(); i++)
+        {
+            ChunkGroup* group = world->groups[world->spiral[i]];
+
+            if (group->renderable)
+                world->groupsToRender.push_back(group);
         }
 
-        if (allowVisible)
+        world->renderListChanged = false;
+    }
+
+    world->visibleChunks = NewFrameVector<Chunk*>(world->totalGroups * WORLD_CHUNK_HEIGHT);
+
+    auto& fill = world->chunksToFill;
+    int remaining = 0;
+
+    for (int i = 0; i < fill.size(); i++)
+    {
+        Chunk* chunk = fill[i];
+
+        if (chunk->group->renderable)
+            world->visibleChunks->push_back(chunk);
+        else fill[remaining++] = chunk;
+    }
+
+    fill.resize(remaining);
+
+    for (int g = 0; g < world->groupsToRender.size(); g++)
+    {
+        ChunkGroup* group = world->groupsToRender[g];
+
+        ivec3 groupP = group->chunks->lwPos;
+        vec3 groupMin = vec3(groupP.x, 0.0f, groupP.z);
+        vec3 groupMax = groupMin + (vec3(CHUNK_SIZE_H, WORLD_BLOCK_HEIGHT, CHUNK_SIZE_H) - 1.0f);
+
+        if (TestFrustum(cam, groupMin, groupMax) == FRUSTUM_INVISIBLE)
+            continue;
+
+        for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
         {
-            for (int i = 0; i < WORLD_CHUNK_HEIGHT; i++)
-            {
-                Chunk* chunk = group->chunks + i;
+            Chunk* chunk = group->chunks + i;
 
-                if (chunk->state == CHUNK_NEEDS_FILL)
-                {
-                    world->visibleChunks.push_back(chunk);
-                    continue;
-                }
-                
-                ivec3 lwP = LChunkToLWorldP(chunk->lcPos);
-                vec3 min = vec3(lwP.x, lwP.y, lwP.z);
-                vec3 max = min + (vec3(CHUNK_SIZE_H, CHUNK_SIZE_V, CHUNK_SIZE_H) - 1.0f);
+            // Added above from the fill list.
+            if (chunk->state == CHUNK_NEEDS_FILL)
+                continue;
+            
+            ivec3 lwP = LChunkToLWorldP(chunk->lcPos);
+            vec3 min = vec3(lwP.x, lwP.y, lwP.z);
+            vec3 max = min + (vec3(CHUNK_SIZE_H, CHUNK_SIZE_V, CHUNK_SIZE_H) - 1.0f);
 
-                FrustumVisibility visibility = TestFrustum(cam, min, max);
+            FrustumVisibility visibility = TestFrustum(cam, min, max);
 
-                if (visibility >= FRUSTUM_VISIBLE)
-                    world->visibleChunks.push_back(chunk);
-            }
+            if (visibility >= FRUSTUM_VISIBLE)
+                world->visibleChunks->push_back(chunk);
         }
     }
 }
@@ -438,16 +611,12 @@ static inline bool ChunkOverflowed(World* world, Chunk* chunk, int x, int y, int
     return false;
 }
 
-#define LIGHT(a, o1, o2, o3) VertexLight(world, chunk, AXIS_##a, rP, o1, o2, o3)
-
 // Builds mesh data for a single block. x, y, and z are relative to the
 // chunk in local world space.
 static void BuildBlock(World* world, Chunk* chunk, MeshData* data, int xi, int yi, int zi, Block block)
 {
     uint16_t* textures = GetTextures(world, block);
 
-    ivec3 rP = ivec3(xi, yi, zi);
-
     int cull = GetCull(world, block);
     int meshIndex = GetMeshType(world, block);
 
@@ -455,6 +624,7 @@ static void BuildBlock(World* world, Chunk* chunk, MeshData* data, int xi, int y
     {
         MeshIndexData* indexData = new MeshIndexData;
         indexData->count = 0;
+        TRACK_ALLOC(MEMORY_MESH_INDICES, sizeof(MeshIndexData));
         data->indices[meshIndex] = indexData;
     }
 
@@ -463,94 +633,110 @@ static void BuildBlock(World* world, Chunk* chunk, MeshData* data, int xi, int y
 
     uint8_t x = (uint8_t)xi, y = (uint8_t)yi, z = (uint8_t)zi;
 
+    bool faces[6];
+    faces[FACE_TOP] = CheckFace(world, cull, block, adj.up, vAdded);
+    faces[FACE_BOTTOM] = CheckFace(world, cull, block, adj.down, vAdded);
+    faces[FACE_FRONT] = CheckFace(world, cull, block, adj.front, vAdded);
+    faces[FACE_BACK] = CheckFace(world, cull, block, adj.back, vAdded);
+    faces[FACE_RIGHT] = CheckFace(world, cull, block, adj.right, vAdded);
+    faces[FACE_LEFT] = CheckFace(world, cull, block, adj.left, vAdded);
+
+    if (vAdded == 0) return;
+
+    BlockLightSamples samples;
+    GatherBlockLight(world, chunk, xi, yi, zi, samples);
+
+    Colori light[24];
+    ComputeBlockLight(samples, light);
+
     uint8_t alpha = GetAlpha(world, block);
     
-    if (CheckFace(world, cull, block, adj.up, vAdded))
+    if (faces[FACE_TOP])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_TOP];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x + 1, y + 1, z), u16vec3(0, 1, w), LIGHT(Y, 1, 1, -1), alpha };
-        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(0, 0, w), LIGHT(Y, 1, 1, 1), alpha };
-        data->vertices[count + 2] = { u8vec3(x, y + 1, z + 1), u16vec3(1, 0, w), LIGHT(Y, -1, 1, 1), alpha };
-        data->vertices[count + 3] = { u8vec3(x, y + 1, z), u16vec3(1, 1, w), LIGHT(Y, -1, 1, -1), alpha };
+        data->vertices[count + 0] = { u8vec3(x + 1, y + 1, z), u16vec3(0, 1, w), light[FACE_TOP * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(0, 0, w), light[FACE_TOP * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x, y + 1, z + 1), u16vec3(1, 0, w), light[FACE_TOP * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x, y + 1, z), u16vec3(1, 1, w), light[FACE_TOP * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
 
-    if (CheckFace(world, cull, block, adj.down, vAdded))
+    if (faces[FACE_BOTTOM])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_BOTTOM];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x, y, z), u16vec3(0, 1, w), LIGHT(Y, -1, -1, -1), alpha };
-        data->vertices[count + 1] = { u8vec3(x, y, z + 1), u16vec3(0, 0, w), LIGHT(Y, -1, -1, 1), alpha };
-        data->vertices[count + 2] = { u8vec3(x + 1, y, z + 1), u16vec3(1, 0, w), LIGHT(Y, 1, -1, 1), alpha };
-        data->vertices[count + 3] = { u8vec3(x + 1, y, z), u16vec3(1, 1, w), LIGHT(Y, 1, -1, -1), alpha };
+        data->vertices[count + 0] = { u8vec3(x, y, z), u16vec3(0, 1, w), light[FACE_BOTTOM * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x, y, z + 1), u16vec3(0, 0, w), light[FACE_BOTTOM * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x + 1, y, z + 1), u16vec3(1, 0, w), light[FACE_BOTTOM * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x + 1, y, z), u16vec3(1, 1, w), light[FACE_BOTTOM * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
 
-    if (CheckFace(world, cull, block, adj.front, vAdded))
+    if (faces[FACE_FRONT])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_FRONT];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x, y, z + 1), u16vec3(0, 1, w), LIGHT(Z, -1, -1, 1), alpha };
-        data->vertices[count + 1] = { u8vec3(x, y + 1, z + 1), u16vec3(0, 0, w), LIGHT(Z, -1, 1, 1), alpha };
-        data->vertices[count + 2] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(1, 0, w), LIGHT(Z, 1, 1, 1), alpha };
-        data->vertices[count + 3] = { u8vec3(x + 1, y, z + 1), u16vec3(1, 1, w), LIGHT(Z, 1, -1, 1), alpha };
+        data->vertices[count + 0] = { u8vec3(x, y, z + 1), u16vec3(0, 1, w), light[FACE_FRONT * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x, y + 1, z + 1), u16vec3(0, 0, w), light[FACE_FRONT * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(1, 0, w), light[FACE_FRONT * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x + 1, y, z + 1), u16vec3(1, 1, w), light[FACE_FRONT * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
 
-    if (CheckFace(world, cull, block, adj.back, vAdded))
+    if (faces[FACE_BACK])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_BACK];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x + 1, y, z), u16vec3(0, 1, w), LIGHT(Z, 1, -1, -1), alpha };
-        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z), u16vec3(0, 0, w), LIGHT(Z, 1, 1, -1), alpha };
-        data->vertices[count + 2] = { u8vec3(x, y + 1, z), u16vec3(1, 0, w), LIGHT(Z, -1, 1, -1), alpha };
-        data->vertices[count + 3] = { u8vec3(x, y, z), u16vec3(1, 1, w), LIGHT(Z, -1, -1, -1), alpha };
+        data->vertices[count + 0] = { u8vec3(x + 1, y, z), u16vec3(0, 1, w), light[FACE_BACK * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z), u16vec3(0, 0, w), light[FACE_BACK * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x, y + 1, z), u16vec3(1, 0, w), light[FACE_BACK * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x, y, z), u16vec3(1, 1, w), light[FACE_BACK * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
 
-    if (CheckFace(world, cull, block, adj.right, vAdded))
+    if (faces[FACE_RIGHT])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_RIGHT];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x + 1, y, z + 1), u16vec3(0, 1, w), LIGHT(X, 1, -1, 1), alpha };
-        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(0, 0, w), LIGHT(X, 1, 1, 1), alpha };
-        data->vertices[count + 2] = { u8vec3(x + 1, y + 1, z), u16vec3(1, 0, w), LIGHT(X, 1, 1, -1), alpha };
-        data->vertices[count + 3] = { u8vec3(x + 1, y, z), u16vec3(1, 1, w), LIGHT(X, 1, -1, -1), alpha };
+        data->vertices[count + 0] = { u8vec3(x + 1, y, z + 1), u16vec3(0, 1, w), light[FACE_RIGHT * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x + 1, y + 1, z + 1), u16vec3(0, 0, w), light[FACE_RIGHT * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x + 1, y + 1, z), u16vec3(1, 0, w), light[FACE_RIGHT * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x + 1, y, z), u16vec3(1, 1, w), light[FACE_RIGHT * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
 
-    if (CheckFace(world, cull, block, adj.left, vAdded))
+    if (faces[FACE_LEFT])
     {
         int count = data->vertCount;
         uint16_t w = textures[FACE_LEFT];
 
         SetIndices(data, meshIndex);
 
-        data->vertices[count + 0] = { u8vec3(x, y, z), u16vec3(0, 1, w), LIGHT(X, -1, -1, -1), alpha };
-        data->vertices[count + 1] = { u8vec3(x, y + 1, z), u16vec3(0, 0, w), LIGHT(X, -1, 1, -1), alpha };
-        data->vertices[count + 2] = { u8vec3(x, y + 1, z + 1), u16vec3(1, 0, w), LIGHT(X, -1, 1, 1), alpha };
-        data->vertices[count + 3] = { u8vec3(x, y, z + 1), u16vec3(1, 1, w), LIGHT(X, -1, -1, 1), alpha };
+        data->vertices[count + 0] = { u8vec3(x, y, z), u16vec3(0, 1, w), light[FACE_LEFT * 4 + 0], alpha };
+        data->vertices[count + 1] = { u8vec3(x, y + 1, z), u16vec3(0, 0, w), light[FACE_LEFT * 4 + 1], alpha };
+        data->vertices[count + 2] = { u8vec3(x, y + 1, z + 1), u16vec3(1, 0, w), light[FACE_LEFT * 4 + 2], alpha };
+        data->vertices[count + 3] = { u8vec3(x, y, z + 1), u16vec3(1, 1, w), light[FACE_LEFT * 4 + 3], alpha };
 
         data->vertCount += 4;
     }
@@ -558,5 +744,3 @@ static void BuildBlock(World* world, Chunk* chunk, MeshData* data, int xi, int y
     assert(!DebugOverflowCheck(chunk, vAdded));
     chunk->totalVertices += vAdded;
 }
-
-#undef LIGHT
@@ -4,6 +4,13 @@
 
 struct GameState;
 
+// Chunks queued for rebuilding in the same frame.
+struct RebuildBatch
+{
+    vector<Chunk*> chunks;
+    int remaining;
+};
+
 static void WorldRenderUpdate(GameState* state, World* world, Camera* cam);
 static inline bool ChunkOverflowed(World* world, Chunk* chunk, int x, int y, int z);
 static void BuildBlock(World* world, Chunk* chunk, MeshData* data, int xi, int yi, int zi, Block block);
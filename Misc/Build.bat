@@ -11,6 +11,7 @@ set clb=-incremental:no -opt:ref gdi32.lib user32.lib shell32.lib shlwapi.lib op
 IF "%~1" == "" GOTO end
 IF "%~1" == "-r" GOTO build_release
 IF "%~1" == "-d" GOTO build_debug
+IF "%~1" == "-b" GOTO build_benchmark
 
 REM Release mode build.
 :build_release
@@ -30,6 +31,18 @@ set def=-D_DEBUG=1 -D_CRT_SECURE_NO_WARNINGS=1 -D_HAS_EXCEPTIONS=0
 set lb=glew-d.lib glfw-d.lib noise-d.lib stb_vorbis-d.lib imgui-d.lib
 set link=/LIBPATH:W:\Common\Lib /ignore:4099 /SUBSYSTEM:WINDOWS
 
+GOTO compile
+
+REM Headless benchmark build. Runs as a console program with no window or GL context.
+REM CMakeLists.txt builds the same program on other platforms.
+:build_benchmark
+
+set cf=%cf:-FeGamecraft.exe=-FeGamecraftBench.exe%
+set f=-MD -Oi -Ob3 -O2 -Zi
+set def=-D_CRT_SECURE_NO_WARNINGS=1 -DNDEBUG=1 -D_HAS_EXCEPTIONS=0 -DHEADLESS=1 -DHEAP_TRAFFIC=1 -DDEBUG_SERVICES=0 -DPIPELINE_STATS=1
+set lb=noise.lib
+set link=/LIBPATH:W:\Common\Lib /SUBSYSTEM:CONSOLE
+
 REM Compile the engine.
 :compile
 